@@ -0,0 +1,9 @@
+long sum(long end) {
+	long s = 0;
+	for (long i = 1; i <= end; ++i) s += i;
+	return s;
+}
+
+int main() {
+	return sum(100) == 5050 ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+#!/bin/sh
+# Serve the guest with the fork server of linux-vp, run a client that closes its
+# write side after the input (e.g. a script piped into the connection) and check
+# that the child still runs the guest to its regular exit.
+
+set -e
+
+VP=${VP:-linux-vp}
+SOCKET=$(mktemp -u /tmp/fork-server.XXXXXX)
+
+"$VP" --dtb-file placeholder.dtb --fork-server "$SOCKET" "$1" &
+PID=$!
+trap 'kill $PID 2>/dev/null; rm -f "$SOCKET"' EXIT
+
+i=0
+while [ ! -S "$SOCKET" ]; do
+	i=$((i + 1))
+	[ $i -le 100 ] || exit 1
+	sleep 0.1
+done
+
+OUTPUT=$(printf 'ping\n' | socat -t 30 - UNIX-CONNECT:"$SOCKET")
+printf '%s\n' "$OUTPUT"
+
+printf '%s\n' "$OUTPUT" | grep -q '^ping$'
+printf '%s\n' "$OUTPUT" | grep -q '^\[fork-server\] exit 0$'
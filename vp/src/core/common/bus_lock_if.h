@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+
 struct bus_lock_if {
 	virtual ~bus_lock_if() {}
 
@@ -17,4 +19,17 @@ struct bus_lock_if {
 		if (is_locked() && !is_locked(hart_id))
 			wait_until_unlocked();
 	}
+
+	/*
+	 * LR/SC reservations which are not backed by the lock (LR/SC on DMI memory, see CombinedMemoryInterface_T).
+	 * A reservation covers the naturally aligned 8 byte granule containing the reserved address. Every store reported
+	 * by snoop_store invalidates all overlapping reservations.
+	 */
+	virtual void set_reservation(unsigned hart_id, uint64_t addr) = 0;
+
+	virtual bool has_reservation(unsigned hart_id) = 0;
+
+	virtual void clear_reservation(unsigned hart_id) = 0;
+
+	virtual void snoop_store(uint64_t addr, unsigned num_bytes) = 0;
 };
\ No newline at end of file
@@ -6,8 +6,9 @@
 #include <systemc>
 
 #include "clint_if.h"
+#include "host_profiler.h"
 #include "irq_if.h"
-#include "util/memory_map.h"
+#include "util/register_map.h"
 
 template <unsigned NumberOfCores>
 struct CLINT : public clint_if, public sc_core::sc_module {
@@ -43,16 +44,9 @@ struct CLINT : public clint_if, public sc_core::sc_module {
 	sc_core::sc_time clock_cycle = sc_core::sc_time(10, sc_core::SC_NS);
 	sc_core::sc_event irq_event;
 
-	RegisterRange regs_mtime{0xBFF8, 8};
-	IntegerView<uint64_t> mtime{regs_mtime};
-
-	RegisterRange regs_mtimecmp{0x4000, 8 * NumberOfCores};
-	ArrayView<uint64_t> mtimecmp{regs_mtimecmp};
-
-	RegisterRange regs_msip{0x0, 4 * NumberOfCores};
-	ArrayView<uint32_t> msip{regs_msip};
-
-	std::vector<RegisterRange *> register_ranges{&regs_mtime, &regs_mtimecmp, &regs_msip};
+	uint64_t mtime = 0;
+	uint64_t mtimecmp[NumberOfCores] = {};
+	uint32_t msip[NumberOfCores] = {};
 
 	std::array<clint_interrupt_target *, NumberOfCores> target_harts{};
 
@@ -61,14 +55,6 @@ struct CLINT : public clint_if, public sc_core::sc_module {
 	CLINT(sc_core::sc_module_name) {
 		tsock.register_b_transport(this, &CLINT::transport);
 
-		regs_mtimecmp.alignment = 4;
-		regs_msip.alignment = 4;
-		regs_mtime.alignment = 4;
-
-		regs_mtime.pre_read_callback = std::bind(&CLINT::pre_read_mtime, this, std::placeholders::_1);
-		regs_mtimecmp.post_write_callback = std::bind(&CLINT::post_write_mtimecmp, this, std::placeholders::_1);
-		regs_msip.post_write_callback = std::bind(&CLINT::post_write_msip, this, std::placeholders::_1);
-
 		SC_THREAD(run);
 	}
 
@@ -80,8 +66,11 @@ struct CLINT : public clint_if, public sc_core::sc_module {
 	}
 
 	void run() {
+		HostProfiler::Section *profile = HostProfiler::instance().get_process_section();
+
 		while (true) {
 			sc_core::wait(irq_event);
+			HostProfiler::Scope scope(profile);
 
 			update_and_get_mtime();
 
@@ -107,24 +96,29 @@ struct CLINT : public clint_if, public sc_core::sc_module {
 		}
 	}
 
-	bool pre_read_mtime(RegisterRange::ReadInfo t) {
-		sc_core::sc_time now = sc_core::sc_time_stamp() + t.delay;
-
-		mtime.write(now.value() / scaler);
+	void access_mtime(const vp::regmap::Access &t) {
+		if (t.read) {
+			sc_core::sc_time now = sc_core::sc_time_stamp() + t.delay;
 
-		return true;
+			mtime = now.value() / scaler;
+		}
+		t.fn();
 	}
 
-	void post_write_mtimecmp(RegisterRange::WriteInfo t) {
-		// std::cout << "[vp::clint] write mtimecmp[addr=" << t.addr << "]=" << mtimecmp[t.addr / 8] << ", mtime=" <<
+	void access_mtimecmp(const vp::regmap::Access &t) {
+		t.fn();
+		// std::cout << "[vp::clint] write mtimecmp[" << t.index << "]=" << mtimecmp[t.index] << ", mtime=" <<
 		// mtime << std::endl;
-		irq_event.notify(t.delay);
+		if (t.write)
+			irq_event.notify(t.delay);
 	}
 
-	void post_write_msip(RegisterRange::WriteInfo t) {
-		assert(t.addr % 4 == 0);
-		unsigned idx = t.addr / 4;
-		msip[idx] &= 0x1;
+	void access_msip(const vp::regmap::Access &t) {
+		t.fn();
+		if (!t.write)
+			return;
+
+		unsigned idx = t.index;
 		if (msip[idx] != 0) {
 			target_harts[idx]->trigger_software_interrupt();
 		} else {
@@ -135,8 +129,18 @@ struct CLINT : public clint_if, public sc_core::sc_module {
 	void transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
 		delay += 2 * clock_cycle;
 
-		vp::mm::route("CLINT", register_ranges, trans, delay);
+		register_map::transport("CLINT", *this, trans, delay);
 	}
+
+	typedef vp::regmap::RegisterMap<
+	    4,
+	    vp::regmap::Bank<0x0, 4 * NumberOfCores,
+	                     vp::regmap::RegArray<0x0, NumberOfCores, 4, &CLINT::msip, &CLINT::access_msip,
+	                                          vp::regmap::RW, 0x1>>,
+	    vp::regmap::Bank<0x4000, 8 * NumberOfCores,
+	                     vp::regmap::RegArray<0x4000, NumberOfCores, 8, &CLINT::mtimecmp, &CLINT::access_mtimecmp>>,
+	    vp::regmap::Bank<0xBFF8, 8, vp::regmap::Reg<0xBFF8, &CLINT::mtime, &CLINT::access_mtime>>>
+	    register_map;
 };
 
 #endif  // RISCV_ISA_CLINT_H
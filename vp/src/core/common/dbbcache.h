@@ -70,9 +70,11 @@
 #include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "core_defs.h"
 #include "dbbcache_stats.h"
+#include "guest_coverage.h"
 #include "instr.h"
 #include "trap.h"
 #include "util/common.h"
@@ -136,6 +138,7 @@ class DBBCacheBase_T {
 	struct OpMapEntry *opMap = nullptr;
 	void *fast_abort_label_ptr = nullptr;
 	uint32_t mem_word = 0x0;
+	GuestCoverage *coverage = nullptr;
 
    public:
 	DBBCacheBase_T() {
@@ -165,6 +168,11 @@ class DBBCacheBase_T {
 		return enabled;
 #endif
 	}
+
+	/* optional, if provided, executed instructions are recorded (see guest_coverage.h) */
+	void set_coverage(GuestCoverage *coverage) {
+		this->coverage = coverage;
+	}
 };
 
 /******************************************************************************
@@ -265,6 +273,12 @@ class DBBCacheDummy_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if
 
 	__always_inline void force_slow_path() {}
 
+	/* nothing to do, the dummy never executes in fast path */
+	void set_breakpoints(const std::unordered_set<T_uxlen_t> &breakpoints, T_uxlen_t pc) {}
+
+	/* nothing to do, the dummy records every instruction in fetch_decode */
+	void collect_coverage() {}
+
 	__always_inline bool in_fast_path() {
 		return false;
 	}
@@ -280,6 +294,8 @@ class DBBCacheDummy_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if
 		this->last_pc = this->pc;
 		this->mem_word = fetch_decode(pc, instr, op);
 		this->pc = pc;
+		if (unlikely(this->coverage != nullptr))
+			this->coverage->add(this->last_pc, pc - this->last_pc);
 		cycle_counter_raw += this->opMap[op].instr_time;
 		return this->opMap[op].label_ptr;
 	}
@@ -519,6 +535,9 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 
 		uint32_t coherence_cnt;
 
+		/* start_addr is a breakpoint -> never entered in fast path (see set_breakpoints) */
+		bool breakpoint;
+
 		Block() : Block(0) {}
 		Block(T_uxlen_t pc, const DBBCache_T &dbbcache) {
 			init(pc, dbbcache);
@@ -535,6 +554,7 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 			start_addr = pc;
 			len = 0;
 			this->coherence_cnt = coherence_cnt;
+			breakpoint = false;
 			invalidate_links();
 		}
 
@@ -602,6 +622,7 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 	dbbcachestats_t stats = dbbcachestats_t(*this);
 
    private:
+	std::unordered_set<T_uxlen_t> breakpoints;
 	std::unordered_map<uint64_t, struct Block *> blockmap;
 	struct Block *curBlock;
 	struct Block dummyBlock = Block(0, *this);
@@ -763,11 +784,12 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 
 		if (curBlock == block) {
 			/* we switch to the same block -> we know already that len>0 and that it is coherent -> switch directly */
-			if (likely(in_fast_path() || slow_path == false)) {
+			if (likely((in_fast_path() || slow_path == false) && !block->breakpoint)) {
 				stats.inc_swtch_same_fast();
 				fast_path_raw_enable(&curBlock->entries[-1]);
 			} else {
 				stats.inc_swtch_same_slow();
+				fast_path_raw_disable();
 				curEntryIdx = -1;
 			}
 			return;
@@ -785,7 +807,8 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		 * This kind of coherency check does only work because we are always at the start of a block.
 		 * It would not work, if we were in the middle of a block!
 		 */
-		if (likely(slow_path == false && curBlock->len > 0 && coherence_cnt == curBlock->coherence_cnt)) {
+		if (likely(slow_path == false && curBlock->len > 0 && coherence_cnt == curBlock->coherence_cnt &&
+		           !curBlock->breakpoint)) {
 			fast_path_raw_enable(&curBlock->entries[-1]);
 		} else {
 			fast_path_raw_disable();
@@ -806,6 +829,7 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 			/* not found -> new */
 			stats.inc_blocks();
 			block = new Block(pc, *this);
+			block->breakpoint = is_breakpoint(pc);
 			blockmap[pc] = block;
 		}
 		switch_block(block);
@@ -892,6 +916,8 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 
 		coherence_cnt = 0;
 
+		/* the blocks are dropped on a restart of the core too */
+		collect_coverage();
 		for (const auto it : blockmap) {
 			delete it.second;
 		}
@@ -1018,6 +1044,45 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		switch_block_dummy(pc);
 	}
 
+	/*
+	 * Breakpoints are placed at the start of blocks only (blocks are split at breakpoints) and these blocks are never
+	 * entered in fast path. Hence, the ISS passes its med path before executing an instruction at a breakpoint and can
+	 * check for breakpoints there, while all other code still runs in fast path.
+	 * NOTE: invalidates all blocks -> call between two instructions only (e.g. ISS slow path)
+	 */
+	void set_breakpoints(const std::unordered_set<T_uxlen_t> &breakpoints, T_uxlen_t pc) {
+		this->breakpoints = breakpoints;
+
+		/* leave current block (updates cycles) and drop all blocks */
+		switch_block_dummy(pc);
+		collect_coverage();
+		for (const auto it : blockmap) {
+			delete it.second;
+		}
+		blockmap.clear();
+		dummyBlock.invalidate_links();
+		trapLinkCache.reset();
+	}
+
+	/*
+	 * Blocks only hold instructions which were executed at least once (entries are added on their first execution),
+	 * hence the coverage is taken from the blocks instead of tracking it during execution.
+	 * NOTE: call before blocks are dropped and at the end of the simulation
+	 */
+	void collect_coverage() {
+		if (this->coverage == nullptr)
+			return;
+		for (const auto it : blockmap) {
+			Block *block = it.second;
+			for (unsigned int i = 0; i < block->len; i++)
+				this->coverage->add(block->entries[i].pc, block->entries[i].pc_increment);
+		}
+	}
+
+	__always_inline bool is_breakpoint(T_uxlen_t pc) {
+		return unlikely(!breakpoints.empty()) && breakpoints.find(pc) != breakpoints.end();
+	}
+
 	__always_inline void force_slow_path() {
 		/* stop fast execution, if enabled */
 		slow_path = true;
@@ -1112,6 +1177,8 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 			/* save mem_word for get_mem_word */
 			this->mem_word = fetch_decode(pc, instr, op);
 			dummyBlock.entries[0].pc_increment = pc - last_pc;
+			if (unlikely(this->coverage != nullptr))
+				this->coverage->add(last_pc, pc - last_pc);
 
 			/* update block cycle counter -> see comments in decode_update_entry above */
 			dummyBlock.entries[1].cycle_counter_raw += this->opMap[op].instr_time;
@@ -1126,6 +1193,12 @@ class DBBCache_T : public DBBCacheBase_T<arch, T_uxlen_t, T_instr_memory_if> {
 		 */
 		uint32_t nextEntryIdx = curEntryIdx + 1;
 
+		/* breakpoints must only start blocks -> end the current block and continue in a new one */
+		if (unlikely(nextEntryIdx > 0 && nextEntryIdx >= curBlock->len && is_breakpoint(pc))) {
+			find_create_block(pc);
+			nextEntryIdx = 0;
+		}
+
 		/* check, if we have a new/unseen entry -> miss */
 		if (unlikely(nextEntryIdx >= curBlock->len)) {
 			/* miss -> add new entry to current block */
@@ -8,6 +8,20 @@
 
 #include "core_defs.h"
 
+/* access types triggering a data watchpoint (bit mask) */
+enum WatchpointType {
+	WATCHPOINT_WRITE = 1,
+	WATCHPOINT_READ = 2,
+	WATCHPOINT_ACCESS = WATCHPOINT_WRITE | WATCHPOINT_READ,
+};
+
+struct WatchpointHit {
+	WatchpointType type;  // type of the watchpoint, not of the access
+	uint64_t addr;        // accessed address within the watched range
+	uint64_t value;       // value loaded or stored
+	uint64_t pc;          // address of the accessing instruction
+};
+
 struct debug_target_if {
 	virtual ~debug_target_if() {}
 
@@ -19,6 +33,11 @@ struct debug_target_if {
 	virtual void insert_breakpoint(uint64_t) = 0;
 	virtual void remove_breakpoint(uint64_t) = 0;
 
+	virtual void insert_watchpoint(uint64_t addr, uint64_t len, WatchpointType type) = 0;
+	virtual void remove_watchpoint(uint64_t addr, uint64_t len, WatchpointType type) = 0;
+	/* returns and clears the watchpoint hit which stopped the hart, if any */
+	virtual bool take_watchpoint_hit(WatchpointHit &hit) = 0;
+
 	virtual Architecture get_architecture(void) = 0;
 	virtual uint64_t get_hart_id(void) = 0;
 
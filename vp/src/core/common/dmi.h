@@ -7,6 +7,7 @@ class MemoryDMI {
 	uint64_t start;
 	uint64_t size;
 	uint64_t end;
+	bool read_only = false;  // stores take the TLM path, e.g. for buffers that are written by the device only
 
 	MemoryDMI(uint8_t *mem, uint64_t start, uint64_t size) : mem(mem), start(start), size(size), end(start + size) {}
 
@@ -21,6 +22,12 @@ class MemoryDMI {
 		return MemoryDMI(mem, start, size);
 	}
 
+	static MemoryDMI create_read_only_start_size_mapping(uint8_t *mem, uint64_t start, uint64_t size) {
+		MemoryDMI dmi = create_start_size_mapping(mem, start, size);
+		dmi.read_only = true;
+		return dmi;
+	}
+
 	uint8_t *get_raw_mem_ptr() {
 		return mem;
 	}
@@ -52,6 +59,7 @@ class MemoryDMI {
 	template <typename T>
 	void store(uint64_t addr, T value) {
 		static_assert(std::is_integral<T>::value, "integer type required");
+		assert(!read_only);
 		T *dst = get_mem_ptr_to_global_addr<T>(addr);
 		/* memcpy -> see note in load */
 		memcpy(dst, &value, sizeof(value));
@@ -72,4 +80,13 @@ class MemoryDMI {
 	bool contains(uint64_t addr) {
 		return addr >= start && addr < end;
 	}
+
+	bool is_read_only() const {
+		return read_only;
+	}
+
+	/* addr is in the range and the access is allowed */
+	bool allows(uint64_t addr, bool is_store) {
+		return contains(addr) && !(is_store && read_only);
+	}
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <cstdint>
 #include <exception>
@@ -61,11 +62,56 @@ class GenericElfLoader {
 		return s + s % 8;
 	}
 
+	const char *get_filename() const {
+		return filename;
+	}
+
+	/* lowest virtual address of the loadable segments */
+	addr_t get_load_begin() {
+		init();
+		addr_t begin = ~addr_t(0);
+		for (auto p : get_load_sections()) begin = std::min(begin, p->p_vaddr);
+		return begin;
+	}
+
+	/* end (exclusive) of the highest loadable segment */
+	addr_t get_load_end() {
+		init();
+		addr_t end = 0;
+		for (auto p : get_load_sections()) end = std::max(end, addr_t(p->p_vaddr + p->p_memsz));
+		return end;
+	}
+
 	addr_t get_entrypoint() {
 		init();
 		return hdr->e_entry;
 	}
 
+	/* address of the program headers in memory (e.g. for the auxiliary vector of a process), 0 if not loaded */
+	addr_t get_phdr_addr() {
+		init();
+		for (unsigned i = 0; i < hdr->e_phnum; ++i) {
+			const Elf_Phdr *p = reinterpret_cast<const Elf_Phdr *>(elf.data() + hdr->e_phoff + hdr->e_phentsize * i);
+			if (p->p_type == T::PT_PHDR)
+				return p->p_vaddr;
+		}
+		for (auto p : get_load_sections()) {
+			if (hdr->e_phoff >= p->p_offset && hdr->e_phoff < p->p_offset + p->p_filesz)
+				return p->p_vaddr + (hdr->e_phoff - p->p_offset);
+		}
+		return 0;
+	}
+
+	unsigned get_phnum() {
+		init();
+		return hdr->e_phnum;
+	}
+
+	unsigned get_phentsize() {
+		init();
+		return hdr->e_phentsize;
+	}
+
 	void load_executable_image(load_if &load_if, addr_t size, addr_t offset, bool use_vaddr = true) {
 		init();
 		for (auto p : get_load_sections()) {
@@ -130,6 +176,36 @@ class GenericElfLoader {
 		return p->st_value;
 	}
 
+	/*
+	 * calls fn(name, addr, size) for all code symbols: functions and global labels in executable sections (e.g.
+	 * assembler entry points without a type)
+	 */
+	template <typename F>
+	void for_each_code_symbol(F fn) {
+		constexpr unsigned STT_NOTYPE = 0, STT_FUNC = 2, STB_GLOBAL = 1, SHF_EXECINSTR = 0x4, SHN_LORESERVE = 0xff00;
+
+		init();
+		const Elf_Shdr *s = get_section(".symtab");
+		const char *strings = get_symbol_string_table();
+		auto sections = get_sections();
+
+		auto num_entries = s->sh_size / sizeof(Elf_Sym);
+		for (unsigned i = 0; i < num_entries; ++i) {
+			const Elf_Sym *p = reinterpret_cast<const Elf_Sym *>(elf.data() + s->sh_offset + i * sizeof(Elf_Sym));
+			unsigned type = p->st_info & 0xf;
+			unsigned bind = p->st_info >> 4;
+
+			if (p->st_shndx == 0 || p->st_shndx >= SHN_LORESERVE || p->st_shndx >= sections.size())
+				continue;
+			if (type != STT_FUNC && !(type == STT_NOTYPE && bind == STB_GLOBAL))
+				continue;
+			if (!(sections[p->st_shndx]->sh_flags & SHF_EXECINSTR))
+				continue;
+
+			fn(strings + p->st_name, p->st_value, p->st_size);
+		}
+	}
+
    private:
 	void init(bool throw_error = true) {
 		/* already initialized? */
@@ -2,6 +2,8 @@
 
 #include <softfloat/softfloat.hpp>
 
+#include <array>
+
 // floating-point rounding modes
 constexpr unsigned FRM_RNE = 0b000;  // Round to Nearest, ties to Even
 constexpr unsigned FRM_RTZ = 0b001;  // Round towards Zero
@@ -1,6 +1,8 @@
 #include <assert.h>
+#include <inttypes.h>
 #include <libgdb/parser2.h>
 #include <limits.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include "debug.h"
@@ -217,10 +219,33 @@ void GDBServer::isAlive(int conn, gdb_command_t *cmd) {
 	send_packet(conn, "OK");
 }
 
+/* stop reason for a hart stopped by a data watchpoint, e.g. "watch:80001000;" */
+static std::string watchpoint_reason(debug_target_if *hart) {
+	WatchpointHit hit;
+	if (!hart->take_watchpoint_hit(hit))
+		return "";
+
+	const char *kind = "awatch";
+	if (hit.type == WATCHPOINT_WRITE)
+		kind = "watch";
+	else if (hit.type == WATCHPOINT_READ)
+		kind = "rwatch";
+
+	/* the stop reply carries the address only, the hart already stopped after the accessing instruction */
+	printf("[gdb-mc] hart %" PRIu64 ": %s hit by instruction at 0x%" PRIx64 ", address 0x%" PRIx64 ", value 0x%" PRIx64
+	       "\n",
+	       hart->get_hart_id(), kind, hit.pc, hit.addr, hit.value);
+
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%s:%" PRIx64 ";", kind, hit.addr);
+	return buf;
+}
+
 void GDBServer::vCont(int conn, gdb_command_t *cmd) {
 	gdb_vcont_t *vcont;
 	int stopped_thread = -1;
 	const char *stop_reason = NULL;
+	std::string watch_reason;
 	std::map<debug_target_if *, bool> matched;
 
 	/* This handler attempts to implement the all-stop mode.
@@ -256,6 +281,7 @@ void GDBServer::vCont(int conn, gdb_command_t *cmd) {
 				case CoreExecStatus::HitBreakpoint:
 					stop_reason = "05";
 					stopped_thread = hart->get_hart_id() + 1;
+					watch_reason = watchpoint_reason(hart);
 
 					/* mark runnable again */
 					hart->set_status(CoreExecStatus::Runnable);
@@ -264,6 +290,7 @@ void GDBServer::vCont(int conn, gdb_command_t *cmd) {
 				case CoreExecStatus::Terminated:
 					stop_reason = "03";
 					stopped_thread = hart->get_hart_id() + 1;
+					watch_reason.clear();
 					break;
 				case CoreExecStatus::Runnable:
 					continue;
@@ -292,7 +319,8 @@ void GDBServer::vCont(int conn, gdb_command_t *cmd) {
 	 * XXX: No idea if the stub is really required to do this. */
 	thread_ops['g'] = stopped_thread;
 
-	const std::string msg = std::string("T") + stop_reason + "thread:" + std::to_string(stopped_thread) + ";";
+	const std::string msg =
+	    std::string("T") + stop_reason + watch_reason + "thread:" + std::to_string(stopped_thread) + ";";
 	send_packet(conn, msg.c_str());
 }
 
@@ -304,16 +332,31 @@ void GDBServer::vContSupported(int conn, gdb_command_t *cmd) {
 	send_packet(conn, "vCont;c;C");
 }
 
+static WatchpointType watchpoint_type(gdb_ztype_t type) {
+	switch (type) {
+		case GDB_ZKIND_WATCHW:
+			return WATCHPOINT_WRITE;
+		case GDB_ZKIND_WATCHR:
+			return WATCHPOINT_READ;
+		default:
+			return WATCHPOINT_ACCESS;
+	}
+}
+
 void GDBServer::removeBreakpoint(int conn, gdb_command_t *cmd) {
 	gdb_breakpoint_t *bpoint;
 
+	/* hardware breakpoints are handled like software breakpoints, the
+	 * memory is never modified by the latter anyway */
 	bpoint = &cmd->v.bval;
-	if (bpoint->type != GDB_ZKIND_SOFT) {
-		send_packet(conn, ""); /* not supported */
-		return;
+	if (bpoint->type == GDB_ZKIND_SOFT || bpoint->type == GDB_ZKIND_HARD) {
+		for (debug_target_if *hart : harts) hart->remove_breakpoint(bpoint->address);
+	} else {
+		/* for watchpoints, kind is the length of the watched range */
+		for (debug_target_if *hart : harts)
+			hart->remove_watchpoint(bpoint->address, bpoint->kind, watchpoint_type(bpoint->type));
 	}
 
-	for (debug_target_if *hart : harts) hart->remove_breakpoint(bpoint->address);
 	send_packet(conn, "OK");
 }
 
@@ -321,11 +364,12 @@ void GDBServer::setBreakpoint(int conn, gdb_command_t *cmd) {
 	gdb_breakpoint_t *bpoint;
 
 	bpoint = &cmd->v.bval;
-	if (bpoint->type != GDB_ZKIND_SOFT) {
-		send_packet(conn, ""); /* not supported */
-		return;
+	if (bpoint->type == GDB_ZKIND_SOFT || bpoint->type == GDB_ZKIND_HARD) {
+		for (debug_target_if *hart : harts) hart->insert_breakpoint(bpoint->address);
+	} else {
+		for (debug_target_if *hart : harts)
+			hart->insert_watchpoint(bpoint->address, bpoint->kind, watchpoint_type(bpoint->type));
 	}
 
-	for (debug_target_if *hart : harts) hart->insert_breakpoint(bpoint->address);
 	send_packet(conn, "OK");
 }
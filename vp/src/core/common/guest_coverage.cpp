@@ -0,0 +1,124 @@
+#include "guest_coverage.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <system_error>
+
+void GuestCoverage::add_module(const std::string &path, uint64_t begin, uint64_t end) {
+	modules.push_back({path, begin, end, {}});
+}
+
+void GuestCoverage::add_symbol(const std::string &name, uint64_t addr, uint64_t size) {
+	int m = find_module(addr);
+	if (m < 0)
+		return;
+	auto &symbols = modules[m].symbols;
+	auto it = symbols.find(addr);
+	/* aliases: prefer symbols with a size (functions) over labels */
+	if (it != symbols.end() && (it->second.size != 0 || size == 0))
+		return;
+	symbols[addr] = {name, size};
+}
+
+int GuestCoverage::find_module(uint64_t addr) const {
+	for (unsigned i = 0; i < modules.size(); ++i) {
+		if (addr >= modules[i].begin && addr < modules[i].end)
+			return i;
+	}
+	return -1;
+}
+
+std::map<uint64_t, unsigned> GuestCoverage::sorted_instructions() const {
+	return std::map<uint64_t, unsigned>(instructions.begin(), instructions.end());
+}
+
+void GuestCoverage::write_drcov(std::ostream &os) const {
+	struct BasicBlock {
+		uint32_t start;
+		uint16_t size;
+		uint16_t module;
+	};
+	std::vector<BasicBlock> blocks;
+
+	/* merge contiguous instructions of the same module into one basic block entry */
+	int cur_module = -1;
+	uint64_t cur_start = 0;
+	uint64_t cur_end = 0;
+	auto flush = [&]() {
+		if (cur_module >= 0)
+			blocks.push_back({uint32_t(cur_start - modules[cur_module].begin), uint16_t(cur_end - cur_start),
+			                  uint16_t(cur_module)});
+	};
+	for (auto &i : sorted_instructions()) {
+		int m = find_module(i.first);
+		if (m != cur_module || i.first != cur_end || i.first + i.second - cur_start > UINT16_MAX) {
+			flush();
+			cur_module = m;
+			cur_start = i.first;
+		}
+		cur_end = i.first + i.second;
+	}
+	flush();
+
+	os << "DRCOV VERSION: 2\n";
+	os << "DRCOV FLAVOR: riscv-vp\n";
+	os << "Module Table: version 2, count " << modules.size() << "\n";
+	os << "Columns: id, base, end, entry, checksum, timestamp, path\n";
+	for (unsigned i = 0; i < modules.size(); ++i) {
+		os << std::dec << i << ", 0x" << std::hex << std::setfill('0') << std::setw(16) << modules[i].begin << ", 0x"
+		   << std::setw(16) << modules[i].end << ", 0x" << std::setw(16) << 0 << ", 0x" << std::setw(8) << 0
+		   << ", 0x" << std::setw(8) << 0 << ", " << modules[i].path << "\n";
+	}
+	os << std::dec << std::setfill(' ');
+	os << "BB Table: " << blocks.size() << " bbs\n";
+	/* binary, little endian (the host byte order of all supported hosts) */
+	for (auto &b : blocks) {
+		os.write((const char *)&b.start, sizeof(b.start));
+		os.write((const char *)&b.size, sizeof(b.size));
+		os.write((const char *)&b.module, sizeof(b.module));
+	}
+}
+
+void GuestCoverage::write_lcov(std::ostream &os) const {
+	auto covered = sorted_instructions();
+
+	for (auto &m : modules) {
+		os << "TN:\n";
+		os << "SF:" << m.path << "\n";
+
+		/* FN takes a line number, use the position of the function in address order instead */
+		unsigned line = 0;
+		unsigned hit = 0;
+		for (auto it = m.symbols.begin(); it != m.symbols.end(); ++it) {
+			/* labels (size 0) extend to the next symbol */
+			auto next = std::next(it);
+			uint64_t end = it->first + it->second.size;
+			if (it->second.size == 0)
+				end = next != m.symbols.end() ? next->first : m.end;
+
+			uint64_t count = 0;
+			for (auto i = covered.lower_bound(it->first); i != covered.end() && i->first < end; ++i) count++;
+			if (count)
+				hit++;
+
+			os << "FN:" << ++line << "," << it->second.name << "\n";
+			os << "FNDA:" << count << "," << it->second.name << "\n";
+		}
+		os << "FNF:" << m.symbols.size() << "\n";
+		os << "FNH:" << hit << "\n";
+		os << "end_of_record\n";
+	}
+}
+
+void GuestCoverage::write(const std::string &path) const {
+	std::ofstream drcov(path, std::ios::binary);
+	if (!drcov)
+		throw std::system_error(errno, std::generic_category(), "unable to open coverage \"" + path + "\"");
+	write_drcov(drcov);
+
+	std::ofstream lcov(path + ".info");
+	if (!lcov)
+		throw std::system_error(errno, std::generic_category(), "unable to open coverage \"" + path + ".info\"");
+	write_lcov(lcov);
+}
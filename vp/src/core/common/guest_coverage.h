@@ -0,0 +1,92 @@
+#ifndef RISCV_ISA_GUEST_COVERAGE_H
+#define RISCV_ISA_GUEST_COVERAGE_H
+
+#include <stdint.h>
+
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Instruction coverage of guest code, collected without instrumenting the guest
+ *
+ * The blocks of the DBBCache only hold instructions which were executed at least once (entries are added when they
+ * are executed for the first time), hence the coverage is read from the blocks when they are dropped and at the end
+ * of the simulation (see DBBCache_T::collect_coverage) and the fast path is not affected at all. Instructions executed
+ * outside of blocks (DBBCache disabled, after trap returns) are added one by one.
+ *
+ * Coverage is attributed to modules, i.e. loaded ELF files (e.g. firmware, kernel, kernel modules or user binaries at
+ * their load offset):
+ *  - <file>: drcov (version 2), e.g. for Lighthouse, bncov or dragondance; covered instructions are merged into
+ *    contiguous ranges, offsets are relative to the lowest address of the loadable segments of the module
+ *  - <file>.info: lcov tracefile, one record per module with function coverage of its code symbols (FNDA holds the
+ *    number of covered instructions), there is no line coverage since no DWARF line info is read
+ *
+ * All methods are called from SystemC context only.
+ */
+class GuestCoverage {
+   public:
+	inline void add(uint64_t pc, unsigned size) {
+		instructions[pc] = size;
+	}
+
+	void add_module(const std::string &path, uint64_t begin, uint64_t end);
+	void add_symbol(const std::string &name, uint64_t addr, uint64_t size);
+
+	/* module and code symbols of an ELF file, relocated by bias */
+	template <typename T_ElfLoader>
+	void add_elf(T_ElfLoader &elf, uint64_t bias = 0) {
+		add_module(elf.get_filename(), elf.get_load_begin() + bias, elf.get_load_end() + bias);
+		try {
+			elf.for_each_code_symbol(
+			    [&](const char *name, uint64_t addr, uint64_t size) { add_symbol(name, addr + bias, size); });
+		} catch (std::runtime_error &e) {
+			std::cerr << "[GuestCoverage] Warning: no symbols available: " << e.what() << std::endl;
+		}
+	}
+
+	/* spec: <file>[@<bias>] */
+	template <typename T_ElfLoader>
+	void add_elf_file(const std::string &spec) {
+		std::string path = spec;
+		uint64_t bias = 0;
+		auto at = spec.rfind('@');
+		if (at != std::string::npos) {
+			path = spec.substr(0, at);
+			bias = std::stoull(spec.substr(at + 1), nullptr, 0);
+		}
+		T_ElfLoader elf(path.c_str());
+		add_elf(elf, bias);
+	}
+
+	void write_drcov(std::ostream &os) const;
+	void write_lcov(std::ostream &os) const;
+
+	/* drcov to path, lcov to path + ".info" */
+	void write(const std::string &path) const;
+
+   private:
+	struct Symbol {
+		std::string name;
+		uint64_t size;
+	};
+
+	struct Module {
+		std::string path;
+		uint64_t begin;
+		uint64_t end;
+		std::map<uint64_t, Symbol> symbols;
+	};
+
+	std::vector<Module> modules;
+	std::unordered_map<uint64_t, uint8_t> instructions;  // pc -> size
+
+	/* index of the first module containing addr, -1 if none */
+	int find_module(uint64_t addr) const;
+	std::map<uint64_t, unsigned> sorted_instructions() const;
+};
+
+#endif  // RISCV_ISA_GUEST_COVERAGE_H
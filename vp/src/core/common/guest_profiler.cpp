@@ -0,0 +1,111 @@
+#include "guest_profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <system_error>
+#include <unordered_map>
+
+static const char *privilege_name(PrivilegeLevel prv) {
+	switch (prv) {
+		case MachineMode:
+			return "M";
+		case SupervisorMode:
+			return "S";
+		case UserMode:
+			return "U";
+		default:
+			return "?";
+	}
+}
+
+void GuestProfiler::add_symbol(const std::string &name, uint64_t addr, uint64_t size) {
+	auto it = symbols.find(addr);
+	/* aliases: prefer symbols with a size (functions) over labels */
+	if (it != symbols.end() && (it->second.size != 0 || size == 0))
+		return;
+	symbols[addr] = {name, size};
+}
+
+void GuestProfiler::sample(unsigned hart, PrivilegeLevel prv, const uint64_t *stack, unsigned depth,
+                           uint64_t weight) {
+	stacks[{hart, prv, std::vector<uint64_t>(stack, stack + depth)}] += weight;
+	num_samples++;
+	total_weight += weight;
+}
+
+std::string GuestProfiler::symbolize(uint64_t addr, bool return_address) const {
+	/* return addresses point after the call, which may be the start of the next function */
+	uint64_t lookup = return_address ? addr - 1 : addr;
+	auto it = symbols.upper_bound(lookup);
+	if (it != symbols.begin()) {
+		--it;
+		/* labels (size 0) extend to the next symbol */
+		if (it->second.size == 0 || lookup < it->first + it->second.size)
+			return it->second.name;
+	}
+	std::ostringstream os;
+	os << "0x" << std::hex << addr;
+	return os.str();
+}
+
+void GuestProfiler::write_flat_profile(std::ostream &os) const {
+	struct Entry {
+		uint64_t self = 0;
+		uint64_t total = 0;
+	};
+	std::unordered_map<std::string, Entry> functions;
+
+	for (auto &s : stacks) {
+		std::set<std::string> seen;  // count recursive functions only once per stack
+		for (unsigned i = 0; i < s.first.stack.size(); ++i) {
+			std::string name = symbolize(s.first.stack[i], i != 0);
+			if (i == 0)
+				functions[name].self += s.second;
+			if (seen.insert(name).second)
+				functions[name].total += s.second;
+		}
+	}
+
+	using Function = std::pair<std::string, Entry>;
+	std::vector<Function> sorted(functions.begin(), functions.end());
+	std::sort(sorted.begin(), sorted.end(), [](const Function &a, const Function &b) {
+		return a.second.self != b.second.self ? a.second.self > b.second.self : a.second.total > b.second.total;
+	});
+
+	double scale = total_weight ? 100.0 / total_weight : 0.0;
+	os << "# " << num_samples << " samples, " << total_weight << " instructions (interval " << interval << ")\n";
+	os << "#  self %           self  total %          total  function\n";
+	os << std::fixed << std::setprecision(2);
+	for (auto &e : sorted) {
+		os << std::setw(8) << e.second.self * scale << " " << std::setw(14) << e.second.self << " " << std::setw(8)
+		   << e.second.total * scale << " " << std::setw(14) << e.second.total << "  " << e.first << "\n";
+	}
+}
+
+void GuestProfiler::write_folded_stacks(std::ostream &os) const {
+	std::map<std::string, uint64_t> folded;
+
+	for (auto &s : stacks) {
+		std::string line = "hart" + std::to_string(s.first.hart) + ";" + privilege_name(s.first.prv);
+		auto &stack = s.first.stack;
+		for (unsigned i = stack.size(); i-- > 0;) line += ";" + symbolize(stack[i], i != 0);
+		folded[line] += s.second;
+	}
+
+	for (auto &f : folded) os << f.first << " " << f.second << "\n";
+}
+
+void GuestProfiler::write(const std::string &path) const {
+	std::ofstream flat(path);
+	if (!flat)
+		throw std::system_error(errno, std::generic_category(), "unable to open profile \"" + path + "\"");
+	write_flat_profile(flat);
+
+	std::ofstream folded(path + ".folded");
+	if (!folded)
+		throw std::system_error(errno, std::generic_category(), "unable to open profile \"" + path + ".folded\"");
+	write_folded_stacks(folded);
+}
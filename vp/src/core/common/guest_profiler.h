@@ -0,0 +1,106 @@
+#ifndef RISCV_ISA_GUEST_PROFILER_H
+#define RISCV_ISA_GUEST_PROFILER_H
+
+#include <stdint.h>
+
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "irq_if.h"
+
+/*
+ * Sampling profiler of guest code
+ *
+ * A hart takes a sample whenever at least `interval` instructions were committed since its last sample (checked where
+ * the ISS commits its instruction counter, i.e. on the slow path and at least every tenth of a TLM quantum). A sample
+ * consists of hart, privilege level, pc and the return addresses found by walking the frame pointer chain (s0/fp) in
+ * DMI memory, and is weighted by the number of instructions since the previous sample. Nothing is added to the guest
+ * and no transactions are issued, hence the simulated timing is not affected.
+ *
+ * Samples are aggregated by call stack and symbolized when the profile is written, using the code symbols of the
+ * loaded ELF files (e.g. firmware, kernel, kernel modules or user binaries at their load offset):
+ *  - <file>: flat profile, self and total instructions per function
+ *  - <file>.folded: folded stacks ("hart0;M;main;foo;bar 1234"), e.g. for flamegraph.pl, speedscope or pprof
+ *    converters
+ *
+ * All methods are called from SystemC context only.
+ */
+class GuestProfiler {
+   public:
+	static constexpr unsigned MAX_DEPTH = 64;
+
+	explicit GuestProfiler(uint64_t interval) : interval(interval) {}
+
+	uint64_t get_interval() const {
+		return interval;
+	}
+
+	void add_symbol(const std::string &name, uint64_t addr, uint64_t size);
+
+	/* code symbols of an ELF file, relocated by bias */
+	template <typename T_ElfLoader>
+	void add_symbols(T_ElfLoader &elf, uint64_t bias = 0) {
+		try {
+			elf.for_each_code_symbol(
+			    [&](const char *name, uint64_t addr, uint64_t size) { add_symbol(name, addr + bias, size); });
+		} catch (std::runtime_error &e) {
+			std::cerr << "[GuestProfiler] Warning: no symbols available: " << e.what() << std::endl;
+		}
+	}
+
+	/* spec: <file>[@<bias>] */
+	template <typename T_ElfLoader>
+	void add_symbol_file(const std::string &spec) {
+		std::string path = spec;
+		uint64_t bias = 0;
+		auto at = spec.rfind('@');
+		if (at != std::string::npos) {
+			path = spec.substr(0, at);
+			bias = std::stoull(spec.substr(at + 1), nullptr, 0);
+		}
+		T_ElfLoader elf(path.c_str());
+		add_symbols(elf, bias);
+	}
+
+	/* stack[0]: pc, stack[1..depth-1]: return addresses (innermost first) */
+	void sample(unsigned hart, PrivilegeLevel prv, const uint64_t *stack, unsigned depth, uint64_t weight);
+
+	void write_flat_profile(std::ostream &os) const;
+	void write_folded_stacks(std::ostream &os) const;
+
+	/* flat profile to path, folded stacks to path + ".folded" */
+	void write(const std::string &path) const;
+
+   private:
+	struct Symbol {
+		std::string name;
+		uint64_t size;
+	};
+
+	struct StackKey {
+		unsigned hart;
+		PrivilegeLevel prv;
+		std::vector<uint64_t> stack;
+
+		bool operator<(const StackKey &o) const {
+			if (hart != o.hart)
+				return hart < o.hart;
+			if (prv != o.prv)
+				return prv < o.prv;
+			return stack < o.stack;
+		}
+	};
+
+	uint64_t interval;
+	std::map<uint64_t, Symbol> symbols;
+	std::map<StackKey, uint64_t> stacks;
+	uint64_t num_samples = 0;
+	uint64_t total_weight = 0;
+
+	std::string symbolize(uint64_t addr, bool return_address) const;
+};
+
+#endif  // RISCV_ISA_GUEST_PROFILER_H
@@ -0,0 +1,62 @@
+#include "host_profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <systemc>
+#include <vector>
+
+HostProfiler &HostProfiler::instance() {
+	static HostProfiler profiler;
+	return profiler;
+}
+
+void HostProfiler::enable() {
+	enabled = true;
+	start_ticks = now();
+	start_time = std::chrono::steady_clock::now();
+}
+
+HostProfiler::Section *HostProfiler::get_section(const std::string &name) {
+	if (!enabled)
+		return nullptr;
+
+	auto &section = sections[name];
+	if (!section) {
+		section.reset(new Section);
+		section->name = name;
+	}
+	return section.get();
+}
+
+HostProfiler::Section *HostProfiler::get_process_section() {
+	if (!enabled)
+		return nullptr;
+
+	auto process = sc_core::sc_get_current_process_handle();
+	return get_section(process.valid() ? process.name() : "unknown");
+}
+
+void HostProfiler::show(std::ostream &os) const {
+	if (!enabled)
+		return;
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	uint64_t ticks = now() - start_ticks;
+	double seconds_per_tick = ticks ? seconds / ticks : 0;
+
+	std::vector<const Section *> sorted;
+	for (auto &e : sections) sorted.push_back(e.second.get());
+	std::sort(sorted.begin(), sorted.end(), [](const Section *a, const Section *b) { return a->ticks > b->ticks; });
+
+	os << "[HostProfiler] total host time: " << std::fixed << std::setprecision(3) << seconds << " s" << std::endl;
+	os << "[HostProfiler] " << std::left << std::setw(40) << "section" << std::right << std::setw(14) << "activations"
+	   << std::setw(14) << "time [s]" << std::setw(10) << "share" << std::setw(14) << "avg [us]" << std::endl;
+	for (auto s : sorted) {
+		double t = s->ticks * seconds_per_tick;
+		os << "[HostProfiler] " << std::left << std::setw(40) << s->name << std::right << std::setw(14)
+		   << s->activations << std::setw(14) << std::setprecision(3) << t << std::setw(9) << std::setprecision(1)
+		   << (seconds > 0 ? 100 * t / seconds : 0) << "%" << std::setw(14) << std::setprecision(3)
+		   << (s->activations ? t * 1e6 / s->activations : 0) << std::endl;
+	}
+	os << std::defaultfloat;
+}
@@ -0,0 +1,121 @@
+#ifndef RISCV_ISA_HOST_PROFILER_H
+#define RISCV_ISA_HOST_PROFILER_H
+
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+
+/*
+ * Global host time profiler
+ *
+ * Measures the host time and the number of activations of sections, i.e. SystemC processes (an activation lasts from
+ * the resumption of the process until it waits again) and bus targets (one activation per b_transport call, see
+ * SimpleBus). The ticks are read with rdtsc (clock_gettime on other hosts) and converted to seconds when the report is
+ * printed.
+ *
+ * Sections nest: the time of a bus target is also included in the initiator (e.g. the ISS) that called it. Waits are
+ * only excluded where the section is stopped explicitly (ISS: quantum sync and WFI), e.g. a bus target that waits in
+ * b_transport includes the time of the processes that ran in between.
+ *
+ * The profiler is disabled by default, all sections are nullptr then, i.e. the overhead is a null pointer check per
+ * activation. Enable it before the simulation starts, processes look up their section when they start.
+ *
+ * All methods are called from SystemC context only.
+ */
+class HostProfiler {
+   public:
+	struct Section {
+		std::string name;
+		uint64_t activations = 0;
+		uint64_t ticks = 0;
+	};
+
+	/* measures the enclosing block, no-op if section is nullptr */
+	class Scope {
+		Section *section;
+		uint64_t start = 0;
+
+	   public:
+		inline Scope(Section *section) : section(section) {
+			if (section != nullptr)
+				start = now();
+		}
+
+		inline ~Scope() {
+			if (section != nullptr) {
+				section->ticks += now() - start;
+				section->activations++;
+			}
+		}
+	};
+
+	/* for sections that are suspended within a function (start/stop around the waits) */
+	class Timer {
+		Section *section = nullptr;
+		uint64_t start_ticks = 0;
+
+	   public:
+		void set_section(Section *section) {
+			this->section = section;
+		}
+
+		inline void start() {
+			if (section != nullptr) {
+				start_ticks = now();
+				section->activations++;
+			}
+		}
+
+		inline void stop() {
+			if (section != nullptr)
+				section->ticks += now() - start_ticks;
+		}
+	};
+
+	HostProfiler(const HostProfiler &) = delete;
+	HostProfiler &operator=(const HostProfiler &) = delete;
+
+	static HostProfiler &instance();
+
+	static inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+	}
+
+	void enable();
+
+	bool is_enabled() const {
+		return enabled;
+	}
+
+	/* section with this name (shared by all callers), nullptr if disabled */
+	Section *get_section(const std::string &name);
+	/* section of the calling SystemC process, nullptr if disabled */
+	Section *get_process_section();
+
+	/* sorted by host time */
+	void show(std::ostream &os = std::cout) const;
+
+   private:
+	bool enabled = false;
+	uint64_t start_ticks = 0;
+	std::chrono::steady_clock::time_point start_time;
+	std::map<std::string, std::unique_ptr<Section>> sections;
+
+	HostProfiler() = default;
+};
+
+#endif  // RISCV_ISA_HOST_PROFILER_H
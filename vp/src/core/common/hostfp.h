@@ -0,0 +1,237 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "fp.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define HOSTFP_AVAILABLE 1
+#else
+#define HOSTFP_AVAILABLE 0
+#endif
+
+/*
+ * Host FPU fast path for scalar F/D arithmetic
+ *
+ * Executes the operation on the host SSE unit with the MXCSR rounding control set to the RISC-V rounding mode and
+ * reads back the IEEE exception flags from MXCSR. Only results that are known to be bit-exact w.r.t. softfloat are
+ * accepted: the operation must raise no flag besides inexact and must not produce a NaN. Everything else (NaN
+ * inputs/results, invalid, divide by zero, overflow, underflow, subnormal inputs and the RMM rounding mode which has
+ * no host equivalent) returns false and the caller falls back to softfloat. This also takes care of the RISC-V
+ * specific canonical NaN handling, since NaN-boxing is already resolved by FpRegs when reading the operands.
+ *
+ * On success the result is stored in res and the exception flags (softfloat encoding) are OR-ed into flags.
+ * Nothing is modified on failure.
+ *
+ * Zfh is not accelerated, as the host provides no native half precision arithmetic.
+ */
+namespace hostfp {
+
+#if HOSTFP_AVAILABLE
+
+constexpr uint32_t MXCSR_IE = 1 << 0;  // invalid operation
+constexpr uint32_t MXCSR_DE = 1 << 1;  // denormal operand
+constexpr uint32_t MXCSR_ZE = 1 << 2;  // divide by zero
+constexpr uint32_t MXCSR_OE = 1 << 3;  // overflow
+constexpr uint32_t MXCSR_UE = 1 << 4;  // underflow
+constexpr uint32_t MXCSR_PE = 1 << 5;  // precision (inexact)
+constexpr uint32_t MXCSR_FLAGS = MXCSR_IE | MXCSR_DE | MXCSR_ZE | MXCSR_OE | MXCSR_UE | MXCSR_PE;
+constexpr uint32_t MXCSR_DAZ = 1 << 6;
+constexpr uint32_t MXCSR_EXCEPTION_MASKS = 0x3F << 7;
+constexpr uint32_t MXCSR_RC_SHIFT = 13;
+constexpr uint32_t MXCSR_RC_MASK = 0b11 << MXCSR_RC_SHIFT;
+constexpr uint32_t MXCSR_FTZ = 1 << 15;
+
+inline bool to_mxcsr_rc(unsigned rm, uint32_t &rc) {
+	switch (rm) {
+		case FRM_RNE:
+			rc = 0b00;
+			break;
+		case FRM_RDN:
+			rc = 0b01;
+			break;
+		case FRM_RUP:
+			rc = 0b10;
+			break;
+		case FRM_RTZ:
+			rc = 0b11;
+			break;
+		default:
+			return false;
+	}
+	rc <<= MXCSR_RC_SHIFT;
+	return true;
+}
+
+/*
+ * NOTE: MXCSR is accessed through volatile asm and the operands/result are passed through empty volatile asm
+ * statements, so the compiler can neither move the arithmetic out of the window in which the guest rounding mode is
+ * active nor fold it at compile time.
+ */
+template <typename V, typename Op>
+__always_inline bool run(unsigned rm, V &a, V &b, V &c, Op op, V &res, uint32_t &mxcsr_flags) {
+	uint32_t rc;
+	if (!to_mxcsr_rc(rm, rc))
+		return false;
+
+	uint32_t host_csr;
+	asm volatile("stmxcsr %0" : "=m"(host_csr));
+	uint32_t guest_csr =
+	    (host_csr & ~(MXCSR_RC_MASK | MXCSR_FLAGS | MXCSR_DAZ | MXCSR_FTZ)) | MXCSR_EXCEPTION_MASKS | rc;
+	asm volatile("ldmxcsr %0" : : "m"(guest_csr));
+
+	asm volatile("" : "+x"(a), "+x"(b), "+x"(c));
+	res = op(a, b, c);
+	asm volatile("" : "+x"(res));
+
+	asm volatile("stmxcsr %0" : "=m"(guest_csr));
+	asm volatile("ldmxcsr %0" : : "m"(host_csr));
+
+	mxcsr_flags = guest_csr & MXCSR_FLAGS;
+	return true;
+}
+
+inline bool finish(uint32_t mxcsr_flags, bool is_nan, uint_fast8_t &flags) {
+	if ((mxcsr_flags & ~MXCSR_PE) || is_nan)
+		return false;
+	if (mxcsr_flags & MXCSR_PE)
+		flags |= softfloat_flag_inexact;
+	return true;
+}
+
+template <typename Op>
+__always_inline bool op_f32(unsigned rm, float32_t a, float32_t b, float32_t c, Op op, float32_t &res,
+                            uint_fast8_t &flags) {
+	__m128 va = _mm_castsi128_ps(_mm_cvtsi32_si128(a.v));
+	__m128 vb = _mm_castsi128_ps(_mm_cvtsi32_si128(b.v));
+	__m128 vc = _mm_castsi128_ps(_mm_cvtsi32_si128(c.v));
+	__m128 vr;
+	uint32_t mxcsr_flags;
+	if (!run(rm, va, vb, vc, op, vr, mxcsr_flags))
+		return false;
+
+	uint32_t r = _mm_cvtsi128_si32(_mm_castps_si128(vr));
+	if (!finish(mxcsr_flags, (r & 0x7FFFFFFF) > 0x7F800000, flags))
+		return false;
+	res = float32_t{r};
+	return true;
+}
+
+template <typename Op>
+__always_inline bool op_f64(unsigned rm, float64_t a, float64_t b, float64_t c, Op op, float64_t &res,
+                            uint_fast8_t &flags) {
+	__m128d va = _mm_castsi128_pd(_mm_cvtsi64_si128(a.v));
+	__m128d vb = _mm_castsi128_pd(_mm_cvtsi64_si128(b.v));
+	__m128d vc = _mm_castsi128_pd(_mm_cvtsi64_si128(c.v));
+	__m128d vr;
+	uint32_t mxcsr_flags;
+	if (!run(rm, va, vb, vc, op, vr, mxcsr_flags))
+		return false;
+
+	uint64_t r = _mm_cvtsi128_si64(_mm_castpd_si128(vr));
+	if (!finish(mxcsr_flags, (r & ~F64_SIGN_BIT) > 0x7FF0000000000000, flags))
+		return false;
+	res = float64_t{r};
+	return true;
+}
+
+#define HOSTFP_BINARY_OP(name, intrin_s, intrin_d)                                                               \
+	inline bool name(float32_t a, float32_t b, unsigned rm, float32_t &res, uint_fast8_t &flags) {               \
+		return op_f32(                                                                                           \
+		    rm, a, b, a, [](__m128 x, __m128 y, __m128) { return intrin_s(x, y); }, res, flags);                 \
+	}                                                                                                            \
+	inline bool name(float64_t a, float64_t b, unsigned rm, float64_t &res, uint_fast8_t &flags) {               \
+		return op_f64(                                                                                           \
+		    rm, a, b, a, [](__m128d x, __m128d y, __m128d) { return intrin_d(x, y); }, res, flags);              \
+	}
+
+HOSTFP_BINARY_OP(add, _mm_add_ss, _mm_add_sd)
+HOSTFP_BINARY_OP(sub, _mm_sub_ss, _mm_sub_sd)
+HOSTFP_BINARY_OP(mul, _mm_mul_ss, _mm_mul_sd)
+HOSTFP_BINARY_OP(div, _mm_div_ss, _mm_div_sd)
+
+#undef HOSTFP_BINARY_OP
+
+inline bool sqrt(float32_t a, unsigned rm, float32_t &res, uint_fast8_t &flags) {
+	return op_f32(
+	    rm, a, a, a, [](__m128 x, __m128, __m128) { return _mm_sqrt_ss(x); }, res, flags);
+}
+
+inline bool sqrt(float64_t a, unsigned rm, float64_t &res, uint_fast8_t &flags) {
+	return op_f64(
+	    rm, a, a, a, [](__m128d x, __m128d, __m128d) { return _mm_sqrt_sd(x, x); }, res, flags);
+}
+
+#if defined(__FMA__)
+/* fused multiply-add needs a single rounding, so it is only accelerated if the host provides FMA instructions */
+#define HOSTFP_FUSED_OP(name, intrin_s, intrin_d)                                                                   \
+	inline bool name(float32_t a, float32_t b, float32_t c, unsigned rm, float32_t &res, uint_fast8_t &flags) {     \
+		return op_f32(                                                                                              \
+		    rm, a, b, c, [](__m128 x, __m128 y, __m128 z) { return intrin_s(x, y, z); }, res, flags);               \
+	}                                                                                                               \
+	inline bool name(float64_t a, float64_t b, float64_t c, unsigned rm, float64_t &res, uint_fast8_t &flags) {     \
+		return op_f64(                                                                                              \
+		    rm, a, b, c, [](__m128d x, __m128d y, __m128d z) { return intrin_d(x, y, z); }, res, flags);            \
+	}
+#else
+#define HOSTFP_FUSED_OP(name, intrin_s, intrin_d)                                                      \
+	inline bool name(float32_t, float32_t, float32_t, unsigned, float32_t &, uint_fast8_t &) {         \
+		return false;                                                                                  \
+	}                                                                                                  \
+	inline bool name(float64_t, float64_t, float64_t, unsigned, float64_t &, uint_fast8_t &) {         \
+		return false;                                                                                  \
+	}
+#endif
+
+/* RISC-V vs. x86 naming: fnmadd = -(a*b)-c (x86 fnmsub), fnmsub = -(a*b)+c (x86 fnmadd) */
+HOSTFP_FUSED_OP(madd, _mm_fmadd_ss, _mm_fmadd_sd)
+HOSTFP_FUSED_OP(msub, _mm_fmsub_ss, _mm_fmsub_sd)
+HOSTFP_FUSED_OP(nmadd, _mm_fnmsub_ss, _mm_fnmsub_sd)
+HOSTFP_FUSED_OP(nmsub, _mm_fnmadd_ss, _mm_fnmadd_sd)
+
+#undef HOSTFP_FUSED_OP
+
+#else  // HOSTFP_AVAILABLE
+
+/* no host fast path available, always use softfloat */
+template <typename T>
+inline bool add(T, T, unsigned, T &, uint_fast8_t &) {
+	return false;
+}
+template <typename T>
+inline bool sub(T, T, unsigned, T &, uint_fast8_t &) {
+	return false;
+}
+template <typename T>
+inline bool mul(T, T, unsigned, T &, uint_fast8_t &) {
+	return false;
+}
+template <typename T>
+inline bool div(T, T, unsigned, T &, uint_fast8_t &) {
+	return false;
+}
+template <typename T>
+inline bool sqrt(T, unsigned, T &, uint_fast8_t &) {
+	return false;
+}
+template <typename T>
+inline bool madd(T, T, T, unsigned, T &, uint_fast8_t &) {
+	return false;
+}
+template <typename T>
+inline bool msub(T, T, T, unsigned, T &, uint_fast8_t &) {
+	return false;
+}
+template <typename T>
+inline bool nmadd(T, T, T, unsigned, T &, uint_fast8_t &) {
+	return false;
+}
+template <typename T>
+inline bool nmsub(T, T, T, unsigned, T &, uint_fast8_t &) {
+	return false;
+}
+
+#endif  // HOSTFP_AVAILABLE
+
+}  // namespace hostfp
@@ -0,0 +1,311 @@
+/*
+ * Randomized equivalence test of the host FPU fast path (hostfp.h) against softfloat
+ *
+ * Every operation is executed like in the ISS: the operands are read from FpRegs (i.e. NaN-boxing is resolved), the
+ * host fast path is tried and softfloat is used if it declines. The result register (boxed) and the accumulated
+ * exception flags must match the pure softfloat execution bit-exactly, for all rounding modes. A declined operation
+ * must leave the result and flags untouched. Operands are biased towards special values (zeros, infinities, NaNs,
+ * subnormals, extreme exponents) and register values are sometimes not properly NaN-boxed.
+ *
+ * usage: hostfp-test [iterations] [seed]
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <random>
+
+#include "fp.h"
+#include "hostfp.h"
+
+enum Op { ADD, SUB, MUL, DIV, SQRT, MADD, MSUB, NMADD, NMSUB, NUM_OPS };
+
+static const char *op_names[NUM_OPS] = {"add", "sub", "mul", "div", "sqrt", "madd", "msub", "nmadd", "nmsub"};
+static const unsigned rounding_modes[] = {FRM_RNE, FRM_RTZ, FRM_RDN, FRM_RUP, FRM_RMM};
+
+static std::mt19937_64 rng;
+
+static uint64_t random_f64() {
+	static const uint64_t specials[] = {
+	    0x0000000000000000, 0x8000000000000000,  // zeros
+	    0x7FF0000000000000, 0xFFF0000000000000,  // infinities
+	    0x7FF8000000000000, 0x7FF0000000000001,  // quiet and signaling NaN
+	    0x0000000000000001, 0x000FFFFFFFFFFFFF,  // subnormals
+	    0x0010000000000000, 0x7FEFFFFFFFFFFFFF,  // smallest normal, largest finite
+	    0x3FF0000000000000, 0xBFF0000000000000,  // +-1
+	};
+	uint64_t r = rng();
+	switch (r % 8) {
+		case 0:
+			return specials[(r >> 8) % (sizeof(specials) / sizeof(specials[0]))];
+		case 1:
+			/* exponent close to the limits (overflow, underflow, subnormal results) */
+			return (r & 0x800FFFFFFFFFFFFF) | (uint64_t((r >> 12) % 2 ? 0x7FE - (r >> 20) % 64 : 1 + (r >> 20) % 64)
+			                                   << 52);
+		case 2:
+			/* exponent around 1.0, few mantissa bits (exact results, ties) */
+			return (r & 0x8000000000000000) | (uint64_t(0x3F0 + (r >> 8) % 32) << 52) | ((r >> 16) & 0xF) << 48;
+		default:
+			return r;
+	}
+}
+
+static uint32_t random_f32() {
+	static const uint32_t specials[] = {
+	    0x00000000, 0x80000000, 0x7F800000, 0xFF800000, 0x7FC00000, 0x7F800001,
+	    0x00000001, 0x007FFFFF, 0x00800000, 0x7F7FFFFF, 0x3F800000, 0xBF800000,
+	};
+	uint64_t r = rng();
+	switch (r % 8) {
+		case 0:
+			return specials[(r >> 8) % (sizeof(specials) / sizeof(specials[0]))];
+		case 1:
+			return (r & 0x807FFFFF) | (uint32_t((r >> 12) % 2 ? 0xFE - (r >> 20) % 32 : 1 + (r >> 20) % 32) << 23);
+		case 2:
+			return (r & 0x80000000) | (uint32_t(0x78 + (r >> 8) % 16) << 23) | ((r >> 16) & 0xF) << 19;
+		default:
+			return uint32_t(r);
+	}
+}
+
+/* register value of a single precision operand, not NaN-boxed in some cases */
+static float64_t random_f32_reg() {
+	uint64_t upper = rng() % 16 ? 0xFFFFFFFF00000000 : (rng() & 0xFFFFFFFF00000000);
+	return float64_t{upper | random_f32()};
+}
+
+/* execute op with host fast path and softfloat fallback (as in the ISS) or with softfloat only */
+template <typename T>
+static T execute(Op op, T a, T b, T c, bool use_hostfp, bool &accepted);
+
+template <>
+float32_t execute<float32_t>(Op op, float32_t a, float32_t b, float32_t c, bool use_hostfp, bool &accepted) {
+	uint_fast8_t &flags = softfloat_exceptionFlags;
+	unsigned rm = softfloat_roundingMode;
+	float32_t res = {0xDEADBEEF};
+	float32_t untouched = res;
+	uint_fast8_t flags_before = flags;
+
+	switch (op) {
+		case ADD:
+			accepted = use_hostfp && hostfp::add(a, b, rm, res, flags);
+			break;
+		case SUB:
+			accepted = use_hostfp && hostfp::sub(a, b, rm, res, flags);
+			break;
+		case MUL:
+			accepted = use_hostfp && hostfp::mul(a, b, rm, res, flags);
+			break;
+		case DIV:
+			accepted = use_hostfp && hostfp::div(a, b, rm, res, flags);
+			break;
+		case SQRT:
+			accepted = use_hostfp && hostfp::sqrt(a, rm, res, flags);
+			break;
+		case MADD:
+			accepted = use_hostfp && hostfp::madd(a, b, c, rm, res, flags);
+			break;
+		case MSUB:
+			accepted = use_hostfp && hostfp::msub(a, b, c, rm, res, flags);
+			break;
+		case NMADD:
+			accepted = use_hostfp && hostfp::nmadd(a, b, c, rm, res, flags);
+			break;
+		case NMSUB:
+			accepted = use_hostfp && hostfp::nmsub(a, b, c, rm, res, flags);
+			break;
+		case NUM_OPS:
+			break;
+	}
+	if (accepted)
+		return res;
+
+	if (res.v != untouched.v || flags != flags_before) {
+		fprintf(stderr, "FAIL f32 %s: declined operation modified the result or flags\n", op_names[op]);
+		exit(EXIT_FAILURE);
+	}
+
+	switch (op) {
+		case ADD:
+			return f32_add(a, b);
+		case SUB:
+			return f32_sub(a, b);
+		case MUL:
+			return f32_mul(a, b);
+		case DIV:
+			return f32_div(a, b);
+		case SQRT:
+			return f32_sqrt(a);
+		case MADD:
+			return f32_mulAdd(a, b, c);
+		case MSUB:
+			return f32_mulAdd(a, b, f32_neg(c));
+		case NMADD:
+			return f32_mulAdd(f32_neg(a), b, f32_neg(c));
+		case NMSUB:
+			return f32_mulAdd(f32_neg(a), b, c);
+		case NUM_OPS:
+			break;
+	}
+	return res;
+}
+
+template <>
+float64_t execute<float64_t>(Op op, float64_t a, float64_t b, float64_t c, bool use_hostfp, bool &accepted) {
+	uint_fast8_t &flags = softfloat_exceptionFlags;
+	unsigned rm = softfloat_roundingMode;
+	float64_t res = {0xDEADBEEFDEADBEEF};
+	float64_t untouched = res;
+	uint_fast8_t flags_before = flags;
+
+	switch (op) {
+		case ADD:
+			accepted = use_hostfp && hostfp::add(a, b, rm, res, flags);
+			break;
+		case SUB:
+			accepted = use_hostfp && hostfp::sub(a, b, rm, res, flags);
+			break;
+		case MUL:
+			accepted = use_hostfp && hostfp::mul(a, b, rm, res, flags);
+			break;
+		case DIV:
+			accepted = use_hostfp && hostfp::div(a, b, rm, res, flags);
+			break;
+		case SQRT:
+			accepted = use_hostfp && hostfp::sqrt(a, rm, res, flags);
+			break;
+		case MADD:
+			accepted = use_hostfp && hostfp::madd(a, b, c, rm, res, flags);
+			break;
+		case MSUB:
+			accepted = use_hostfp && hostfp::msub(a, b, c, rm, res, flags);
+			break;
+		case NMADD:
+			accepted = use_hostfp && hostfp::nmadd(a, b, c, rm, res, flags);
+			break;
+		case NMSUB:
+			accepted = use_hostfp && hostfp::nmsub(a, b, c, rm, res, flags);
+			break;
+		case NUM_OPS:
+			break;
+	}
+	if (accepted)
+		return res;
+
+	if (res.v != untouched.v || flags != flags_before) {
+		fprintf(stderr, "FAIL f64 %s: declined operation modified the result or flags\n", op_names[op]);
+		exit(EXIT_FAILURE);
+	}
+
+	switch (op) {
+		case ADD:
+			return f64_add(a, b);
+		case SUB:
+			return f64_sub(a, b);
+		case MUL:
+			return f64_mul(a, b);
+		case DIV:
+			return f64_div(a, b);
+		case SQRT:
+			return f64_sqrt(a);
+		case MADD:
+			return f64_mulAdd(a, b, c);
+		case MSUB:
+			return f64_mulAdd(a, b, f64_neg(c));
+		case NMADD:
+			return f64_mulAdd(f64_neg(a), b, f64_neg(c));
+		case NMSUB:
+			return f64_mulAdd(f64_neg(a), b, c);
+		case NUM_OPS:
+			break;
+	}
+	return res;
+}
+
+struct Result {
+	uint64_t reg;
+	uint_fast8_t flags;
+};
+
+template <typename T>
+static Result run(FpRegs &fp_regs, Op op, unsigned rm, uint_fast8_t initial_flags, bool use_hostfp, bool &accepted);
+
+template <>
+Result run<float32_t>(FpRegs &fp_regs, Op op, unsigned rm, uint_fast8_t initial_flags, bool use_hostfp,
+                      bool &accepted) {
+	softfloat_roundingMode = rm;
+	softfloat_exceptionFlags = initial_flags;
+	float32_t res = execute(op, fp_regs.f32(1), fp_regs.f32(2), fp_regs.f32(3), use_hostfp, accepted);
+	fp_regs.write(4, res);
+	return {fp_regs.f64(4).v, softfloat_exceptionFlags};
+}
+
+template <>
+Result run<float64_t>(FpRegs &fp_regs, Op op, unsigned rm, uint_fast8_t initial_flags, bool use_hostfp,
+                      bool &accepted) {
+	softfloat_roundingMode = rm;
+	softfloat_exceptionFlags = initial_flags;
+	float64_t res = execute(op, fp_regs.f64(1), fp_regs.f64(2), fp_regs.f64(3), use_hostfp, accepted);
+	fp_regs.write(4, res);
+	return {fp_regs.f64(4).v, softfloat_exceptionFlags};
+}
+
+template <typename T>
+static void check(FpRegs &fp_regs, Op op, unsigned rm, uint64_t &num_accepted) {
+	const char *type = sizeof(T) == 4 ? "f32" : "f64";
+	uint_fast8_t initial_flags = rng() % 4 ? 0 : (rng() & 0x1F);
+
+	bool accepted;
+	Result host = run<T>(fp_regs, op, rm, initial_flags, true, accepted);
+	bool unused;
+	Result soft = run<T>(fp_regs, op, rm, initial_flags, false, unused);
+	if (accepted)
+		num_accepted++;
+
+	if (host.reg != soft.reg || host.flags != soft.flags) {
+		fprintf(stderr,
+		        "FAIL %s %s rm=%u: operands %016" PRIx64 " %016" PRIx64 " %016" PRIx64 ": result %016" PRIx64
+		        " flags %02x, expected %016" PRIx64 " flags %02x (fast path %s)\n",
+		        type, op_names[op], rm, fp_regs.f64(1).v, fp_regs.f64(2).v, fp_regs.f64(3).v, host.reg,
+		        unsigned(host.flags), soft.reg, unsigned(soft.flags), accepted ? "taken" : "declined");
+		exit(EXIT_FAILURE);
+	}
+}
+
+int main(int argc, char **argv) {
+	uint64_t iterations = argc > 1 ? strtoull(argv[1], nullptr, 0) : 2000000;
+	uint64_t seed = argc > 2 ? strtoull(argv[2], nullptr, 0) : 1;
+	rng.seed(seed);
+
+	uint64_t accepted_f32[NUM_OPS] = {};
+	uint64_t accepted_f64[NUM_OPS] = {};
+	FpRegs fp_regs;
+
+	for (uint64_t i = 0; i < iterations; ++i) {
+		Op op = Op(rng() % NUM_OPS);
+		unsigned rm = rounding_modes[rng() % (sizeof(rounding_modes) / sizeof(rounding_modes[0]))];
+
+		if (i % 2) {
+			for (unsigned r = 1; r <= 3; ++r) fp_regs.write(r, random_f32_reg());
+			check<float32_t>(fp_regs, op, rm, accepted_f32[op]);
+		} else {
+			for (unsigned r = 1; r <= 3; ++r) fp_regs.write(r, float64_t{random_f64()});
+			check<float64_t>(fp_regs, op, rm, accepted_f64[op]);
+		}
+	}
+
+	printf("%" PRIu64 " operations (seed %" PRIu64 ") match softfloat, fast path taken:\n", iterations, seed);
+	for (unsigned op = 0; op < NUM_OPS; ++op)
+		printf("  %-6s f32 %10" PRIu64 "  f64 %10" PRIu64 "\n", op_names[op], accepted_f32[op], accepted_f64[op]);
+
+#if HOSTFP_AVAILABLE
+	/* a fast path that never accepts anything would pass trivially */
+	for (unsigned op = ADD; op <= SQRT; ++op) {
+		if (iterations >= 10000 && (accepted_f32[op] == 0 || accepted_f64[op] == 0)) {
+			fprintf(stderr, "FAIL %s: fast path never taken\n", op_names[op]);
+			return EXIT_FAILURE;
+		}
+	}
+#endif
+	return EXIT_SUCCESS;
+}
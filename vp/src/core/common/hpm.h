@@ -0,0 +1,128 @@
+#ifndef RISCV_ISA_HPM_H
+#define RISCV_ISA_HPM_H
+
+#include <stdint.h>
+
+#include "irq_if.h"
+
+/*
+ * Hardware performance monitor: event counters behind mhpmcounter3..31 and mhpmevent3..31 (incl. Sscofpmf)
+ *
+ * Events are counted with a plain increment where they occur (ISS, MMU, LSCache) and folded into the configured
+ * counters at the commit points of the ISS (see ISS_CT::commit_hpm), i.e. on the slow path, at least every tenth of a
+ * TLM quantum, on privilege level changes and before counter CSR accesses. Overflows are detected with the same
+ * granularity, which is sufficient for sampling (e.g. perf record in a Linux guest).
+ *
+ * mhpmevent encoding (e.g. for the riscv,pmu node of OpenSBI):
+ *  - bits 55..0: event selector, see HPMEvent, all other values count nothing
+ *  - bits 60/61/62: UINH/SINH/MINH, inhibit counting in U/S/M-mode
+ *  - bit 63: OF, set on counter overflow; raises a local counter overflow interrupt (LCOFI) if it was clear
+ */
+enum HPMEvent {
+	HPM_EVENT_NONE = 0,
+	HPM_EVENT_LOAD = 1,          // loads, incl. floating point
+	HPM_EVENT_STORE = 2,         // stores, incl. floating point
+	HPM_EVENT_BRANCH_TAKEN = 3,  // taken conditional branches
+	HPM_EVENT_TRAP = 4,          // exceptions and interrupts
+	HPM_EVENT_TLB_MISS = 5,      // MMU TLB misses (page table walks)
+	HPM_EVENT_LSCACHE_MISS = 6,  // loads and stores not served by the LSCache
+	HPM_EVENT_AMO = 7,           // atomic memory operations, incl. LR/SC
+	HPM_EVENT_FP = 8,            // floating point operations (except loads/stores)
+	HPM_NUM_EVENTS
+};
+
+class HPM {
+   public:
+	static constexpr unsigned FIRST_COUNTER = 3;
+	static constexpr unsigned NUM_COUNTERS = 29;
+
+	static constexpr uint64_t EVENT_OF = uint64_t(1) << 63;
+	static constexpr uint64_t EVENT_MINH = uint64_t(1) << 62;
+	static constexpr uint64_t EVENT_SINH = uint64_t(1) << 61;
+	static constexpr uint64_t EVENT_UINH = uint64_t(1) << 60;
+	static constexpr uint64_t EVENT_SELECTOR_MASK = (uint64_t(1) << 56) - 1;
+	static constexpr uint64_t EVENT_MASK = EVENT_OF | EVENT_MINH | EVENT_SINH | EVENT_UINH | EVENT_SELECTOR_MASK;
+
+	/* raw event counts, monotonic */
+	uint64_t events[HPM_NUM_EVENTS] = {};
+
+	inline void count(HPMEvent e) {
+		events[e]++;
+	}
+
+	/* any counter configured, i.e. commit is required */
+	inline bool is_active() const {
+		return active != 0;
+	}
+
+	/* n: counter number (3..31) */
+	uint64_t get_counter(unsigned n) const {
+		return counter[n - FIRST_COUNTER];
+	}
+
+	void set_counter(unsigned n, uint64_t value) {
+		counter[n - FIRST_COUNTER] = value;
+	}
+
+	uint64_t get_event(unsigned n) const {
+		return event[n - FIRST_COUNTER];
+	}
+
+	void set_event(unsigned n, uint64_t value) {
+		unsigned i = n - FIRST_COUNTER;
+		uint64_t selector = value & EVENT_SELECTOR_MASK;
+		event[i] = value & EVENT_MASK;
+		if (selector != HPM_EVENT_NONE && selector < HPM_NUM_EVENTS)
+			active |= 1u << i;
+		else
+			active &= ~(1u << i);
+	}
+
+	/* OF bits of all counters at their counter number (scountovf layout) */
+	uint32_t get_overflow_bits() const {
+		uint32_t bits = 0;
+		for (unsigned i = 0; i < NUM_COUNTERS; ++i) {
+			if (event[i] & EVENT_OF)
+				bits |= 1u << (i + FIRST_COUNTER);
+		}
+		return bits;
+	}
+
+	/*
+	 * fold the events since the last commit into the counters, except counters inhibited by mcountinhibit or by the
+	 * privilege level filter of their mhpmevent; returns true if an OF bit was set, i.e. a LCOFI has to be raised
+	 */
+	bool commit(PrivilegeLevel prv, uint32_t mcountinhibit) {
+		uint64_t delta[HPM_NUM_EVENTS];
+		for (unsigned e = 0; e < HPM_NUM_EVENTS; ++e) {
+			delta[e] = events[e] - committed[e];
+			committed[e] = events[e];
+		}
+
+		uint64_t inhibit = prv == MachineMode ? EVENT_MINH : prv == SupervisorMode ? EVENT_SINH : EVENT_UINH;
+		uint32_t pending = active & ~(mcountinhibit >> FIRST_COUNTER);
+		bool overflow = false;
+		while (pending) {
+			unsigned i = __builtin_ctz(pending);
+			pending &= pending - 1;
+			if (event[i] & inhibit)
+				continue;
+
+			uint64_t old = counter[i];
+			counter[i] += delta[event[i] & EVENT_SELECTOR_MASK];
+			if (counter[i] < old && !(event[i] & EVENT_OF)) {
+				event[i] |= EVENT_OF;
+				overflow = true;
+			}
+		}
+		return overflow;
+	}
+
+   private:
+	uint64_t counter[NUM_COUNTERS] = {};
+	uint64_t event[NUM_COUNTERS] = {};
+	uint64_t committed[HPM_NUM_EVENTS] = {};
+	uint32_t active = 0;
+};
+
+#endif  // RISCV_ISA_HPM_H
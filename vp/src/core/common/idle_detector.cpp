@@ -0,0 +1,37 @@
+#include "idle_detector.h"
+
+#include <chrono>
+
+IdleDetector &IdleDetector::instance() {
+	static IdleDetector detector;
+	return detector;
+}
+
+void IdleDetector::notify_host_input() {
+	{
+		std::lock_guard<std::mutex> lock(host_input_mutex);
+		host_input_cnt++;
+	}
+	host_input_cond.notify_all();
+}
+
+uint64_t IdleDetector::get_host_input_count() {
+	std::lock_guard<std::mutex> lock(host_input_mutex);
+	return host_input_cnt;
+}
+
+uint64_t IdleDetector::wait_for_host_input(uint64_t seen_cnt, uint64_t timeout_us) {
+	auto start = std::chrono::steady_clock::now();
+	auto input_arrived = [this, seen_cnt] { return host_input_cnt != seen_cnt; };
+
+	std::unique_lock<std::mutex> lock(host_input_mutex);
+	if (timeout_us == WAIT_FOREVER) {
+		host_input_cond.wait(lock, input_arrived);
+	} else {
+		host_input_cond.wait_for(lock, std::chrono::microseconds(timeout_us), input_arrived);
+	}
+	lock.unlock();
+
+	auto waited = std::chrono::steady_clock::now() - start;
+	return std::chrono::duration_cast<std::chrono::microseconds>(waited).count();
+}
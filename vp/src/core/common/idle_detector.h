@@ -0,0 +1,70 @@
+#ifndef RISCV_ISA_IDLE_DETECTOR_H
+#define RISCV_ISA_IDLE_DETECTOR_H
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <mutex>
+
+/*
+ * Global idle detector
+ *
+ * Harts register themselves on construction and report when they block in WFI (see WFI in the ISS). If every
+ * registered hart waits for an interrupt, no simulated work is left until either a timer fires, a device event is
+ * scheduled or asynchronous input arrives from the host (e.g. UART receive thread, VNC client).
+ * Timer models (see lwrt_clint.h) use this to block the host thread instead of busy polling.
+ *
+ * Hart accounting is only done from SystemC context. Host input notification is thread safe and may be called from
+ * any host thread.
+ */
+class IdleDetector {
+	unsigned num_harts = 0;
+	unsigned num_harts_in_wfi = 0;
+
+	std::mutex host_input_mutex;
+	std::condition_variable host_input_cond;
+	uint64_t host_input_cnt = 0;
+
+	IdleDetector() = default;
+
+   public:
+	static constexpr uint64_t WAIT_FOREVER = UINT64_MAX;
+
+	IdleDetector(const IdleDetector &) = delete;
+	IdleDetector &operator=(const IdleDetector &) = delete;
+
+	static IdleDetector &instance();
+
+	void register_hart() {
+		num_harts++;
+	}
+
+	void enter_wfi() {
+		num_harts_in_wfi++;
+	}
+
+	void leave_wfi() {
+		num_harts_in_wfi--;
+	}
+
+	bool all_harts_idle() {
+		return num_harts > 0 && num_harts_in_wfi == num_harts;
+	}
+
+	/* THREADSAFE METHODS: */
+
+	/* call whenever asynchronous input was queued for the simulation */
+	void notify_host_input();
+
+	/* number of host input notifications so far (use as argument for wait_for_host_input) */
+	uint64_t get_host_input_count();
+
+	/*
+	 * block the calling (host) thread until host input arrives (i.e. the host input count differs from seen_cnt) or
+	 * timeout_us microseconds of wall clock time passed
+	 * returns the wall clock time actually waited (in microseconds)
+	 */
+	uint64_t wait_for_host_input(uint64_t seen_cnt, uint64_t timeout_us);
+};
+
+#endif  // RISCV_ISA_IDLE_DETECTOR_H
@@ -1791,6 +1791,7 @@ std::array<const char *, Opcode::NUMBER_OF_INSTRUCTIONS> Opcode::mappingStr = {
     "NOP (ADDI rd=zero)",
     "SLTI",
     "NOP (SLTI rd=zero)",
+    "MARKER (SLTI rd=rs1=zero)",
     "SLTIU",
     "NOP (SLTIU rd=zero)",
     "XORI",
@@ -2837,6 +2838,7 @@ Opcode::Type Opcode::getType(Opcode::Mapping mapping) {
 		case ADDI_NOP:
 		case SLTI:
 		case SLTI_NOP:
+		case MARKER:
 		case SLTIU:
 		case SLTIU_NOP:
 		case XORI:
@@ -4239,7 +4241,7 @@ Opcode::Mapping Instruction::decode_normal(Architecture arch, const RV_ISA_Confi
 				case F3_ADDI:
 					MATCH_AND_RETURN_INSTR_OR_NOP(ADDI);
 				case F3_SLTI:
-					MATCH_AND_RETURN_INSTR_OR_NOP(SLTI);
+					MATCH_AND_RETURN_INSTR_OR_OPZERO(SLTI, instr.rs1() != 0 ? SLTI_NOP : MARKER);
 				case F3_SLTIU:
 					MATCH_AND_RETURN_INSTR_OR_NOP(SLTIU);
 				case F3_XORI:
@@ -321,6 +321,7 @@ enum Mapping {
 	ADDI_NOP,
 	SLTI,
 	SLTI_NOP,
+	MARKER,  // slti zero, zero, <id>: simulator marker (see RegionOfInterest)
 	SLTIU,
 	SLTIU_NOP,
 	XORI,
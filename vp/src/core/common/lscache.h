@@ -65,7 +65,22 @@ class LSCache_IF_T {
 	uint64_t hartId = 0;
 	dmemif_t *data_mem = nullptr;
 
+	/* without a cache, every access is a miss */
+	__always_inline void count_load() {
+		num_loads++;
+		num_misses++;
+	}
+	__always_inline void count_store() {
+		num_stores++;
+		num_misses++;
+	}
+
    public:
+	/* event counters (see hpm.h), always enabled in contrast to stats */
+	uint64_t num_loads = 0;
+	uint64_t num_stores = 0;
+	uint64_t num_misses = 0;
+
 	LSCache_IF_T() {
 		init(false, 0, nullptr);
 	}
@@ -76,6 +91,11 @@ class LSCache_IF_T {
 		this->data_mem = data_mem;
 	}
 
+	/* switch the cache at runtime (see roi.h) */
+	void set_enabled(bool enabled) {
+		this->enabled = enabled;
+	}
+
 	__always_inline bool is_enabled() {
 #ifdef LSCACHE_FORCED_ENABLED
 		return true;
@@ -92,38 +112,52 @@ class LSCache_IF_T {
 		data_mem->flush_tlb();
 	}
 
+	/* drop all cached pages, e.g. after a page became watched (see watchpoints.h) */
+	__always_inline void invalidate() {}
+
 	__always_inline int64_t load_double(uint64_t addr) {
+		count_load();
 		return data_mem->load_double(addr);
 	}
 	__always_inline T_sxlen_t load_word(uint64_t addr) {
+		count_load();
 		return data_mem->load_word(addr);
 	}
 	__always_inline T_sxlen_t load_half(uint64_t addr) {
+		count_load();
 		return data_mem->load_half(addr);
 	}
 	__always_inline T_sxlen_t load_byte(uint64_t addr) {
+		count_load();
 		return data_mem->load_byte(addr);
 	}
 	__always_inline T_uxlen_t load_uword(uint64_t addr) {
+		count_load();
 		return data_mem->load_uword(addr);
 	}
 	__always_inline T_uxlen_t load_uhalf(uint64_t addr) {
+		count_load();
 		return data_mem->load_uhalf(addr);
 	}
 	__always_inline T_uxlen_t load_ubyte(uint64_t addr) {
+		count_load();
 		return data_mem->load_ubyte(addr);
 	}
 
 	__always_inline void store_double(uint64_t addr, uint64_t value) {
+		count_store();
 		data_mem->store_double(addr, value);
 	}
 	__always_inline void store_word(uint64_t addr, uint32_t value) {
+		count_store();
 		data_mem->store_word(addr, value);
 	}
 	__always_inline void store_half(uint64_t addr, uint16_t value) {
+		count_store();
 		data_mem->store_half(addr, value);
 	}
 	__always_inline void store_byte(uint64_t addr, uint8_t value) {
+		count_store();
 		data_mem->store_byte(addr, value);
 	}
 };
@@ -244,13 +278,16 @@ class LSCache_T : public LSCache_IF_T<T_sxlen_t, T_uxlen_t> {
 	template <typename RET_T, typename CAST_T, Load_F<RET_T> load_f>
 	__always_inline RET_T load(uint64_t addr) {
 		stats.inc_loads();
+		this->num_loads++;
 		if (unlikely(this->data_mem->is_bus_locked())) {
 			stats.inc_bus_locked();
+			this->num_misses++;
 			return ((this->data_mem)->*(load_f))(addr);
 		}
 
 		CAST_T *haddr = (CAST_T *)try_get_from_cache_load(addr);
 		if (unlikely(haddr == nullptr)) {
+			this->num_misses++;
 			CAST_T ret = ((this->data_mem)->*(load_f))(addr);
 			try_add_to_cache(addr, LSCACHE_LOAD_VALID_BITS);
 			return ret;
@@ -265,14 +302,17 @@ class LSCache_T : public LSCache_IF_T<T_sxlen_t, T_uxlen_t> {
 	template <typename ARG_T, Store_F<ARG_T> store_f>
 	__always_inline void store(uint64_t addr, ARG_T value) {
 		stats.inc_stores();
+		this->num_stores++;
 		if (unlikely(this->data_mem->is_bus_locked())) {
 			stats.inc_bus_locked();
+			this->num_misses++;
 			((this->data_mem)->*(store_f))(addr, value);
 			return;
 		}
 
 		ARG_T *haddr = (ARG_T *)try_get_from_cache_store(addr);
 		if (unlikely(haddr == nullptr)) {
+			this->num_misses++;
 			((this->data_mem)->*(store_f))(addr, value);
 			try_add_to_cache(addr, LSCACHE_STORE_VALID_BITS);
 			return;
@@ -297,6 +337,16 @@ class LSCache_T : public LSCache_IF_T<T_sxlen_t, T_uxlen_t> {
 		super::fence_vma();
 	}
 
+	void set_enabled(bool enabled) {
+		flush();
+		super::set_enabled(enabled);
+	}
+
+	__always_inline void invalidate() {
+		stats.inc_flushs();
+		flush();
+	}
+
 	__always_inline int64_t load_double(uint64_t addr) {
 		return load<int64_t, int64_t, &dmemif_t::load_double>(addr);
 	}
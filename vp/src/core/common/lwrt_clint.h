@@ -3,10 +3,13 @@
 
 #include <tlm_utils/simple_target_socket.h>
 
+#include <algorithm>
 #include <chrono>
 #include <systemc>
 
 #include "clint_if.h"
+#include "host_profiler.h"
+#include "idle_detector.h"
 #include "irq_if.h"
 #include "util/memory_map.h"
 
@@ -50,6 +53,7 @@ struct LWRT_CLINT : public clint_if, public sc_core::sc_module {
 
 	sc_core::sc_time clock_cycle = sc_core::sc_time(10, sc_core::SC_NS);
 	sc_core::sc_event irq_event;
+	sc_core::sc_event wake_event;  // mtimecmp/msip written, ends the idle wait (see wait_while_idle)
 
 	RegisterRange regs_mtime{0xBFF8, 8};
 	IntegerView<uint64_t> mtime{regs_mtime};
@@ -90,16 +94,25 @@ struct LWRT_CLINT : public clint_if, public sc_core::sc_module {
 	void run() {
 		init_time();
 
+		IdleDetector &idle = IdleDetector::instance();
+		HostProfiler::Section *profile = HostProfiler::instance().get_process_section();
+
 		while (true) {
-			/* poll with 10us */
-			sc_core::wait(10, sc_core::SC_US);
+			if (idle.all_harts_idle()) {
+				/* all harts are in WFI: sleep on the host until the next deadline or host input */
+				wait_while_idle(idle);
+			} else {
+				/* poll with 10us */
+				sc_core::wait(10, sc_core::SC_US);
+			}
+			HostProfiler::Scope scope(profile);
 
-			update_and_get_mtime();
+			checked_mtime = update_and_get_mtime();
 
 			for (unsigned i = 0; i < NumberOfCores; ++i) {
 				auto cmp = mtimecmp[i];
 				// std::cout << "[vp::clint] process mtimecmp[" << i << "]=" << cmp << ", mtime=" << mtime << std::endl;
-				if (cmp > 0 && mtime >= cmp) {
+				if (cmp > 0 && checked_mtime >= cmp) {
 					// std::cout << "[vp::clint] set timer interrupt for core " << i << std::endl;
 					target_harts[i]->trigger_timer_interrupt();
 				}
@@ -127,6 +140,7 @@ struct LWRT_CLINT : public clint_if, public sc_core::sc_module {
 			// std::cout << "[vp::clint] unset timer interrupt for core " << i << std::endl;
 			target_harts[i]->clear_timer_interrupt();
 		}
+		wake_event.notify();
 	}
 
 	void post_write_msip(RegisterRange::WriteInfo t) {
@@ -138,6 +152,7 @@ struct LWRT_CLINT : public clint_if, public sc_core::sc_module {
 		} else {
 			target_harts[idx]->clear_software_interrupt();
 		}
+		wake_event.notify();
 	}
 
 	void transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
@@ -148,6 +163,45 @@ struct LWRT_CLINT : public clint_if, public sc_core::sc_module {
 
    private:
 	std::chrono::time_point<std::chrono::high_resolution_clock> start_time;
+	uint64_t checked_mtime = 0;  // mtime of the last interrupt check in run, i.e. deadlines up to it are delivered
+
+	void wait_while_idle(IdleDetector &idle) {
+		uint64_t seen_input = idle.get_host_input_count();
+		uint64_t timeout = IdleDetector::WAIT_FOREVER;
+
+		/* earliest armed timer deadline (mtime is wall clock based) */
+		uint64_t now = get_time();
+		for (unsigned i = 0; i < NumberOfCores; ++i) {
+			auto cmp = mtimecmp[i];
+			/* disarmed or already delivered, the interrupt stays pending until mtimecmp is written */
+			if (cmp == 0 || cmp <= checked_mtime)
+				continue;
+			/* expired since the last check, deliver it right away */
+			if (cmp <= now)
+				return;
+			timeout = std::min<uint64_t>(timeout, cmp - now);
+		}
+
+		/* do not sleep past activity already scheduled in the simulation (e.g. device threads) */
+		if (sc_core::sc_pending_activity_at_current_time()) {
+			sc_core::wait(sc_core::SC_ZERO_TIME);
+			return;
+		}
+		if (sc_core::sc_pending_activity_at_future_time()) {
+			auto next = sc_core::sc_time_to_pending_activity();
+			uint64_t next_us = next / sc_core::sc_time(1, sc_core::SC_US);
+			if (next_us == 0) {
+				/* less than the mtime resolution, advance to the activity without sleeping on the host */
+				sc_core::wait(next, wake_event);
+				return;
+			}
+			timeout = std::min(timeout, next_us);
+		}
+
+		uint64_t slept = idle.wait_for_host_input(seen_input, timeout);
+		/* advance simulation time accordingly, this also lets the kernel deliver pending async updates */
+		sc_core::wait(sc_core::sc_time(std::max<uint64_t>(1, std::min(slept, timeout)), sc_core::SC_US), wake_event);
+	}
 
 	void init_time() {
 		start_time = std::chrono::high_resolution_clock::now();
@@ -35,6 +35,7 @@ struct CombinedMemoryInterface_T : public sc_core::sc_module,
 	T_RVX_ISS &iss;
 	std::shared_ptr<bus_lock_if> bus_lock;
 	uint64_t lr_addr = 0;
+	uint64_t lr_value = 0;
 
 	tlm_utils::simple_initiator_socket<CombinedMemoryInterface_T> isock;
 	tlm_utils::tlm_quantumkeeper &quantum_keeper;
@@ -52,6 +53,8 @@ struct CombinedMemoryInterface_T : public sc_core::sc_module,
 	bool last_access_was_dmi = false;
 	void *last_dmi_page_host_addr = nullptr;
 
+	MemoryAccessStats *access_stats = nullptr;  // optional, set while the statistics are enabled
+
 	CombinedMemoryInterface_T(sc_core::sc_module_name, T_RVX_ISS &owner, MMU_T<T_RVX_ISS> *mmu = nullptr)
 	    : iss(owner), quantum_keeper(iss.quantum_keeper), mmu(mmu) {
 		ext = new initiator_ext(&owner);  // tlm_generic_payload frees all extension objects in destructor, therefore
@@ -109,6 +112,8 @@ struct CombinedMemoryInterface_T : public sc_core::sc_module,
 			if (e.contains(addr)) {
 				quantum_keeper.inc(dmi_access_delay);
 				ans = e.load<T>(addr);
+				if (access_stats != nullptr)
+					access_stats->dmi_loads++;
 
 				/* save the host address of the start of the 4KiB page containing addr */
 				last_access_was_dmi = true;
@@ -119,6 +124,8 @@ struct CombinedMemoryInterface_T : public sc_core::sc_module,
 		}
 
 		_do_transaction(tlm::TLM_READ_COMMAND, addr, (uint8_t *)&ans, sizeof(T));
+		if (access_stats != nullptr)
+			access_stats->tlm_loads++;
 
 		/*
 		 * A transaction may lead to a context switch. The other context may issue transaction handled via dmi.
@@ -135,34 +142,60 @@ struct CombinedMemoryInterface_T : public sc_core::sc_module,
 		bus_lock->wait_for_access_rights(iss.get_hart_id());
 
 		for (auto &e : dmi_ranges) {
-			if (e.contains(addr)) {
+			if (e.allows(addr, true)) {
 				quantum_keeper.inc(dmi_access_delay);
 				e.store(addr, value);
+				if (access_stats != nullptr)
+					access_stats->dmi_stores++;
 
 				/* save the host address of the start of the 4KiB page containing addr */
 				last_access_was_dmi = true;
 				last_dmi_page_host_addr = e.get_mem_ptr_to_global_addr<T>(addr & ~0xFFF);
 
+				bus_lock->snoop_store(addr, sizeof(T));
 				atomic_unlock();
 				return;
 			}
 		}
 
 		_do_transaction(tlm::TLM_WRITE_COMMAND, addr, (uint8_t *)&value, sizeof(T));
+		if (access_stats != nullptr)
+			access_stats->tlm_stores++;
+		bus_lock->snoop_store(addr, sizeof(T));
 		atomic_unlock();
 
 		/* see comment in _raw_load_data */
 		last_access_was_dmi = false;
 	}
 
+	/*
+	 * data watchpoints (see watchpoints.h): accesses to watched pages are never reported as DMI, which keeps these
+	 * pages out of the LSCache
+	 */
+	template <typename T>
+	inline void check_watchpoints(uint64_t addr, T value, bool is_store) {
+		if (!iss.watchpoints.is_watched(addr, sizeof(T)))
+			return;
+		last_access_was_dmi = false;
+
+		uint64_t raw = 0;
+		memcpy(&raw, &value, sizeof(T));
+		iss.watchpoint_access(addr, sizeof(T), is_store, raw);
+	}
+
 	template <typename T>
 	inline T _load_data(uint64_t addr) {
-		return _raw_load_data<T>(v2p(addr, LOAD));
+		T ans = _raw_load_data<T>(v2p(addr, LOAD));
+		if (unlikely(iss.watchpoints.is_active()))
+			check_watchpoints(addr, ans, false);
+		return ans;
 	}
 
 	template <typename T>
 	inline void _store_data(uint64_t addr, T value) {
 		_raw_store_data(v2p(addr, STORE), value);
+		if (unlikely(iss.watchpoints.is_active()))
+			check_watchpoints(addr, value, true);
 	}
 
 	uint64_t mmu_load_pte64(uint64_t addr) override {
@@ -210,6 +243,15 @@ struct CombinedMemoryInterface_T : public sc_core::sc_module,
 		return _raw_load_data<uint32_t>(v2p(addr, FETCH));
 	}
 
+	template <typename T>
+	inline T *_get_dmi_host_ptr(uint64_t paddr, bool is_store) {
+		for (auto &e : dmi_ranges) {
+			if (e.allows(paddr, is_store))
+				return e.get_mem_ptr_to_global_addr<T>(paddr);
+		}
+		return nullptr;
+	}
+
 	template <typename T>
 	T _atomic_load_data(uint64_t addr) {
 		bus_lock->lock(iss.get_hart_id());
@@ -220,11 +262,35 @@ struct CombinedMemoryInterface_T : public sc_core::sc_module,
 		assert(bus_lock->is_locked(iss.get_hart_id()));
 		_store_data(addr, value);
 	}
+	/*
+	 * LR/SC on DMI memory does not lock the bus. Instead, a reservation is registered at the bus lock and invalidated
+	 * by any snooped store to the reserved granule. Stores which bypass this interface (i.e. LSCache hits) are not
+	 * snooped, hence SC additionally requires the memory to still hold the value loaded by LR (compare-and-swap).
+	 * LR/SC on non-DMI memory locks the bus until SC (or until the ISS releases the reservation).
+	 */
 	template <typename T>
 	T _atomic_load_reserved_data(uint64_t addr) {
+		uint64_t paddr = v2p(addr, LOAD);
+		bus_lock->wait_for_access_rights(iss.get_hart_id());
+
+		T *host_ptr = _get_dmi_host_ptr<T>(paddr, false);
+		if (host_ptr) {
+			quantum_keeper.inc(dmi_access_delay);
+			T ans = __atomic_load_n(host_ptr, __ATOMIC_ACQUIRE);
+			lr_addr = addr;
+			lr_value = ans;
+			bus_lock->set_reservation(iss.get_hart_id(), paddr);
+			if (unlikely(iss.watchpoints.is_active()))
+				check_watchpoints(addr, ans, false);
+			return ans;
+		}
+
 		bus_lock->lock(iss.get_hart_id());
 		lr_addr = addr;
-		return _load_data<T>(addr);
+		T ans = _raw_load_data<T>(paddr);
+		if (unlikely(iss.watchpoints.is_active()))
+			check_watchpoints(addr, ans, false);
+		return ans;
 	}
 	template <typename T>
 	bool _atomic_store_conditional_data(uint64_t addr, T value) {
@@ -237,8 +303,31 @@ struct CombinedMemoryInterface_T : public sc_core::sc_module,
 				return true;
 			}
 			atomic_unlock();
+			return false;
 		}
-		return false;
+
+		if (!bus_lock->has_reservation(iss.get_hart_id()) || addr != lr_addr) {
+			bus_lock->clear_reservation(iss.get_hart_id());
+			return false;
+		}
+
+		uint64_t paddr = v2p(addr, STORE);
+		bus_lock->wait_for_access_rights(iss.get_hart_id());
+		/* translation and waiting may context switch -> check again */
+		bool reserved = bus_lock->has_reservation(iss.get_hart_id());
+		bus_lock->clear_reservation(iss.get_hart_id());
+		T *host_ptr = _get_dmi_host_ptr<T>(paddr, true);
+		if (!reserved || !host_ptr)
+			return false;
+
+		quantum_keeper.inc(dmi_access_delay);
+		T expected = lr_value;
+		if (!__atomic_compare_exchange_n(host_ptr, &expected, value, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+			return false;
+		bus_lock->snoop_store(paddr, sizeof(T));
+		if (unlikely(iss.watchpoints.is_active()))
+			check_watchpoints(addr, value, true);
+		return true;
 	}
 
 	int64_t load_double(uint64_t addr) override {
@@ -306,8 +395,28 @@ struct CombinedMemoryInterface_T : public sc_core::sc_module,
 		return _atomic_store_conditional_data(addr, value);
 	}
 
+	void *atomic_get_dmi_host_addr(uint64_t addr, unsigned num_bytes) override {
+		/* AMOs on watched pages take the load/store path, which checks the watchpoints */
+		if (unlikely(iss.watchpoints.is_active()) && iss.watchpoints.is_watched(addr, num_bytes))
+			return nullptr;
+
+		uint64_t paddr = v2p(addr, STORE);
+		bus_lock->wait_for_access_rights(iss.get_hart_id());
+
+		for (auto &e : dmi_ranges) {
+			if (e.allows(paddr, true)) {
+				/* load + store */
+				quantum_keeper.inc(2 * dmi_access_delay);
+				bus_lock->snoop_store(paddr, num_bytes);
+				return e.get_mem_ptr_to_global_addr<uint8_t>(paddr);
+			}
+		}
+		return nullptr;
+	}
+
 	void atomic_unlock() override {
 		bus_lock->unlock(iss.get_hart_id());
+		bus_lock->clear_reservation(iss.get_hart_id());
 	}
 
 	inline bool is_bus_locked() override {
@@ -321,6 +430,48 @@ struct CombinedMemoryInterface_T : public sc_core::sc_module,
 		}
 		return last_dmi_page_host_addr;
 	}
+
+	/* see comment in data_memory_if_T */
+	bool peek_data(uint64_t addr, void *dst, unsigned num_bytes) override {
+		uint64_t paddr = addr;
+		if (mmu != nullptr && !mmu->peek_virtual_to_physical_addr(addr, LOAD, paddr))
+			return false;
+
+		for (auto &e : dmi_ranges) {
+			if (e.contains(paddr) && e.contains(paddr + num_bytes - 1)) {
+				memcpy(dst, e.get_mem_ptr_to_global_addr<uint8_t>(paddr), num_bytes);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/* see comment in data_memory_if_T */
+	void *get_dmi_host_addr(uint64_t addr, unsigned num_bytes, bool is_store) override {
+		if (unlikely(iss.watchpoints.is_active()) && iss.watchpoints.is_watched(addr, num_bytes))
+			return nullptr;
+		/* another hart holds the bus lock, use the regular path which waits */
+		if (bus_lock->is_locked() && !bus_lock->is_locked(iss.get_hart_id()))
+			return nullptr;
+
+		uint64_t paddr = addr;
+		if (mmu != nullptr && !mmu->peek_virtual_to_physical_addr(addr, is_store ? STORE : LOAD, paddr))
+			return nullptr;
+
+		for (auto &e : dmi_ranges) {
+			if (e.allows(paddr, is_store) && e.contains(paddr + num_bytes - 1))
+				return e.get_mem_ptr_to_global_addr<uint8_t>(paddr);
+		}
+		return nullptr;
+	}
+
+	/* see comment in data_memory_if_T */
+	void snoop_dmi_store(uint64_t addr, unsigned num_bytes) override {
+		uint64_t paddr = addr;
+		if (mmu != nullptr && !mmu->peek_virtual_to_physical_addr(addr, STORE, paddr))
+			return;
+		bus_lock->snoop_store(paddr, num_bytes);
+	}
 };
 
 #endif /* RISCV_ISA_MEM_H */
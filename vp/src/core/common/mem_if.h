@@ -3,6 +3,14 @@
 
 #include <stdint.h>
 
+/* access counters of a memory interface (see BusStats), loads include instruction fetches */
+struct MemoryAccessStats {
+	uint64_t dmi_loads = 0;
+	uint64_t dmi_stores = 0;
+	uint64_t tlm_loads = 0;
+	uint64_t tlm_stores = 0;
+};
+
 struct instr_memory_if {
 	virtual uint32_t load_instr(uint64_t pc) = 0;
 };
@@ -43,6 +51,13 @@ struct data_memory_if_T {
 	virtual int64_t atomic_load_reserved_double(uint64_t addr) = 0;
 	virtual bool atomic_store_conditional_double(uint64_t addr, uint64_t value) = 0;
 
+	/*
+	 * returns the host address for an atomic memory operation (AMO) on addr, if addr is located in a DMI range (the
+	 * caller can then operate directly on host memory)
+	 * returns nullptr otherwise, i.e. the AMO has to use atomic_load_* / atomic_store_* which lock the bus
+	 */
+	virtual void *atomic_get_dmi_host_addr(uint64_t addr, unsigned num_bytes) = 0;
+
 	/* returns true if the bus is locked */
 	virtual bool is_bus_locked() = 0;
 	/*
@@ -53,6 +68,24 @@ struct data_memory_if_T {
 	 */
 	virtual void *get_last_dmi_page_host_addr() = 0;
 
+	/*
+	 * reads num_bytes at addr without any side effect (no transaction, no page table walk, no trap, no timing), e.g.
+	 * for profiling
+	 * returns false if addr is not located in a DMI range or its translation is not cached in the TLB
+	 */
+	virtual bool peek_data(uint64_t addr, void *dst, unsigned num_bytes) = 0;
+
+	/*
+	 * returns the host address of [addr, addr + num_bytes) (within one page) for a direct access by the ISS (e.g.
+	 * native routines), if it is located in a DMI range and its translation is cached in the TLB, i.e. the access can
+	 * neither trap nor has side effects other than the memory access itself (no transaction, no timing)
+	 * returns nullptr otherwise
+	 * Stores are not snooped, the caller has to call snoop_dmi_store right before it writes to the mapped range.
+	 */
+	virtual void *get_dmi_host_addr(uint64_t addr, unsigned num_bytes, bool is_store) = 0;
+	/* invalidates the LR reservations on a range returned by get_dmi_host_addr (no context switch in between) */
+	virtual void snoop_dmi_store(uint64_t addr, unsigned num_bytes) = 0;
+
 	virtual void flush_tlb() = 0;
 };
 
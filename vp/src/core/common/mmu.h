@@ -5,6 +5,7 @@
 
 #include <systemc>
 
+#include "hpm.h"
 #include "irq_if.h"
 #include "mmu_mem_if.h"
 
@@ -118,6 +119,7 @@ struct MMU_T {
 		if (x.vpn == vpn)
 			return x.ppn | (vaddr & PGMASK);
 
+		core.hpm.count(HPM_EVENT_TLB_MISS);
 		uint64_t paddr = walk(vaddr, type, mode);
 
 		// optimization only, to void page walk
@@ -127,6 +129,25 @@ struct MMU_T {
 		return paddr;
 	}
 
+	/* translation without side effects (see data_memory_if::peek_data), fails on TLB misses */
+	bool peek_virtual_to_physical_addr(uint64_t vaddr, MemoryAccessType type, uint64_t &paddr) {
+		auto mode = core.prv;
+		if (type != FETCH && core.csrs.mstatus.fields.mprv)
+			mode = core.csrs.mstatus.fields.mpp;
+
+		if (core.csrs.satp.fields.mode == SATP_MODE_BARE || mode == MachineMode) {
+			paddr = vaddr;
+			return true;
+		}
+
+		auto vpn = (vaddr >> PGSHIFT);
+		auto &x = tlb[mode][type][vpn % TLB_ENTRIES];
+		if (x.vpn != vpn)
+			return false;
+		paddr = x.ppn | (vaddr & PGMASK);
+		return true;
+	}
+
 	vm_info decode_vm_info(PrivilegeLevel prv) {
 		assert(prv <= SupervisorMode);
 		uint64_t ptbase = (uint64_t)core.csrs.satp.fields.ppn << PGSHIFT;
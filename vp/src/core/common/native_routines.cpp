@@ -0,0 +1,35 @@
+#include "native_routines.h"
+
+#include <iomanip>
+
+static const char *routine_names[NativeRoutines::NUM_ROUTINES] = {"memcpy", "memset", "memmove", "strlen", "memcmp"};
+
+bool NativeRoutines::add(const std::string &name, uint64_t addr) {
+	/* the Linux kernel also provides the (uninstrumented) __mem* variants */
+	std::string base = name.compare(0, 5, "__mem") == 0 ? name.substr(2) : name;
+	for (unsigned r = 0; r < NUM_ROUTINES; ++r) {
+		if (base == routine_names[r]) {
+			entries[addr] = Routine(r);
+			return true;
+		}
+	}
+	return false;
+}
+
+void NativeRoutines::add_spec(const std::string &spec) {
+	auto at = spec.rfind('@');
+	if (at == std::string::npos)
+		throw std::runtime_error("invalid native routine \"" + spec + "\", expected <name>@<addr>");
+	std::string name = spec.substr(0, at);
+	if (!add(name, std::stoull(spec.substr(at + 1), nullptr, 0)))
+		throw std::runtime_error("unknown native routine \"" + name + "\"");
+}
+
+void NativeRoutines::show(std::ostream &os) const {
+	os << "============================================================================================" << std::endl;
+	os << "NativeRoutines: " << entries.size() << " entry points" << std::endl;
+	for (unsigned r = 0; r < NUM_ROUTINES; ++r) {
+		os << std::setw(8) << routine_names[r] << ": " << calls[r] << " calls, " << total_bytes[r] << " bytes, "
+		   << fallbacks[r] << " interpreted" << std::endl;
+	}
+}
@@ -0,0 +1,237 @@
+#ifndef RISCV_ISA_NATIVE_ROUTINES_H
+#define RISCV_ISA_NATIVE_ROUTINES_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Host-native execution of well-known guest library routines (memcpy, memset, memmove, strlen, memcmp)
+ *
+ * Calls (JAL/JALR with link) to a registered entry point are executed on the host instead of being interpreted, the
+ * ISS then continues at the link address, i.e. as if the routine returned (see ISS_CT::call_native_routine). Only the
+ * return value (a0) is written, all other registers keep their values (a valid implementation of the calling
+ * convention). Instructions and cycles are accounted with a simple cost model:
+ *     instructions = cost_base + cost_per_byte * <number of bytes processed>
+ *
+ * Guest memory is accessed through a map function, which returns the host address of a range within one page or
+ * nullptr (see data_memory_if::get_dmi_host_addr, i.e. DMI memory with a cached translation only). All pages of a
+ * routine are mapped before anything is written, hence a routine either runs completely on the host or not at all.
+ * In the latter case (non-DMI/MMIO memory, missing translation, possible fault, watched page) the call falls back to
+ * interpretation. Stores are snooped (see data_memory_if::snoop_dmi_store) only once all pages were mapped, i.e. a
+ * fallback does not break the LR reservations of other harts.
+ *
+ * All methods are called from SystemC context only.
+ */
+class NativeRoutines {
+   public:
+	static constexpr unsigned PAGE_SIZE = 4096;
+	static constexpr uint64_t MAX_BYTES = 64 << 20;  // larger calls are interpreted
+
+	enum Routine { MEMCPY, MEMSET, MEMMOVE, STRLEN, MEMCMP, NUM_ROUTINES };
+
+	unsigned cost_base = 20;
+	double cost_per_byte = 0.25;
+
+	inline bool is_active() const {
+		return !entries.empty();
+	}
+
+	/* entry point at addr, nullptr if none */
+	inline const Routine *find(uint64_t addr) const {
+		auto it = entries.find(addr);
+		return it != entries.end() ? &it->second : nullptr;
+	}
+
+	/* returns false if name is not a known routine */
+	bool add(const std::string &name, uint64_t addr);
+
+	/* entry points of all known routines in the code symbols of an ELF file, relocated by bias */
+	template <typename T_ElfLoader>
+	void add_elf(T_ElfLoader &elf, uint64_t bias = 0) {
+		try {
+			elf.for_each_code_symbol([&](const char *name, uint64_t addr, uint64_t size) { add(name, addr + bias); });
+		} catch (std::runtime_error &e) {
+			std::cerr << "[NativeRoutines] Warning: no symbols available: " << e.what() << std::endl;
+		}
+	}
+
+	/* spec: <name>@<addr> */
+	void add_spec(const std::string &spec);
+
+	/*
+	 * execute routine r with the arguments a0..a2, returns false if the call has to be interpreted, otherwise result
+	 * holds the return value and instructions the cost of the call
+	 */
+	template <typename F_Map, typename F_Snoop>
+	bool call(Routine r, uint64_t a0, uint64_t a1, uint64_t a2, uint64_t &result, uint64_t &instructions, F_Map map,
+	          F_Snoop snoop) {
+		uint64_t bytes = 0;
+		bool ok = false;
+		switch (r) {
+			case MEMCPY:
+			case MEMMOVE:
+				ok = copy(a0, a1, a2, map, snoop);
+				result = a0;
+				bytes = a2;
+				break;
+			case MEMSET:
+				ok = set(a0, a1, a2, map, snoop);
+				result = a0;
+				bytes = a2;
+				break;
+			case STRLEN:
+				ok = length(a0, result, map);
+				bytes = result + 1;
+				break;
+			case MEMCMP:
+				ok = compare(a0, a1, a2, result, bytes, map);
+				break;
+			case NUM_ROUTINES:
+				break;
+		}
+
+		if (!ok) {
+			fallbacks[r]++;
+			return false;
+		}
+		calls[r]++;
+		total_bytes[r] += bytes;
+		instructions = cost_base + uint64_t(cost_per_byte * bytes);
+		return true;
+	}
+
+	void show(std::ostream &os = std::cout) const;
+
+   private:
+	struct Chunk {
+		uint64_t addr;
+		uint8_t *ptr;
+		unsigned size;
+	};
+
+	std::unordered_map<uint64_t, Routine> entries;
+	uint64_t calls[NUM_ROUTINES] = {};
+	uint64_t fallbacks[NUM_ROUTINES] = {};
+	uint64_t total_bytes[NUM_ROUTINES] = {};
+	std::vector<Chunk> src_chunks;
+	std::vector<Chunk> dst_chunks;
+	std::vector<uint8_t> buffer;
+
+	static inline unsigned page_remaining(uint64_t addr, uint64_t n) {
+		uint64_t r = PAGE_SIZE - (addr & (PAGE_SIZE - 1));
+		return r < n ? r : n;
+	}
+
+	/*
+	 * host chunks of [addr, addr + n), false if any page is not mapped
+	 * map(addr, num_bytes, is_store) -> uint8_t * or nullptr, the range never crosses a page boundary
+	 */
+	template <typename F_Map>
+	static bool map_range(uint64_t addr, uint64_t n, bool is_store, std::vector<Chunk> &chunks, F_Map &map) {
+		chunks.clear();
+		while (n > 0) {
+			unsigned size = page_remaining(addr, n);
+			uint8_t *p = map(addr, size, is_store);
+			if (p == nullptr)
+				return false;
+			chunks.push_back({addr, p, size});
+			addr += size;
+			n -= size;
+		}
+		return true;
+	}
+
+	/* snoop(addr, num_bytes) for all chunks of a mapped store range, right before it is written */
+	template <typename F_Snoop>
+	static void snoop_range(const std::vector<Chunk> &chunks, F_Snoop &snoop) {
+		for (auto &c : chunks) snoop(c.addr, c.size);
+	}
+
+	template <typename F_Map, typename F_Snoop>
+	bool copy(uint64_t dst, uint64_t src, uint64_t n, F_Map &map, F_Snoop &snoop) {
+		if (n > MAX_BYTES)
+			return false;
+		if (!map_range(src, n, false, src_chunks, map) || !map_range(dst, n, true, dst_chunks, map))
+			return false;
+		if (n == 0)
+			return true;
+		snoop_range(dst_chunks, snoop);
+
+		if (src_chunks.size() == 1 && dst_chunks.size() == 1) {
+			memmove(dst_chunks[0].ptr, src_chunks[0].ptr, n);
+			return true;
+		}
+
+		/* gather and scatter, handles overlapping ranges */
+		buffer.resize(n);
+		uint8_t *b = buffer.data();
+		for (auto &c : src_chunks) {
+			memcpy(b, c.ptr, c.size);
+			b += c.size;
+		}
+		b = buffer.data();
+		for (auto &c : dst_chunks) {
+			memcpy(c.ptr, b, c.size);
+			b += c.size;
+		}
+		return true;
+	}
+
+	template <typename F_Map, typename F_Snoop>
+	bool set(uint64_t dst, uint64_t value, uint64_t n, F_Map &map, F_Snoop &snoop) {
+		if (n > MAX_BYTES || !map_range(dst, n, true, dst_chunks, map))
+			return false;
+		snoop_range(dst_chunks, snoop);
+		for (auto &c : dst_chunks) memset(c.ptr, int(value & 0xff), c.size);
+		return true;
+	}
+
+	template <typename F_Map>
+	static bool length(uint64_t s, uint64_t &result, F_Map &map) {
+		result = 0;
+		while (result <= MAX_BYTES) {
+			unsigned size = page_remaining(s + result, PAGE_SIZE);
+			uint8_t *p = map(s + result, size, false);
+			if (p == nullptr)
+				return false;
+			auto end = (uint8_t *)memchr(p, 0, size);
+			if (end != nullptr) {
+				result += end - p;
+				return true;
+			}
+			result += size;
+		}
+		return false;
+	}
+
+	template <typename F_Map>
+	static bool compare(uint64_t a, uint64_t b, uint64_t n, uint64_t &result, uint64_t &bytes, F_Map &map) {
+		result = 0;
+		bytes = 0;
+		while (bytes < n) {
+			unsigned size = page_remaining(a + bytes, page_remaining(b + bytes, n - bytes));
+			uint8_t *pa = map(a + bytes, size, false);
+			uint8_t *pb = map(b + bytes, size, false);
+			if (pa == nullptr || pb == nullptr)
+				return false;
+			if (memcmp(pa, pb, size) != 0) {
+				unsigned i = 0;
+				while (pa[i] == pb[i]) ++i;
+				/* difference of the first differing bytes (as unsigned char), sign extended */
+				result = int64_t(pa[i]) - int64_t(pb[i]);
+				bytes += i + 1;
+				return true;
+			}
+			bytes += size;
+		}
+		return true;
+	}
+};
+
+#endif  // RISCV_ISA_NATIVE_ROUTINES_H
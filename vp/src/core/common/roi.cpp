@@ -0,0 +1,64 @@
+#include "roi.h"
+
+#include <iomanip>
+#include <iostream>
+
+void RegionOfInterest::fast_forward() {
+	tlm::tlm_global_quantum::instance().set(sc_core::sc_time(FAST_FORWARD_QUANTUM_NS, sc_core::SC_NS));
+	switch_mode(false);
+}
+
+void RegionOfInterest::switch_mode(bool detailed) {
+	for (auto &f : on_switch) f(detailed);
+}
+
+void RegionOfInterest::marker(unsigned hart, int32_t id) {
+	if (id == MARKER_BEGIN) {
+		if (!active && !done)
+			begin(hart);
+	} else if (id == MARKER_END) {
+		if (active)
+			end(hart);
+		else if (!done)
+			std::cerr << "[ROI] Warning: end marker on hart " << hart << " before the begin marker, ignored"
+			          << std::endl;
+	}
+}
+
+void RegionOfInterest::begin(unsigned hart) {
+	active = true;
+
+	tlm::tlm_global_quantum::instance().set(quantum);
+	switch_mode(true);
+
+	begin_time = sc_core::sc_time_stamp();
+	begin_host_time = std::chrono::steady_clock::now();
+	begin_instret.clear();
+	for (auto &f : instret) begin_instret.push_back(f());
+
+	std::cout << "[ROI] begin on hart " << hart << " at " << begin_time << std::endl;
+}
+
+void RegionOfInterest::end(unsigned hart) {
+	active = false;
+	done = true;
+
+	sc_core::sc_time time = sc_core::sc_time_stamp() - begin_time;
+	double host_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_host_time).count();
+	uint64_t total = 0;
+
+	std::cout << "[ROI] end on hart " << hart << " at " << sc_core::sc_time_stamp() << std::endl;
+	for (unsigned i = 0; i < instret.size(); ++i) {
+		uint64_t n = instret[i]() - begin_instret[i];
+		std::cout << "[ROI] core " << i << " instructions: " << n << std::endl;
+		total += n;
+	}
+	std::cout << "[ROI] instructions: " << total << std::endl;
+	std::cout << "[ROI] simulated time: " << time << std::endl;
+	std::cout << "[ROI] host time: " << std::fixed << std::setprecision(3) << host_time << " s" << std::endl;
+	if (host_time > 0)
+		std::cout << "[ROI] MIPS: " << std::setprecision(2) << total / host_time / 1e6 << std::endl;
+	std::cout << std::defaultfloat;
+
+	for (auto &f : on_end) f();
+}
@@ -0,0 +1,80 @@
+#ifndef RISCV_ISA_ROI_H
+#define RISCV_ISA_ROI_H
+
+#include <stdint.h>
+
+#include <chrono>
+#include <functional>
+#include <systemc>
+#include <tlm>
+#include <vector>
+
+/*
+ * Region of interest (ROI) fast-forward
+ *
+ * The simulation runs with maximal speed settings up to the begin marker of the guest, simulates the region of
+ * interest with the configured (detailed) settings and stops at the end marker:
+ *  - fast-forward: FAST_FORWARD_QUANTUM, LSCache (and data DMI) enabled, no instruction tracing, no debug bus
+ *  - region of interest: configured quantum, LSCache, data DMI, instruction tracing and debug bus
+ * The DBBCache is used in both modes (see Options), it does not change the timing.
+ *
+ * Markers are NOPs with rd = rs1 = zero (decoded as Opcode::MARKER), the immediate selects the marker:
+ *     slti zero, zero, 1  # begin of the region of interest
+ *     slti zero, zero, 2  # end of the region of interest, dump statistics and exit
+ * Markers have no effect if no region of interest is configured, i.e. the ISS has no RegionOfInterest.
+ *
+ * All methods are called from SystemC context only.
+ */
+class RegionOfInterest {
+   public:
+	static constexpr int32_t MARKER_BEGIN = 1;
+	static constexpr int32_t MARKER_END = 2;
+	static constexpr unsigned FAST_FORWARD_QUANTUM_NS = 10000000;  // 10 ms
+
+	/* quantum: the configured global quantum, used inside of the region of interest */
+	RegionOfInterest(sc_core::sc_time quantum) : quantum(quantum) {}
+
+	template <typename T_ISS, typename T_MemIf>
+	void add_core(T_ISS &core, T_MemIf &memif, bool trace, bool use_lscache, bool use_data_dmi) {
+		core.roi = this;
+		instret.push_back([&core]() { return core.get_executed_instructions(); });
+		on_switch.push_back([&core, &memif, trace, use_lscache, use_data_dmi](bool detailed) {
+			core.enable_trace(detailed && trace);
+			core.lscache.set_enabled(!detailed || use_lscache);
+			if (detailed && !use_data_dmi)
+				memif.dmi_ranges.clear();
+			core.update_quantum();
+		});
+		on_end.push_back([&core]() { core.sys_exit(); });
+	}
+
+	template <typename T_Bus>
+	void add_bus(T_Bus &bus) {
+		auto debug_bus = bus.debug_bus;
+		on_switch.push_back([&bus, debug_bus](bool detailed) { bus.debug_bus = detailed ? debug_bus : nullptr; });
+	}
+
+	/* switch to the fast-forward settings, call after all cores and buses were added */
+	void fast_forward();
+
+	/* called by the ISS on Opcode::MARKER */
+	void marker(unsigned hart, int32_t id);
+
+   private:
+	sc_core::sc_time quantum;
+	std::vector<std::function<void(bool detailed)>> on_switch;
+	std::vector<std::function<void()>> on_end;
+	std::vector<std::function<uint64_t()>> instret;
+
+	bool active = false;
+	bool done = false;
+	sc_core::sc_time begin_time;
+	std::chrono::steady_clock::time_point begin_host_time;
+	std::vector<uint64_t> begin_instret;
+
+	void switch_mode(bool detailed);
+	void begin(unsigned hart);
+	void end(unsigned hart);
+};
+
+#endif  // RISCV_ISA_ROI_H
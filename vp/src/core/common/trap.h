@@ -14,6 +14,8 @@ enum ExceptionCode {
 	EXC_S_EXTERNAL_INTERRUPT = 9,
 	EXC_M_EXTERNAL_INTERRUPT = 11,
 
+	EXC_LCOF_INTERRUPT = 13,  // Sscofpmf local counter overflow
+
 	// non-interrupt exception codes (mcause)
 	EXC_INSTR_ADDR_MISALIGNED = 0,
 	EXC_INSTR_ACCESS_FAULT = 1,
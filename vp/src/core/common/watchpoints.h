@@ -0,0 +1,77 @@
+#ifndef RISCV_ISA_WATCHPOINTS_H
+#define RISCV_ISA_WATCHPOINTS_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "debug.h"
+
+/*
+ * Data watchpoints of a hart (GDB Z2/Z3/Z4), matched against virtual addresses
+ *
+ * Watchpoints are checked with page granularity first: CombinedMemoryInterface_T does not report DMI for accesses to
+ * watched pages, hence these pages are never added to the LSCache and every access to them takes the memory interface
+ * path, where it is matched against the watchpoints. The LSCache has to be invalidated whenever a watchpoint is
+ * inserted. Accesses to all other pages keep running at full speed.
+ */
+class Watchpoints {
+   public:
+	static constexpr unsigned PAGE_SHIFT = 12;
+
+	struct Watchpoint {
+		uint64_t addr;
+		uint64_t len;
+		WatchpointType type;
+	};
+
+	inline bool is_active() const {
+		return !watchpoints.empty();
+	}
+
+	/* true, if any page touched by [addr, addr + size) is watched */
+	inline bool is_watched(uint64_t addr, unsigned size) const {
+		return pages.count(addr >> PAGE_SHIFT) || pages.count((addr + size - 1) >> PAGE_SHIFT);
+	}
+
+	void insert(uint64_t addr, uint64_t len, WatchpointType type) {
+		if (len == 0)
+			len = 1;
+		watchpoints.push_back({addr, len, type});
+		for (uint64_t p = addr >> PAGE_SHIFT; p <= (addr + len - 1) >> PAGE_SHIFT; ++p) pages[p]++;
+	}
+
+	bool remove(uint64_t addr, uint64_t len, WatchpointType type) {
+		if (len == 0)
+			len = 1;
+		auto it = std::find_if(watchpoints.begin(), watchpoints.end(), [&](const Watchpoint &w) {
+			return w.addr == addr && w.len == len && w.type == type;
+		});
+		if (it == watchpoints.end())
+			return false;
+		watchpoints.erase(it);
+		for (uint64_t p = addr >> PAGE_SHIFT; p <= (addr + len - 1) >> PAGE_SHIFT; ++p) {
+			if (--pages[p] == 0)
+				pages.erase(p);
+		}
+		return true;
+	}
+
+	/* first watchpoint overlapping [addr, addr + size) which triggers on the access, nullptr if none */
+	const Watchpoint *match(uint64_t addr, unsigned size, bool is_store) const {
+		unsigned access = is_store ? WATCHPOINT_WRITE : WATCHPOINT_READ;
+		for (auto &w : watchpoints) {
+			if ((w.type & access) && addr < w.addr + w.len && w.addr < addr + size)
+				return &w;
+		}
+		return nullptr;
+	}
+
+   private:
+	std::vector<Watchpoint> watchpoints;
+	std::unordered_map<uint64_t, unsigned> pages;  // page number -> number of watchpoints
+};
+
+#endif  // RISCV_ISA_WATCHPOINTS_H
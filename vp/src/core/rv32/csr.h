@@ -145,7 +145,9 @@ struct csr_mie {
 			unsigned wpri3 : 1;
 			unsigned meie : 1;
 
-			unsigned wpri4 : 20;
+			unsigned wpri4 : 1;
+			unsigned lcofie : 1;
+			unsigned wpri5 : 18;
 		} fields;
 	};
 };
@@ -169,7 +171,9 @@ struct csr_mip {
 			unsigned wiri3 : 1;
 			unsigned meip : 1;
 
-			unsigned wiri4 : 20;
+			unsigned wiri4 : 1;
+			unsigned lcofip : 1;
+			unsigned wiri5 : 18;
 		} fields;
 	};
 };
@@ -197,7 +201,7 @@ struct csr_mcounteren {
 			unsigned CY : 1;
 			unsigned TM : 1;
 			unsigned IR : 1;
-			unsigned reserved : 29;
+			unsigned HPM : 29;
 		} fields;
 	};
 };
@@ -209,7 +213,7 @@ struct csr_mcountinhibit {
 			unsigned CY : 1;
 			unsigned zero : 1;
 			unsigned IR : 1;
-			unsigned reserved : 29;
+			unsigned HPM : 29;
 		} fields;
 	};
 };
@@ -347,13 +351,13 @@ inline bool is_bitset(T &csr, unsigned bitpos) {
 	return csr.reg & (1 << bitpos);
 }
 
-constexpr uint32_t MIE_MASK = 0b101110111011;
-constexpr uint32_t SIE_MASK = 0b001100110011;
+constexpr uint32_t MIE_MASK = 0b10101110111011;
+constexpr uint32_t SIE_MASK = 0b10001100110011;
 constexpr uint32_t UIE_MASK = 0b000100010001;
 
-constexpr uint32_t MIP_WRITE_MASK = 0b001100110011;
+constexpr uint32_t MIP_WRITE_MASK = 0b10001100110011;
 constexpr uint32_t MIP_READ_MASK = MIE_MASK;
-constexpr uint32_t SIP_MASK = 0b11;
+constexpr uint32_t SIP_MASK = 0b10000000000011;
 constexpr uint32_t UIP_MASK = 0b1;
 
 constexpr uint32_t MEDELEG_MASK = 0b1011101111111111;
@@ -361,8 +365,8 @@ constexpr uint32_t MIDELEG_MASK = MIE_MASK;
 
 constexpr uint32_t MTVEC_MASK = ~2;
 
-constexpr uint32_t MCOUNTEREN_MASK = 0b111;
-constexpr uint32_t MCOUNTINHIBIT_MASK = 0b101;
+constexpr uint32_t MCOUNTEREN_MASK = 0xffffffff;
+constexpr uint32_t MCOUNTINHIBIT_MASK = 0xfffffffd;
 
 constexpr uint32_t SEDELEG_MASK = 0b1011000111111111;
 constexpr uint32_t SIDELEG_MASK = MIDELEG_MASK;
@@ -630,6 +634,40 @@ constexpr unsigned MHPMEVENT29_ADDR = 0x33D;
 constexpr unsigned MHPMEVENT30_ADDR = 0x33E;
 constexpr unsigned MHPMEVENT31_ADDR = 0x33F;
 
+// Sscofpmf, upper halves of mhpmevent (RV32 only)
+constexpr unsigned MHPMEVENT3H_ADDR = 0x723;
+constexpr unsigned MHPMEVENT4H_ADDR = 0x724;
+constexpr unsigned MHPMEVENT5H_ADDR = 0x725;
+constexpr unsigned MHPMEVENT6H_ADDR = 0x726;
+constexpr unsigned MHPMEVENT7H_ADDR = 0x727;
+constexpr unsigned MHPMEVENT8H_ADDR = 0x728;
+constexpr unsigned MHPMEVENT9H_ADDR = 0x729;
+constexpr unsigned MHPMEVENT10H_ADDR = 0x72A;
+constexpr unsigned MHPMEVENT11H_ADDR = 0x72B;
+constexpr unsigned MHPMEVENT12H_ADDR = 0x72C;
+constexpr unsigned MHPMEVENT13H_ADDR = 0x72D;
+constexpr unsigned MHPMEVENT14H_ADDR = 0x72E;
+constexpr unsigned MHPMEVENT15H_ADDR = 0x72F;
+constexpr unsigned MHPMEVENT16H_ADDR = 0x730;
+constexpr unsigned MHPMEVENT17H_ADDR = 0x731;
+constexpr unsigned MHPMEVENT18H_ADDR = 0x732;
+constexpr unsigned MHPMEVENT19H_ADDR = 0x733;
+constexpr unsigned MHPMEVENT20H_ADDR = 0x734;
+constexpr unsigned MHPMEVENT21H_ADDR = 0x735;
+constexpr unsigned MHPMEVENT22H_ADDR = 0x736;
+constexpr unsigned MHPMEVENT23H_ADDR = 0x737;
+constexpr unsigned MHPMEVENT24H_ADDR = 0x738;
+constexpr unsigned MHPMEVENT25H_ADDR = 0x739;
+constexpr unsigned MHPMEVENT26H_ADDR = 0x73A;
+constexpr unsigned MHPMEVENT27H_ADDR = 0x73B;
+constexpr unsigned MHPMEVENT28H_ADDR = 0x73C;
+constexpr unsigned MHPMEVENT29H_ADDR = 0x73D;
+constexpr unsigned MHPMEVENT30H_ADDR = 0x73E;
+constexpr unsigned MHPMEVENT31H_ADDR = 0x73F;
+
+// Sscofpmf
+constexpr unsigned SCOUNTOVF_ADDR = 0xDA0;
+
 // vector CSRs
 constexpr unsigned VSTART_ADDR = 0x008;
 constexpr unsigned VXSAT_ADDR = 0x009;
@@ -929,6 +967,35 @@ struct csr_table {
 	case MHPMEVENT28_ADDR:                    \
 	case MHPMEVENT29_ADDR:                    \
 	case MHPMEVENT30_ADDR:                    \
-	case MHPMEVENT31_ADDR
+	case MHPMEVENT31_ADDR:                    \
+	case MHPMEVENT3H_ADDR:                    \
+	case MHPMEVENT4H_ADDR:                    \
+	case MHPMEVENT5H_ADDR:                    \
+	case MHPMEVENT6H_ADDR:                    \
+	case MHPMEVENT7H_ADDR:                    \
+	case MHPMEVENT8H_ADDR:                    \
+	case MHPMEVENT9H_ADDR:                    \
+	case MHPMEVENT10H_ADDR:                   \
+	case MHPMEVENT11H_ADDR:                   \
+	case MHPMEVENT12H_ADDR:                   \
+	case MHPMEVENT13H_ADDR:                   \
+	case MHPMEVENT14H_ADDR:                   \
+	case MHPMEVENT15H_ADDR:                   \
+	case MHPMEVENT16H_ADDR:                   \
+	case MHPMEVENT17H_ADDR:                   \
+	case MHPMEVENT18H_ADDR:                   \
+	case MHPMEVENT19H_ADDR:                   \
+	case MHPMEVENT20H_ADDR:                   \
+	case MHPMEVENT21H_ADDR:                   \
+	case MHPMEVENT22H_ADDR:                   \
+	case MHPMEVENT23H_ADDR:                   \
+	case MHPMEVENT24H_ADDR:                   \
+	case MHPMEVENT25H_ADDR:                   \
+	case MHPMEVENT26H_ADDR:                   \
+	case MHPMEVENT27H_ADDR:                   \
+	case MHPMEVENT28H_ADDR:                   \
+	case MHPMEVENT29H_ADDR:                   \
+	case MHPMEVENT30H_ADDR:                   \
+	case MHPMEVENT31H_ADDR
 
 }  // namespace rv32
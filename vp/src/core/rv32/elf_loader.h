@@ -73,6 +73,7 @@ struct Elf32Types {
 	typedef Elf32_Shdr Elf_Shdr;
 	typedef Elf32_Sym Elf_Sym;
 	static constexpr unsigned PT_LOAD = Elf32_PhdrType::PT_LOAD;
+	static constexpr unsigned PT_PHDR = Elf32_PhdrType::PT_PHDR;
 };
 
 typedef GenericElfLoader<Elf32Types> ELFLoader;
@@ -29,6 +29,8 @@ ISS_CT::ISS_CT(RV_ISA_Config *isa_config, uxlen_t hart_id)
 	csrs.mhartid.reg = hart_id;
 	csrs.misa.fields.extensions = isa_config->get_misa_extensions();
 
+	IdleDetector::instance().register_hart();
+
 	sc_core::sc_time qt = tlm::tlm_global_quantum::instance().get();
 	cycle_time = sc_core::sc_time(10, sc_core::SC_NS);
 
@@ -260,7 +262,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 	 * Check quantum in fast path roughly every tenth of a quantum (heuristic)
 	 * Uncertainties: time is also increasing outside of ISS; not every instruction has cycle_time
 	 */
-	const unsigned long fast_quantum_ins_granularity =
+	unsigned long fast_quantum_ins_granularity =
 	    quantum_keeper.get_global_quantum().value() / cycle_time.value() / 10;
 	unsigned long ninstr = 0;
 
@@ -270,18 +272,33 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 	/* start in slow_path */
 	force_slow_path();
 
+	host_time.set_section(HostProfiler::instance().get_process_section());
+	host_time.start();
+
 	do {
 		try {
 			/* global (slow and med) operation fetch, decode and dispatch (FDD) */
 			OP_GLOBAL_FDD() {
 				pc = dbbcache.get_pc_maybe_after_callback();
 
+				/* instructions at breakpoints are never executed in fast path (see DBBCache set_breakpoints) */
+				if (unlikely(debug_mode) && breakpoints.find(pc) != breakpoints.end()) {
+					force_slow_path();
+				}
+
 				if (unlikely(iss_slow_path)) {
 					iss_slow_path = false;
 
 					/* update counters by local fast counters */
 					commit_instructions(ninstr);
 					commit_cycles();
+					maybe_sample_profile();
+
+					if (unlikely(quantum_changed)) {
+						quantum_changed = false;
+						fast_quantum_ins_granularity =
+						    quantum_keeper.get_global_quantum().value() / cycle_time.value() / 10;
+					}
 
 					/* call interrupt handling */
 					handle_interrupt();
@@ -313,19 +330,26 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 						stats.inc_qk_need_sync();
 						if (quantum_keeper.need_sync()) {
 							stats.inc_qk_sync();
+							host_time.stop();
 							quantum_keeper.sync();
+							host_time.start();
 						}
 					}
 
 					/* speeds up the execution performance (non debug mode) significantly by */
 					/* checking the additional flag first */
 					if (debug_mode) {
-						/* always stay in slow path if debug enabled */
-						force_slow_path();
+						if (breakpoints_changed) {
+							breakpoints_changed = false;
+							dbbcache.set_breakpoints(breakpoints, pc);
+						}
 
-						/* stop after single step */
-						if (debug_single_step && debug_single_step_done) {
-							break;
+						if (debug_single_step) {
+							/* stop after single step */
+							if (debug_single_step_done) {
+								break;
+							}
+							force_slow_path();
 						}
 
 						/* stop on breakpoint */
@@ -346,13 +370,16 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 					// iss_slow_path = true;
 					commit_instructions(ninstr);
 					commit_cycles();
+					maybe_sample_profile();
 					stats.inc_qk_need_sync();
 					if (quantum_keeper.need_sync()) {
 						// TODO: must also be done for transactions (keeper in common/mem.h) ?!
 						/* sync pc member variable before potential SysC context switch */
 						// pc = dbbcache.get_pc_maybe_after_callback();
 						stats.inc_qk_sync();
+						host_time.stop();
 						quantum_keeper.sync();
+						host_time.start();
 					}
 				}
 
@@ -381,6 +408,16 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				}
 				OP_END();
 
+				OP_CASE(MARKER) {
+					if (roi != nullptr) {
+						commit_instructions(ninstr);
+						commit_cycles();
+						roi->marker(get_hart_id(), instr.I_imm());
+						force_slow_path();
+					}
+				}
+				OP_END();
+
 				/*
 				 * RV64 instructions not supported on RV32
 				 */
@@ -607,7 +644,14 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 
 				OP_CASE(JAL) {
 					stats.inc_jal();
-					regs[instr.rd()] = dbbcache.jump_and_link(instr.J_imm());
+					if (unlikely(native_routines != nullptr)) {
+						uxlen_t target = dbbcache.get_last_pc_before_callback() + instr.J_imm();
+						regs[instr.rd()] = dbbcache.jump_and_link(instr.J_imm());
+						if (call_native_routine(target, ninstr))
+							dbbcache.jump_dyn(regs[instr.rd()]);
+					} else {
+						regs[instr.rd()] = dbbcache.jump_and_link(instr.J_imm());
+					}
 					if (unlikely(ninstr > fast_quantum_ins_granularity)) {
 						ninstr++;
 						goto OP_LABEL(op_global_fdd);
@@ -644,6 +688,8 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 					}
 
 					regs[instr.rd()] = dbbcache.jump_dyn_and_link(pc);
+					if (unlikely(native_routines != nullptr) && call_native_routine(pc, ninstr))
+						dbbcache.jump_dyn(regs[instr.rd()]);
 					if (unlikely(ninstr > fast_quantum_ins_granularity)) {
 						ninstr++;
 						goto OP_LABEL(op_global_fdd);
@@ -716,6 +762,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 
 				OP_CASE(BEQ) {
 					if (regs[instr.rs1()] == regs[instr.rs2()]) {
+						hpm.count(HPM_EVENT_BRANCH_TAKEN);
 						dbbcache.branch_taken(instr.B_imm());
 						if (unlikely(ninstr > fast_quantum_ins_granularity)) {
 							ninstr++;
@@ -729,6 +776,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 
 				OP_CASE(BNE) {
 					if (regs[instr.rs1()] != regs[instr.rs2()]) {
+						hpm.count(HPM_EVENT_BRANCH_TAKEN);
 						dbbcache.branch_taken(instr.B_imm());
 						if (unlikely(ninstr > fast_quantum_ins_granularity)) {
 							ninstr++;
@@ -742,6 +790,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 
 				OP_CASE(BLT) {
 					if (regs[instr.rs1()] < regs[instr.rs2()]) {
+						hpm.count(HPM_EVENT_BRANCH_TAKEN);
 						dbbcache.branch_taken(instr.B_imm());
 						if (unlikely(ninstr > fast_quantum_ins_granularity)) {
 							ninstr++;
@@ -755,6 +804,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 
 				OP_CASE(BGE) {
 					if (regs[instr.rs1()] >= regs[instr.rs2()]) {
+						hpm.count(HPM_EVENT_BRANCH_TAKEN);
 						dbbcache.branch_taken(instr.B_imm());
 						if (unlikely(ninstr > fast_quantum_ins_granularity)) {
 							ninstr++;
@@ -768,6 +818,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 
 				OP_CASE(BLTU) {
 					if ((uxlen_t)regs[instr.rs1()] < (uxlen_t)regs[instr.rs2()]) {
+						hpm.count(HPM_EVENT_BRANCH_TAKEN);
 						dbbcache.branch_taken(instr.B_imm());
 						if (unlikely(ninstr > fast_quantum_ins_granularity)) {
 							ninstr++;
@@ -781,6 +832,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 
 				OP_CASE(BGEU) {
 					if ((uxlen_t)regs[instr.rs1()] >= (uxlen_t)regs[instr.rs2()]) {
+						hpm.count(HPM_EVENT_BRANCH_TAKEN);
 						dbbcache.branch_taken(instr.B_imm());
 						if (unlikely(ninstr > fast_quantum_ins_granularity)) {
 							ninstr++;
@@ -1027,10 +1079,12 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				 */
 				OP_CASE(LR_W) {
 					stats.inc_loadstore();
+					hpm.count(HPM_EVENT_AMO);
 					uxlen_t addr = regs[instr.rs1()];
 					trap_check_addr_alignment<4, true>(addr);
 					regs[instr.rd()] = mem->atomic_load_reserved_word(addr);
-					if (lr_sc_counter == 0) {
+					// NOTE: LR on DMI memory uses a snooped reservation and does not lock the bus (see mem.h)
+					if (lr_sc_counter == 0 && mem->is_bus_locked()) {
 						lr_sc_counter = 17;  // this instruction + 16 additional ones, (an over-approximation) to cover
 						                     // the RISC-V forward progress property
 						force_slow_path();
@@ -1041,6 +1095,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 
 				OP_CASE(SC_W) {
 					stats.inc_loadstore();
+					hpm.count(HPM_EVENT_AMO);
 					uxlen_t addr = regs[instr.rs1()];
 					trap_check_addr_alignment<4, false>(addr);
 					uint32_t val = regs[instr.rs2()];
@@ -1390,7 +1445,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FADD_S) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f32_add(fp_regs.f32(RS1), fp_regs.f32(RS2)));
+					float32_t a = fp_regs.f32(RS1), b = fp_regs.f32(RS2), res;
+					if (!hostfp::add(a, b, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f32_add(a, b);
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1398,7 +1456,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FSUB_S) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f32_sub(fp_regs.f32(RS1), fp_regs.f32(RS2)));
+					float32_t a = fp_regs.f32(RS1), b = fp_regs.f32(RS2), res;
+					if (!hostfp::sub(a, b, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f32_sub(a, b);
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1406,7 +1467,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FMUL_S) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f32_mul(fp_regs.f32(RS1), fp_regs.f32(RS2)));
+					float32_t a = fp_regs.f32(RS1), b = fp_regs.f32(RS2), res;
+					if (!hostfp::mul(a, b, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f32_mul(a, b);
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1414,7 +1478,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FDIV_S) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f32_div(fp_regs.f32(RS1), fp_regs.f32(RS2)));
+					float32_t a = fp_regs.f32(RS1), b = fp_regs.f32(RS2), res;
+					if (!hostfp::div(a, b, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f32_div(a, b);
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1422,7 +1489,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FSQRT_S) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f32_sqrt(fp_regs.f32(RS1)));
+					float32_t a = fp_regs.f32(RS1), res;
+					if (!hostfp::sqrt(a, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f32_sqrt(a);
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1468,7 +1538,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FMADD_S) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f32_mulAdd(fp_regs.f32(RS1), fp_regs.f32(RS2), fp_regs.f32(RS3)));
+					float32_t a = fp_regs.f32(RS1), b = fp_regs.f32(RS2), c = fp_regs.f32(RS3), res;
+					if (!hostfp::madd(a, b, c, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f32_mulAdd(a, b, c);
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1476,7 +1549,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FMSUB_S) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f32_mulAdd(fp_regs.f32(RS1), fp_regs.f32(RS2), f32_neg(fp_regs.f32(RS3))));
+					float32_t a = fp_regs.f32(RS1), b = fp_regs.f32(RS2), c = fp_regs.f32(RS3), res;
+					if (!hostfp::msub(a, b, c, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f32_mulAdd(a, b, f32_neg(c));
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1484,8 +1560,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FNMADD_S) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD,
-					              f32_mulAdd(f32_neg(fp_regs.f32(RS1)), fp_regs.f32(RS2), f32_neg(fp_regs.f32(RS3))));
+					float32_t a = fp_regs.f32(RS1), b = fp_regs.f32(RS2), c = fp_regs.f32(RS3), res;
+					if (!hostfp::nmadd(a, b, c, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f32_mulAdd(f32_neg(a), b, f32_neg(c));
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1493,7 +1571,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FNMSUB_S) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f32_mulAdd(f32_neg(fp_regs.f32(RS1)), fp_regs.f32(RS2), fp_regs.f32(RS3)));
+					float32_t a = fp_regs.f32(RS1), b = fp_regs.f32(RS2), c = fp_regs.f32(RS3), res;
+					if (!hostfp::nmsub(a, b, c, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f32_mulAdd(f32_neg(a), b, c);
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1625,7 +1706,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FADD_D) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f64_add(fp_regs.f64(RS1), fp_regs.f64(RS2)));
+					float64_t a = fp_regs.f64(RS1), b = fp_regs.f64(RS2), res;
+					if (!hostfp::add(a, b, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f64_add(a, b);
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1633,7 +1717,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FSUB_D) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f64_sub(fp_regs.f64(RS1), fp_regs.f64(RS2)));
+					float64_t a = fp_regs.f64(RS1), b = fp_regs.f64(RS2), res;
+					if (!hostfp::sub(a, b, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f64_sub(a, b);
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1641,7 +1728,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FMUL_D) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f64_mul(fp_regs.f64(RS1), fp_regs.f64(RS2)));
+					float64_t a = fp_regs.f64(RS1), b = fp_regs.f64(RS2), res;
+					if (!hostfp::mul(a, b, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f64_mul(a, b);
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1649,7 +1739,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FDIV_D) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f64_div(fp_regs.f64(RS1), fp_regs.f64(RS2)));
+					float64_t a = fp_regs.f64(RS1), b = fp_regs.f64(RS2), res;
+					if (!hostfp::div(a, b, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f64_div(a, b);
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1657,7 +1750,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FSQRT_D) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f64_sqrt(fp_regs.f64(RS1)));
+					float64_t a = fp_regs.f64(RS1), res;
+					if (!hostfp::sqrt(a, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f64_sqrt(a);
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1703,7 +1799,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FMADD_D) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f64_mulAdd(fp_regs.f64(RS1), fp_regs.f64(RS2), fp_regs.f64(RS3)));
+					float64_t a = fp_regs.f64(RS1), b = fp_regs.f64(RS2), c = fp_regs.f64(RS3), res;
+					if (!hostfp::madd(a, b, c, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f64_mulAdd(a, b, c);
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1711,7 +1810,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FMSUB_D) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f64_mulAdd(fp_regs.f64(RS1), fp_regs.f64(RS2), f64_neg(fp_regs.f64(RS3))));
+					float64_t a = fp_regs.f64(RS1), b = fp_regs.f64(RS2), c = fp_regs.f64(RS3), res;
+					if (!hostfp::msub(a, b, c, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f64_mulAdd(a, b, f64_neg(c));
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1719,8 +1821,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FNMADD_D) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD,
-					              f64_mulAdd(f64_neg(fp_regs.f64(RS1)), fp_regs.f64(RS2), f64_neg(fp_regs.f64(RS3))));
+					float64_t a = fp_regs.f64(RS1), b = fp_regs.f64(RS2), c = fp_regs.f64(RS3), res;
+					if (!hostfp::nmadd(a, b, c, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f64_mulAdd(f64_neg(a), b, f64_neg(c));
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -1728,7 +1832,10 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 				OP_CASE(FNMSUB_D) {
 					fp_prepare_instr();
 					fp_setup_rm();
-					fp_regs.write(RD, f64_mulAdd(f64_neg(fp_regs.f64(RS1)), fp_regs.f64(RS2), fp_regs.f64(RS3)));
+					float64_t a = fp_regs.f64(RS1), b = fp_regs.f64(RS2), c = fp_regs.f64(RS3), res;
+					if (!hostfp::nmsub(a, b, c, softfloat_roundingMode, res, softfloat_exceptionFlags))
+						res = f64_mulAdd(f64_neg(a), b, c);
+					fp_regs.write(RD, res);
 					fp_finish_instr();
 				}
 				OP_END();
@@ -6557,9 +6664,14 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 						RAISE_ILLEGAL_INSTRUCTION();
 
 					if (!ignore_wfi) {
+						IdleDetector &idle = IdleDetector::instance();
+						idle.enter_wfi();
 						while (!has_local_pending_enabled_interrupts()) {
+							host_time.stop();
 							sc_core::wait(wfi_event);
+							host_time.start();
 						}
+						idle.leave_wfi();
 					}
 				}
 				OP_END();
@@ -6630,6 +6742,7 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
 
 	/* sync quantum: make sure that no action is missed */
 	stats.inc_qk_sync();
+	host_time.stop();
 	quantum_keeper.sync();
 }
 /*
@@ -6638,6 +6751,40 @@ void ISS_CT::exec_steps(const bool debug_single_step) {
  */
 #pragma GCC diagnostic pop
 
+void ISS_CT::sample_profile() {
+	uint64_t stack[GuestProfiler::MAX_DEPTH];
+	unsigned depth = 0;
+	stack[depth++] = pc;
+
+	/* frame pointer chain: the return address is stored at fp - 1 word, the caller's fp at fp - 2 words */
+	uxlen_t fp = regs[RegFile::fp];
+	while (depth < GuestProfiler::MAX_DEPTH && fp != 0 && fp % sizeof(uxlen_t) == 0) {
+		uxlen_t frame[2];  // caller's fp, return address
+		if (!mem->peek_data(fp - sizeof(frame), frame, sizeof(frame)) || frame[1] == 0)
+			break;
+		stack[depth++] = frame[1];
+		/* the stack grows downwards, anything else is not a valid frame */
+		if (frame[0] <= fp)
+			break;
+		fp = frame[0];
+	}
+
+	profiler->sample(get_hart_id(), prv, stack, depth, profile_instret - profile_last_sample);
+	profile_last_sample = profile_instret;
+}
+
+void ISS_CT::commit_hpm() {
+	// loads and stores are counted by the LSCache
+	hpm.events[HPM_EVENT_LOAD] = lscache.num_loads;
+	hpm.events[HPM_EVENT_STORE] = lscache.num_stores;
+	hpm.events[HPM_EVENT_LSCACHE_MISS] = lscache.num_misses;
+
+	if (hpm.commit(prv, csrs.mcountinhibit.reg)) {
+		csrs.mip.fields.lcofip = 1;
+		maybe_interrupt_pending();
+	}
+}
+
 uint64_t ISS_CT::_compute_and_get_current_cycles() {
 	assert(cycle_counter % cycle_time == sc_core::SC_ZERO_TIME);
 	assert(cycle_counter.value() % cycle_time.value() == 0);
@@ -6716,8 +6863,15 @@ uxlen_t ISS_CT::get_csr_value(uxlen_t addr) {
 		case MINSTRETH_ADDR:
 			return csrs.instret.words.high;
 
-		SWITCH_CASE_MATCH_ANY_HPMCOUNTER_RV32:  // not implemented
-			return 0;
+		SWITCH_CASE_MATCH_ANY_HPMCOUNTER_RV32:
+			return get_hpm_csr_value(addr);
+
+		case SCOUNTOVF_ADDR:
+			commit_hpm();
+			// S-mode only sees the overflow bits of counters enabled in mcounteren
+			if (s_mode())
+				return hpm.get_overflow_bits() & csrs.mcounteren.reg;
+			return hpm.get_overflow_bits();
 
 		case MSTATUS_ADDR:
 			return read(csrs.mstatus, MSTATUS_MASK);
@@ -6781,14 +6935,51 @@ uxlen_t ISS_CT::get_csr_value(uxlen_t addr) {
 	return csrs.default_read32(addr);
 }
 
+uxlen_t ISS_CT::get_hpm_csr_value(uxlen_t addr) {
+	using namespace csr;
+
+	commit_hpm();
+	unsigned n = addr & 0x1F;
+	if (addr >= MHPMEVENT3_ADDR && addr <= MHPMEVENT31_ADDR)
+		return hpm.get_event(n);
+	if (addr >= MHPMEVENT3H_ADDR && addr <= MHPMEVENT31H_ADDR)
+		return hpm.get_event(n) >> 32;
+	if ((addr >= MHPMCOUNTER3H_ADDR && addr <= MHPMCOUNTER31H_ADDR) ||
+	    (addr >= HPMCOUNTER3H_ADDR && addr <= HPMCOUNTER31H_ADDR))
+		return hpm.get_counter(n) >> 32;
+	return hpm.get_counter(n);
+}
+
+void ISS_CT::set_hpm_csr_value(uxlen_t addr, uxlen_t value) {
+	using namespace csr;
+
+	auto low = [=](uint64_t x) { return (x & 0xFFFFFFFF00000000) | value; };
+	auto high = [=](uint64_t x) { return (x & 0xFFFFFFFF) | ((uint64_t)value << 32); };
+
+	// events so far are counted with the previous configuration
+	commit_hpm();
+	unsigned n = addr & 0x1F;
+	if (addr >= MHPMEVENT3_ADDR && addr <= MHPMEVENT31_ADDR)
+		hpm.set_event(n, low(hpm.get_event(n)));
+	else if (addr >= MHPMEVENT3H_ADDR && addr <= MHPMEVENT31H_ADDR)
+		hpm.set_event(n, high(hpm.get_event(n)));
+	else if (addr >= MHPMCOUNTER3H_ADDR && addr <= MHPMCOUNTER31H_ADDR)
+		hpm.set_counter(n, high(hpm.get_counter(n)));
+	else
+		hpm.set_counter(n, low(hpm.get_counter(n)));
+}
+
 void ISS_CT::set_csr_value(uxlen_t addr, uxlen_t value) {
 	auto write = [=](auto &x, uxlen_t mask) { x.reg = (x.reg & ~mask) | (value & mask); };
 
 	using namespace csr;
 
 	switch (addr) {
-		case MISA_ADDR:                         // currently, read-only, thus cannot be changed at runtime
-		SWITCH_CASE_MATCH_ANY_HPMCOUNTER_RV32:  // not implemented
+		case MISA_ADDR:  // currently, read-only, thus cannot be changed at runtime
+			break;
+
+		SWITCH_CASE_MATCH_ANY_HPMCOUNTER_RV32:
+			set_hpm_csr_value(addr, value);
 			break;
 
 		case SATP_ADDR: {
@@ -6874,6 +7065,7 @@ void ISS_CT::set_csr_value(uxlen_t addr, uxlen_t value) {
 
 		case MCOUNTINHIBIT_ADDR:
 			commit_cycles();
+			commit_hpm();
 			write(csrs.mcountinhibit, MCOUNTINHIBIT_MASK);
 			break;
 
@@ -6953,6 +7145,38 @@ void ISS_CT::init(instr_memory_if *instr_mem, bool use_dbbcache, data_memory_if
 	cycle_counter_raw_last = 0;
 }
 
+bool ISS_CT::call_native_routine(uxlen_t target, unsigned long &ninstr) {
+	auto routine = native_routines->find(target);
+	if (routine == nullptr)
+		return false;
+
+	auto map = [this](uint64_t addr, unsigned num_bytes, bool is_store) {
+		return (uint8_t *)mem->get_dmi_host_addr(addr, num_bytes, is_store);
+	};
+	auto snoop = [this](uint64_t addr, unsigned num_bytes) { mem->snoop_dmi_store(addr, num_bytes); };
+	uint64_t result;
+	uint64_t instructions;
+	if (!native_routines->call(*routine, (uxlen_t)regs[RegFile::a0], (uxlen_t)regs[RegFile::a1],
+	                           (uxlen_t)regs[RegFile::a2], result, instructions, map, snoop))
+		return false;
+
+	regs[RegFile::a0] = result;
+	ninstr += instructions;
+	sc_core::sc_time delay = cycle_time * double(instructions);
+	if (!csrs.mcountinhibit.fields.CY)
+		cycle_counter += delay;
+	quantum_keeper.inc(delay);
+	return true;
+}
+
+void ISS_CT::update_quantum() {
+	sc_core::sc_time local_time = quantum_keeper.get_local_time();
+	quantum_keeper.reset();
+	quantum_keeper.set(local_time);
+	quantum_changed = true;
+	force_slow_path();
+}
+
 void ISS_CT::sys_exit() {
 	shall_exit = true;
 	force_slow_path();
@@ -7000,10 +7224,44 @@ void ISS_CT::enable_debug(void) {
 
 void ISS_CT::insert_breakpoint(uint64_t addr) {
 	breakpoints.insert(addr);
+	/* blocks are rebuilt on the next slow path */
+	breakpoints_changed = true;
+	force_slow_path();
 }
 
 void ISS_CT::remove_breakpoint(uint64_t addr) {
 	breakpoints.erase(addr);
+	breakpoints_changed = true;
+	force_slow_path();
+}
+
+void ISS_CT::insert_watchpoint(uint64_t addr, uint64_t len, WatchpointType type) {
+	watchpoints.insert(addr, len, type);
+	/* the hart is stopped, pages cached before are dropped right away */
+	lscache.invalidate();
+}
+
+void ISS_CT::remove_watchpoint(uint64_t addr, uint64_t len, WatchpointType type) {
+	watchpoints.remove(addr, len, type);
+}
+
+bool ISS_CT::take_watchpoint_hit(WatchpointHit &hit) {
+	if (!watchpoint_hit_pending)
+		return false;
+	hit = watchpoint_hit;
+	watchpoint_hit_pending = false;
+	return true;
+}
+
+void ISS_CT::watchpoint_access(uint64_t addr, unsigned size, bool is_store, uint64_t value) {
+	auto w = watchpoints.match(addr, size, is_store);
+	if (w == nullptr || !debug_mode)
+		return;
+
+	/* the hart stops after the accessing instruction has completed, as expected by GDB */
+	watchpoint_hit = {w->type, std::max(addr, w->addr), value, dbbcache.get_last_pc_before_callback()};
+	watchpoint_hit_pending = true;
+	set_status(CoreExecStatus::HitBreakpoint);
 }
 
 uint64_t ISS_CT::get_hart_id() {
@@ -7025,6 +7283,7 @@ void ISS_CT::fp_finish_instr() {
 
 void ISS_CT::fp_prepare_instr() {
 	assert(softfloat_exceptionFlags == 0);
+	hpm.count(HPM_EVENT_FP);
 	fp_require_not_off();
 }
 
@@ -7056,6 +7315,9 @@ void ISS_CT::fp_require_not_off() {
 }
 
 void ISS_CT::return_from_trap_handler(PrivilegeLevel return_mode) {
+	if (unlikely(hpm.is_active()))
+		commit_hpm();
+
 	switch (return_mode) {
 		case MachineMode:
 			prv = csrs.mstatus.fields.mpp;
@@ -7162,7 +7424,7 @@ void ISS_CT::clear_software_interrupt() {
 
 void ISS_CT::halt() {
 	if (debug_mode) {
-		this->status = CoreExecStatus::HitBreakpoint;
+		set_status(CoreExecStatus::HitBreakpoint);
 	}
 }
 
@@ -7221,6 +7483,8 @@ void ISS_CT::prepare_interrupt(const PendingInterrupts &e) {
 		exc = EXC_S_SOFTWARE_INTERRUPT;
 	else if (x.fields.stip)
 		exc = EXC_S_TIMER_INTERRUPT;
+	else if (x.fields.lcofip)
+		exc = EXC_LCOF_INTERRUPT;
 	else if (x.fields.ueip)
 		exc = EXC_U_EXTERNAL_INTERRUPT;
 	else if (x.fields.usip)
@@ -7285,6 +7549,11 @@ void ISS_CT::switch_to_trap_handler(PrivilegeLevel target_mode) {
 	// free any potential LR/SC bus lock before processing a trap/interrupt
 	release_lr_sc_reservation();
 
+	// events so far belong to the previous privilege level
+	hpm.count(HPM_EVENT_TRAP);
+	if (unlikely(hpm.is_active()))
+		commit_hpm();
+
 	auto pp = prv;
 	prv = target_mode;
 
@@ -33,7 +33,14 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 	sc_core::sc_event wfi_event;
 	CoreExecStatus status = CoreExecStatus::Runnable;
 	std::unordered_set<uxlen_t> breakpoints;
+	bool breakpoints_changed = false;
+	WatchpointHit watchpoint_hit;
+	bool watchpoint_hit_pending = false;
 	bool debug_mode = false;
+	bool quantum_changed = false;
+	uint64_t profile_instret = 0;  // committed instructions, independent of mcountinhibit
+	uint64_t profile_last_sample = 0;
+	HostProfiler::Timer host_time;  // stopped while waiting for the quantum sync or an interrupt (WFI)
 	// TODO: check and set intended permissions for all members
 
 	struct op_label_entry {
@@ -57,11 +64,17 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 	DBBCacheDefault_T<ARCH, uxlen_t, instr_memory_if> dbbcache;
 	data_memory_if *mem = nullptr;
 	syscall_emulator_if *sys = nullptr;  // optional, if provided, the iss will intercept and handle syscalls directly
+	GuestProfiler *profiler = nullptr;   // optional, if provided, the executed code is sampled
+	RegionOfInterest *roi = nullptr;     // optional, if provided, MARKER instructions switch the simulation mode
+	/* optional, if provided, calls of these routines are executed on the host */
+	NativeRoutines *native_routines = nullptr;
 	RegFile regs;
 	FpRegs fp_regs;
 	bool ignore_wfi = false;
 	bool error_on_zero_traphandler = false;
 	ISS_CT_T_CSR_TABLE csrs;
+	HPM hpm;
+	Watchpoints watchpoints;
 	VExtension<ISS_CT> v_ext;
 	PrivilegeLevel prv = MachineMode;
 
@@ -118,9 +131,38 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 		if (!csrs.mcountinhibit.fields.IR) {
 			csrs.instret.reg += ninstr;
 		}
+		profile_instret += ninstr;
 		ninstr = 0;
+
+		if (unlikely(hpm.is_active()))
+			commit_hpm();
 	}
 
+	/* fold the events counted since the last commit into the hpm counters (see hpm.h) */
+	void commit_hpm();
+
+	/* NOTE: call after commit_instructions, pc must be up to date */
+	inline void maybe_sample_profile() {
+		if (unlikely(profiler != nullptr) && profile_instret - profile_last_sample >= profiler->get_interval())
+			sample_profile();
+	}
+
+	void sample_profile();
+
+	/* committed instructions, independent of mcountinhibit */
+	uint64_t get_executed_instructions() const {
+		return profile_instret;
+	}
+
+	/* apply a changed global quantum, keeps the local time (see roi.h) */
+	void update_quantum();
+
+	/*
+	 * execute the routine at target on the host, if it is a native routine and its arguments allow it (see
+	 * native_routines.h); call after the jump, the caller then returns to the link address
+	 */
+	bool call_native_routine(uxlen_t target, unsigned long &ninstr);
+
 	uint64_t _compute_and_get_current_cycles();
 
 	void init(instr_memory_if *instr_mem, bool use_dbbcache, data_memory_if *data_mem, bool use_lscache,
@@ -168,6 +210,13 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 	void insert_breakpoint(uint64_t) override;
 	void remove_breakpoint(uint64_t) override;
 
+	void insert_watchpoint(uint64_t addr, uint64_t len, WatchpointType type) override;
+	void remove_watchpoint(uint64_t addr, uint64_t len, WatchpointType type) override;
+	bool take_watchpoint_hit(WatchpointHit &hit) override;
+
+	/* called by the memory interface for accesses to watched pages (see watchpoints.h) */
+	void watchpoint_access(uint64_t addr, unsigned size, bool is_store, uint64_t value);
+
 	uint64_t get_hart_id() override;
 
 	void release_lr_sc_reservation() {
@@ -187,6 +236,9 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 	/* see NOTE RVxx.1 and NOTE RVxx.2 in iss_ctemplate_handle.h */
 	PROP_METHOD_VIRTUAL void set_csr_value(uxlen_t addr, uxlen_t value);
 
+	uxlen_t get_hpm_csr_value(uxlen_t addr);
+	void set_hpm_csr_value(uxlen_t addr, uxlen_t value);
+
 	bool is_invalid_csr_access(uxlen_t csr_addr, bool is_write);
 	void validate_csr_counter_read_access_rights(uxlen_t addr);
 
@@ -205,20 +257,38 @@ class ISS_CT PROP_CLASS_FINAL : public external_interrupt_target,
 		}
 	}
 
-	inline void execute_amo_w(Instruction &instr, std::function<int32_t(int32_t, int32_t)> operation) {
+	/* atomic read-modify-write on host memory, returns the previous value */
+	template <typename T, typename Operation>
+	static inline T host_atomic_fetch_op(T *host_addr, T operand, Operation operation) {
+		T old = __atomic_load_n(host_addr, __ATOMIC_RELAXED);
+		while (!__atomic_compare_exchange_n(host_addr, &old, (T)operation(old, operand), true, __ATOMIC_SEQ_CST,
+		                                    __ATOMIC_RELAXED)) {
+		}
+		return old;
+	}
+
+	/* AMOs on DMI memory operate directly on host memory, all others lock the bus */
+	template <typename Operation>
+	inline void execute_amo_w(Instruction &instr, Operation operation) {
 		stats.inc_amo();
+		hpm.count(HPM_EVENT_AMO);
 		uxlen_t addr = regs[instr.rs1()];
 		trap_check_addr_alignment<4, false>(addr);
 		int32_t data;
-		try {
-			data = mem->atomic_load_word(addr);
-		} catch (SimulationTrap &e) {
-			if (e.reason == EXC_LOAD_ACCESS_FAULT)
-				e.reason = EXC_STORE_AMO_ACCESS_FAULT;
-			throw e;
+		int32_t *host_addr = (int32_t *)mem->atomic_get_dmi_host_addr(addr, sizeof(int32_t));
+		if (host_addr) {
+			data = host_atomic_fetch_op(host_addr, (int32_t)regs[instr.rs2()], operation);
+		} else {
+			try {
+				data = mem->atomic_load_word(addr);
+			} catch (SimulationTrap &e) {
+				if (e.reason == EXC_LOAD_ACCESS_FAULT)
+					e.reason = EXC_STORE_AMO_ACCESS_FAULT;
+				throw e;
+			}
+			int32_t val = operation(data, (int32_t)regs[instr.rs2()]);
+			mem->atomic_store_word(addr, val);
 		}
-		int32_t val = operation(data, (int32_t)regs[instr.rs2()]);
-		mem->atomic_store_word(addr, val);
 		// ignore write to zero/x0
 		if (instr.rd() != RegFile::zero) {
 			regs[instr.rd()] = data;
@@ -154,7 +154,9 @@ struct csr_mie {
 			unsigned wpri3 : 1;
 			unsigned meie : 1;
 
-			unsigned long wpri4 : 52;
+			unsigned wpri4 : 1;
+			unsigned lcofie : 1;
+			unsigned long wpri5 : 50;
 		} fields;
 	};
 };
@@ -178,7 +180,9 @@ struct csr_mip {
 			unsigned wiri3 : 1;
 			unsigned meip : 1;
 
-			unsigned long wiri4 : 52;
+			unsigned wiri4 : 1;
+			unsigned lcofip : 1;
+			unsigned long wiri5 : 50;
 		} fields;
 	};
 };
@@ -206,7 +210,8 @@ struct csr_mcounteren {
 			unsigned CY : 1;
 			unsigned TM : 1;
 			unsigned IR : 1;
-			unsigned long reserved : 61;
+			unsigned HPM : 29;
+			unsigned reserved : 32;
 		} fields;
 	};
 };
@@ -218,7 +223,8 @@ struct csr_mcountinhibit {
 			unsigned CY : 1;
 			unsigned zero : 1;
 			unsigned IR : 1;
-			unsigned long reserved : 61;
+			unsigned HPM : 29;
+			unsigned reserved : 32;
 		} fields;
 	};
 };
@@ -343,13 +349,13 @@ inline bool is_bitset(T &csr, unsigned bitpos) {
 	return csr.reg & (1 << bitpos);
 }
 
-constexpr uint64_t MIE_MASK = 0b101110111011;
-constexpr uint64_t SIE_MASK = 0b001100110011;
+constexpr uint64_t MIE_MASK = 0b10101110111011;
+constexpr uint64_t SIE_MASK = 0b10001100110011;
 constexpr uint64_t UIE_MASK = 0b000100010001;
 
-constexpr uint64_t MIP_WRITE_MASK = 0b001100110011;
+constexpr uint64_t MIP_WRITE_MASK = 0b10001100110011;
 constexpr uint64_t MIP_READ_MASK = MIE_MASK;
-constexpr uint64_t SIP_MASK = 0b11;
+constexpr uint64_t SIP_MASK = 0b10000000000011;
 constexpr uint64_t UIP_MASK = 0b1;
 
 constexpr uint64_t MEDELEG_MASK = 0b1011101111111111;
@@ -357,8 +363,8 @@ constexpr uint64_t MIDELEG_MASK = MIE_MASK;
 
 constexpr uint64_t MTVEC_MASK = ~2;
 
-constexpr uint64_t MCOUNTEREN_MASK = 0b111;
-constexpr uint64_t MCOUNTINHIBIT_MASK = 0b101;
+constexpr uint64_t MCOUNTEREN_MASK = 0xffffffff;
+constexpr uint64_t MCOUNTINHIBIT_MASK = 0xfffffffd;
 
 constexpr uint64_t SEDELEG_MASK = 0b1011000111111111;
 constexpr uint64_t SIDELEG_MASK = MIDELEG_MASK;
@@ -612,6 +618,9 @@ constexpr unsigned MHPMEVENT29_ADDR = 0x33D;
 constexpr unsigned MHPMEVENT30_ADDR = 0x33E;
 constexpr unsigned MHPMEVENT31_ADDR = 0x33F;
 
+// Sscofpmf
+constexpr unsigned SCOUNTOVF_ADDR = 0xDA0;
+
 // vector CSRs
 constexpr unsigned VSTART_ADDR = 0x008;
 constexpr unsigned VXSAT_ADDR = 0x009;
@@ -75,6 +75,7 @@ struct Elf64Types {
 	typedef Elf64_Shdr Elf_Shdr;
 	typedef Elf64_Sym Elf_Sym;
 	static constexpr unsigned PT_LOAD = Elf64_PhdrType::PT_LOAD;
+	static constexpr unsigned PT_PHDR = Elf64_PhdrType::PT_PHDR;
 };
 
 typedef GenericElfLoader<Elf64Types> ELFLoader;
@@ -19,14 +19,22 @@
 #include "core/common/clint_if.h"
 #include "core/common/dbbcache.h"
 #include "core/common/debug.h"
+#include "core/common/guest_profiler.h"
+#include "core/common/hpm.h"
+#include "core/common/host_profiler.h"
+#include "core/common/hostfp.h"
+#include "core/common/idle_detector.h"
 #include "core/common/instr.h"
 #include "core/common/irq_if.h"
 #include "core/common/iss_stats.h"
 #include "core/common/lscache.h"
 #include "core/common/mem_if.h"
+#include "core/common/native_routines.h"
 #include "core/common/regfile.h"
+#include "core/common/roi.h"
 #include "core/common/syscall_if.h"
 #include "core/common/trap.h"
+#include "core/common/watchpoints.h"
 #include "csr.h"
 #include "fp.h"
 #include "util/common.h"
@@ -1,12 +1,20 @@
 #include "syscall.h"
 
 #include <assert.h>
+#include <dirent.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/random.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <boost/lexical_cast.hpp>
+#include <cstdlib>
 #include <iostream>
 #include <stdexcept>
 
@@ -60,24 +68,28 @@ void _copy_timespec(rv64_timespec *dst, timespec *src) {
 	dst->tv_nsec = src->tv_nsec;
 }
 
+void _copy_stat(rv64_stat *p, struct stat &x) {
+	p->st_dev = x.st_dev;
+	p->st_ino = x.st_ino;
+	p->st_mode = x.st_mode;
+	p->st_nlink = x.st_nlink;
+	p->st_uid = x.st_uid;
+	p->st_gid = x.st_gid;
+	p->st_rdev = x.st_rdev;
+	p->st_size = x.st_size;
+	p->st_blksize = x.st_blksize;
+	p->st_blocks = x.st_blocks;
+	_copy_timespec(&p->st_atim, &x.st_atim);
+	_copy_timespec(&p->st_mtim, &x.st_mtim);
+	_copy_timespec(&p->st_ctim, &x.st_ctim);
+}
+
 int sys_fstat(SyscallHandler *sys, int fd, rv64_stat *s_addr) {
 	struct stat x;
 	int ans = fstat(fd, &x);
 	if (ans == 0) {
 		rv64_stat *p = (rv64_stat *)sys->guest_to_host_pointer(s_addr);
-		p->st_dev = x.st_dev;
-		p->st_ino = x.st_ino;
-		p->st_mode = x.st_mode;
-		p->st_nlink = x.st_nlink;
-		p->st_uid = x.st_uid;
-		p->st_gid = x.st_gid;
-		p->st_rdev = x.st_rdev;
-		p->st_size = x.st_size;
-		p->st_blksize = x.st_blksize;
-		p->st_blocks = x.st_blocks;
-		_copy_timespec(&p->st_atim, &x.st_atim);
-		_copy_timespec(&p->st_mtim, &x.st_mtim);
-		_copy_timespec(&p->st_ctim, &x.st_ctim);
+		_copy_stat(p, x);
 	}
 	return ans;
 }
@@ -203,9 +215,13 @@ int sys_close(int fd) {
 }
 
 // TODO: add support for additional syscalls if necessary
-uint64_t SyscallHandler::execute_syscall(uint64_t n, uint64_t _a0, uint64_t _a1, uint64_t _a2, uint64_t) {
+uint64_t SyscallHandler::execute_syscall(uint64_t n, uint64_t _a0, uint64_t _a1, uint64_t _a2, uint64_t _a3,
+                                         uint64_t _a4, uint64_t _a5) {
 	// NOTE: when linking with CRT, the most basic example only calls *gettimeofday* and finally *exit*
 
+	if (linux_user)
+		return execute_linux_syscall(n, _a0, _a1, _a2, _a3, _a4, _a5);
+
 	switch (n) {
 		case SYS_fstat:
 			return sys_fstat(this, _a0, (rv64_stat *)_a1);
@@ -260,3 +276,833 @@ uint64_t SyscallHandler::execute_syscall(uint64_t n, uint64_t _a0, uint64_t _a1,
 	std::cerr << "unsupported syscall '" << n << "'" << std::endl;
 	throw std::runtime_error("unsupported syscall '" + std::to_string(n) + "'");
 }
+
+
+/*
+ * Linux user-mode emulation (see SyscallHandler::init_linux_user)
+ */
+
+namespace rv_linux {
+// see: linux/include/uapi/linux/auxvec.h
+constexpr uint64_t AT_NULL = 0;
+constexpr uint64_t AT_PHDR = 3;
+constexpr uint64_t AT_PHENT = 4;
+constexpr uint64_t AT_PHNUM = 5;
+constexpr uint64_t AT_PAGESZ = 6;
+constexpr uint64_t AT_BASE = 7;
+constexpr uint64_t AT_FLAGS = 8;
+constexpr uint64_t AT_ENTRY = 9;
+constexpr uint64_t AT_UID = 11;
+constexpr uint64_t AT_EUID = 12;
+constexpr uint64_t AT_GID = 13;
+constexpr uint64_t AT_EGID = 14;
+constexpr uint64_t AT_HWCAP = 16;
+constexpr uint64_t AT_CLKTCK = 17;
+constexpr uint64_t AT_SECURE = 23;
+constexpr uint64_t AT_RANDOM = 25;
+constexpr uint64_t AT_EXECFN = 31;
+
+// see: linux/include/uapi/asm-generic/fcntl.h
+constexpr int WRONLY = 00000001;
+constexpr int RDWR = 00000002;
+constexpr int CREAT = 00000100;
+constexpr int EXCL = 00000200;
+constexpr int NOCTTY = 00000400;
+constexpr int TRUNC = 00001000;
+constexpr int APPEND = 00002000;
+constexpr int NONBLOCK = 00004000;
+constexpr int DIRECTORY = 00200000;
+constexpr int NOFOLLOW = 00400000;
+constexpr int CLOEXEC = 02000000;
+
+// see: linux/include/uapi/asm-generic/mman-common.h
+constexpr uint64_t MAP_FIXED = 0x10;
+constexpr uint64_t MAP_ANONYMOUS = 0x20;
+constexpr uint64_t MAP_FIXED_NOREPLACE = 0x100000;
+
+// see: linux/include/uapi/linux/sched.h
+constexpr uint64_t CL_VM = 0x100;
+constexpr uint64_t CL_THREAD = 0x10000;
+constexpr uint64_t CL_SETTLS = 0x80000;
+constexpr uint64_t CL_PARENT_SETTID = 0x100000;
+constexpr uint64_t CL_CHILD_CLEARTID = 0x200000;
+constexpr uint64_t CL_CHILD_SETTID = 0x1000000;
+
+// see: linux/include/uapi/linux/futex.h
+constexpr uint64_t FUTEX_WAIT = 0;
+constexpr uint64_t FUTEX_WAKE = 1;
+constexpr uint64_t FUTEX_WAIT_BITSET = 9;
+constexpr uint64_t FUTEX_WAKE_BITSET = 10;
+constexpr uint64_t FUTEX_PRIVATE_FLAG = 128;
+constexpr uint64_t FUTEX_CLOCK_REALTIME = 256;
+
+constexpr uint64_t CLOCK_ID_REALTIME = 0;
+constexpr uint64_t CLOCK_ID_MONOTONIC = 1;
+constexpr uint64_t ABSTIME = 1;
+constexpr uint64_t RLIMIT_STACK = 3;
+constexpr uint64_t IOCTL_TCGETS = 0x5401;
+constexpr uint64_t IOCTL_TIOCGWINSZ = 0x5413;
+constexpr unsigned TERMIOS_SIZE = 36;
+constexpr unsigned SIGACTION_SIZE = 24;
+constexpr unsigned STACK_T_SIZE = 24;
+constexpr int MAX_IOV = 1024;
+}  // namespace rv_linux
+
+struct rv64_iovec {
+	uint64_t iov_base;
+	uint64_t iov_len;
+};
+
+struct rv64_utsname {
+	char sysname[65];
+	char nodename[65];
+	char release[65];
+	char version[65];
+	char machine[65];
+	char domainname[65];
+};
+
+struct rv64_rlimit {
+	uint64_t rlim_cur;
+	uint64_t rlim_max;
+};
+
+static int64_t _linux_result(int64_t ans) {
+	return ans < 0 ? -errno : ans;
+}
+
+static uint64_t _page_align(uint64_t addr) {
+	return (addr + SyscallHandler::PAGE_SIZE - 1) & ~(SyscallHandler::PAGE_SIZE - 1);
+}
+
+static int _translate_linux_open_flags(uint64_t flags) {
+	static const std::pair<int, int> map[] = {
+	    {rv_linux::WRONLY, O_WRONLY},     {rv_linux::RDWR, O_RDWR},         {rv_linux::CREAT, O_CREAT},
+	    {rv_linux::EXCL, O_EXCL},         {rv_linux::NOCTTY, O_NOCTTY},     {rv_linux::TRUNC, O_TRUNC},
+	    {rv_linux::APPEND, O_APPEND},     {rv_linux::NONBLOCK, O_NONBLOCK}, {rv_linux::DIRECTORY, O_DIRECTORY},
+	    {rv_linux::NOFOLLOW, O_NOFOLLOW}, {rv_linux::CLOEXEC, O_CLOEXEC},
+	};
+
+	int ret = 0;
+	for (auto &f : map) ret |= flags & f.first ? f.second : 0;
+	return ret;
+}
+
+uint64_t SyscallHandler::init_linux_user(ISS &core, ELFLoader &elf, uint64_t mem_size,
+                                         const std::vector<std::string> &argv, const std::vector<std::string> &envp) {
+	assert(mem != nullptr && !argv.empty());
+	linux_user = true;
+	this->mem_size = mem_size;
+	exe_path = argv[0];
+	char *path = realpath(elf.get_filename(), nullptr);
+	if (path != nullptr) {
+		exe_path = path;
+		free(path);
+	}
+
+	hp = _page_align(elf.get_load_end());
+	start_heap = hp;
+	max_heap = hp;
+
+	uint64_t stack_top = (mem_offset + mem_size) & ~uint64_t(15);
+	if (stack_top < hp + USER_STACK_SIZE)
+		throw std::runtime_error("guest memory too small for the user stack, increase the memory size");
+	mmap_top = (stack_top - USER_STACK_SIZE) & ~(PAGE_SIZE - 1);
+
+	/* strings and random bytes at the top, then argc, argv, envp and auxv (16 byte aligned) */
+	uint64_t sp = stack_top;
+	auto push = [&](const void *data, size_t size) {
+		sp -= size;
+		memcpy(guest_address_to_host_pointer(sp), data, size);
+		return sp;
+	};
+
+	uint64_t execfn = push(exe_path.c_str(), exe_path.size() + 1);
+	std::vector<uint64_t> words = {argv.size()};
+	for (auto &a : argv) words.push_back(push(a.c_str(), a.size() + 1));
+	words.push_back(0);
+	for (auto &e : envp) words.push_back(push(e.c_str(), e.size() + 1));
+	words.push_back(0);
+
+	uint8_t random[16];
+	for (auto &r : random) r = std::rand();
+	uint64_t at_random = push(random, sizeof(random));
+
+	using namespace rv_linux;
+	// clang-format off
+	std::vector<uint64_t> auxv = {
+		AT_PHDR,   elf.get_phdr_addr(),
+		AT_PHENT,  elf.get_phentsize(),
+		AT_PHNUM,  elf.get_phnum(),
+		AT_PAGESZ, PAGE_SIZE,
+		AT_BASE,   0,
+		AT_FLAGS,  0,
+		AT_ENTRY,  elf.get_entrypoint(),
+		AT_UID,    getuid(),
+		AT_EUID,   geteuid(),
+		AT_GID,    getgid(),
+		AT_EGID,   getegid(),
+		AT_HWCAP,  core.csrs.misa.reg & 0x3ffffff,  // one bit per extension letter, like misa
+		AT_CLKTCK, 100,
+		AT_SECURE, 0,
+		AT_RANDOM, at_random,
+		AT_EXECFN, execfn,
+		AT_NULL,   0,
+	};
+	// clang-format on
+	words.insert(words.end(), auxv.begin(), auxv.end());
+
+	sp = (sp - words.size() * sizeof(uint64_t)) & ~uint64_t(15);
+	memcpy(guest_address_to_host_pointer(sp), words.data(), words.size() * sizeof(uint64_t));
+
+	/* user code expects an enabled FPU */
+	core.csrs.mstatus.fields.fs = FS_INITIAL;
+
+	return sp;
+}
+
+uint8_t *SyscallHandler::guest_range_to_host_pointer(uint64_t addr, uint64_t size) {
+	if (addr < mem_offset || addr - mem_offset > mem_size || size > mem_size - (addr - mem_offset))
+		return nullptr;
+	if (addr == 0 && size != 0)
+		return nullptr;
+	return guest_address_to_host_pointer(addr);
+}
+
+const char *SyscallHandler::guest_string_to_host_pointer(uint64_t addr) {
+	if (addr == 0 || addr < mem_offset || addr - mem_offset >= mem_size)
+		return nullptr;
+	auto p = (const char *)guest_address_to_host_pointer(addr);
+	if (memchr(p, 0, mem_size - (addr - mem_offset)) == nullptr)
+		return nullptr;
+	return p;
+}
+
+SyscallHandler::Thread *SyscallHandler::find_thread(ISS *core) {
+	for (auto &t : threads) {
+		if (t->core == core)
+			return t.get();
+	}
+	return nullptr;
+}
+
+void SyscallHandler::wait_for_clone(ISS &core) {
+	Thread *t = find_thread(&core);
+	assert(t != nullptr && "core not registered as thread core in syscall handler");
+
+	t->running = false;
+	while (!t->started) sc_core::wait(t->start);
+	t->started = false;
+	core.quantum_keeper.reset();
+}
+
+uint64_t SyscallHandler::get_simulated_time_ns() {
+	sc_core::sc_time now = current ? current->quantum_keeper.get_current_time() : sc_core::sc_time_stamp();
+	return now.value() / sc_core::sc_time(1, sc_core::SC_NS).value();
+}
+
+uint64_t SyscallHandler::find_free_range(uint64_t length) {
+	uint64_t end = mmap_top;
+	for (auto it = mappings.rbegin(); it != mappings.rend(); ++it) {
+		uint64_t mapping_end = it->first + it->second;
+		if (mapping_end <= end && end - mapping_end >= length)
+			return end - length;
+		end = std::min(end, it->first);
+	}
+	uint64_t bottom = _page_align(hp);
+	if (end >= bottom && end - bottom >= length)
+		return end - length;
+	return 0;
+}
+
+void SyscallHandler::unmap(uint64_t addr, uint64_t length) {
+	uint64_t end = addr + length;
+	auto it = mappings.upper_bound(addr);
+	if (it != mappings.begin())
+		--it;
+	while (it != mappings.end() && it->first < end) {
+		uint64_t m_start = it->first;
+		uint64_t m_end = it->first + it->second;
+		if (m_end <= addr) {
+			++it;
+			continue;
+		}
+		it = mappings.erase(it);
+		if (m_start < addr)
+			mappings[m_start] = addr - m_start;
+		if (m_end > end)
+			mappings[end] = m_end - end;
+	}
+}
+
+int64_t SyscallHandler::futex_wait(uint64_t addr, const sc_core::sc_time *timeout) {
+	FutexWaiter w;
+	w.addr = addr;
+	futex_waiters.push_back(&w);
+	if (timeout)
+		sc_core::wait(*timeout, w.event);
+	else
+		sc_core::wait(w.event);
+
+	if (!w.woken) {
+		futex_waiters.remove(&w);
+		return -ETIMEDOUT;
+	}
+	return 0;
+}
+
+unsigned SyscallHandler::futex_wake(uint64_t addr, unsigned n) {
+	unsigned woken = 0;
+	for (auto it = futex_waiters.begin(); it != futex_waiters.end() && woken < n;) {
+		if ((*it)->addr == addr) {
+			(*it)->woken = true;
+			(*it)->event.notify(sc_core::SC_ZERO_TIME);
+			it = futex_waiters.erase(it);
+			++woken;
+		} else {
+			++it;
+		}
+	}
+	return woken;
+}
+
+static int64_t sys_linux_iov(SyscallHandler *sys, int fd, uint64_t iov, int64_t iovcnt, bool is_write) {
+	if (iovcnt < 0 || iovcnt > rv_linux::MAX_IOV)
+		return -EINVAL;
+	auto g = (rv64_iovec *)sys->guest_range_to_host_pointer(iov, iovcnt * sizeof(rv64_iovec));
+	if (g == nullptr)
+		return -EFAULT;
+
+	std::vector<struct iovec> h(iovcnt);
+	for (int64_t i = 0; i < iovcnt; ++i) {
+		h[i].iov_base = sys->guest_range_to_host_pointer(g[i].iov_base, g[i].iov_len);
+		h[i].iov_len = g[i].iov_len;
+		if (h[i].iov_base == nullptr)
+			return -EFAULT;
+	}
+	return _linux_result(is_write ? writev(fd, h.data(), iovcnt) : readv(fd, h.data(), iovcnt));
+}
+
+static int64_t sys_linux_fstatat(SyscallHandler *sys, int dirfd, uint64_t pathname, uint64_t statbuf, int flags) {
+	auto path = sys->guest_string_to_host_pointer(pathname);
+	auto p = (rv64_stat *)sys->guest_range_to_host_pointer(statbuf, sizeof(rv64_stat));
+	if (path == nullptr || p == nullptr)
+		return -EFAULT;
+
+	struct stat x;
+	if (fstatat(dirfd, path, &x, flags) < 0)
+		return -errno;
+	_copy_stat(p, x);
+	return 0;
+}
+
+static int64_t sys_linux_readlinkat(SyscallHandler *sys, int dirfd, uint64_t pathname, uint64_t buf, uint64_t size) {
+	auto path = sys->guest_string_to_host_pointer(pathname);
+	auto p = (char *)sys->guest_range_to_host_pointer(buf, size);
+	if (path == nullptr || p == nullptr)
+		return -EFAULT;
+
+	if (!strcmp(path, "/proc/self/exe")) {
+		size_t n = std::min(size, uint64_t(sys->exe_path.size()));
+		memcpy(p, sys->exe_path.c_str(), n);
+		return n;
+	}
+	return _linux_result(readlinkat(dirfd, path, p, size));
+}
+
+static int64_t sys_linux_brk(SyscallHandler *sys, uint64_t addr) {
+	uint64_t limit = sys->mappings.empty() ? sys->mmap_top : sys->mappings.begin()->first;
+	if (addr < sys->start_heap || addr > limit)
+		return sys->hp;
+
+	/* memory returned by brk is zero initialized */
+	if (addr > sys->hp)
+		memset(sys->guest_address_to_host_pointer(sys->hp), 0, addr - sys->hp);
+	sys->hp = addr;
+	sys->max_heap = std::max(sys->max_heap, sys->hp);
+	return sys->hp;
+}
+
+static int64_t sys_linux_mmap(SyscallHandler *sys, uint64_t addr, uint64_t length, uint64_t flags, int fd,
+                              uint64_t offset) {
+	if (length == 0 || (offset & (SyscallHandler::PAGE_SIZE - 1)))
+		return -EINVAL;
+	length = _page_align(length);
+
+	uint64_t start;
+	if (flags & (rv_linux::MAP_FIXED | rv_linux::MAP_FIXED_NOREPLACE)) {
+		if (addr & (SyscallHandler::PAGE_SIZE - 1))
+			return -EINVAL;
+		if (sys->guest_range_to_host_pointer(addr, length) == nullptr)
+			return -ENOMEM;
+		start = addr;
+		sys->unmap(start, length);
+	} else {
+		start = sys->find_free_range(length);
+		if (start == 0)
+			return -ENOMEM;
+	}
+	sys->mappings[start] = length;
+
+	uint8_t *p = sys->guest_address_to_host_pointer(start);
+	memset(p, 0, length);
+	if (!(flags & rv_linux::MAP_ANONYMOUS)) {
+		/* private copy, MAP_SHARED mappings are not written back */
+		if (pread(fd, p, length, offset) < 0) {
+			int err = errno;
+			sys->unmap(start, length);
+			return -err;
+		}
+	}
+	return start;
+}
+
+static int64_t sys_linux_munmap(SyscallHandler *sys, uint64_t addr, uint64_t length) {
+	if ((addr & (SyscallHandler::PAGE_SIZE - 1)) || length == 0)
+		return -EINVAL;
+	sys->unmap(addr, _page_align(length));
+	return 0;
+}
+
+static int64_t sys_linux_clock_gettime(SyscallHandler *sys, uint64_t clock, uint64_t tp) {
+	auto p = (rv64_timespec *)sys->guest_range_to_host_pointer(tp, sizeof(rv64_timespec));
+	if (p == nullptr)
+		return -EFAULT;
+
+	if (clock == rv_linux::CLOCK_ID_REALTIME) {
+		struct timespec x;
+		clock_gettime(CLOCK_REALTIME, &x);
+		_copy_timespec(p, &x);
+	} else {
+		uint64_t ns = sys->get_simulated_time_ns();
+		p->tv_sec = ns / 1000000000;
+		p->tv_nsec = ns % 1000000000;
+	}
+	return 0;
+}
+
+static int64_t sys_linux_nanosleep(SyscallHandler *sys, uint64_t clock, uint64_t flags, uint64_t req) {
+	auto p = (rv64_timespec *)sys->guest_range_to_host_pointer(req, sizeof(rv64_timespec));
+	if (p == nullptr)
+		return -EFAULT;
+
+	int64_t ns = p->tv_sec * 1000000000 + p->tv_nsec;
+	if (flags & rv_linux::ABSTIME) {
+		if (clock == rv_linux::CLOCK_ID_REALTIME) {
+			struct timespec x;
+			clock_gettime(CLOCK_REALTIME, &x);
+			ns -= x.tv_sec * 1000000000 + x.tv_nsec;
+		} else {
+			ns -= sys->get_simulated_time_ns();
+		}
+	}
+	if (ns > 0)
+		sc_core::wait(sc_core::sc_time(ns, sc_core::SC_NS));
+	return 0;
+}
+
+static int64_t sys_linux_futex(SyscallHandler *sys, uint64_t uaddr, uint64_t op, uint64_t val, uint64_t timeout) {
+	using namespace rv_linux;
+	bool realtime = op & FUTEX_CLOCK_REALTIME;
+	op &= ~(FUTEX_PRIVATE_FLAG | FUTEX_CLOCK_REALTIME);
+
+	switch (op) {
+		case FUTEX_WAIT:
+		case FUTEX_WAIT_BITSET: {
+			auto p = (int32_t *)sys->guest_range_to_host_pointer(uaddr, sizeof(int32_t));
+			if (p == nullptr)
+				return -EFAULT;
+			if (*p != int32_t(val))
+				return -EAGAIN;
+			if (timeout == 0)
+				return sys->futex_wait(uaddr, nullptr);
+
+			auto t = (rv64_timespec *)sys->guest_range_to_host_pointer(timeout, sizeof(rv64_timespec));
+			if (t == nullptr)
+				return -EFAULT;
+			/* FUTEX_WAIT has a relative, FUTEX_WAIT_BITSET an absolute timeout */
+			int64_t ns = t->tv_sec * 1000000000 + t->tv_nsec;
+			if (op == FUTEX_WAIT_BITSET) {
+				if (realtime) {
+					struct timespec x;
+					clock_gettime(CLOCK_REALTIME, &x);
+					ns -= x.tv_sec * 1000000000 + x.tv_nsec;
+				} else {
+					ns -= sys->get_simulated_time_ns();
+				}
+			}
+			if (ns <= 0)
+				return -ETIMEDOUT;
+			sc_core::sc_time delay(ns, sc_core::SC_NS);
+			return sys->futex_wait(uaddr, &delay);
+		}
+
+		case FUTEX_WAKE:
+		case FUTEX_WAKE_BITSET:
+			return sys->futex_wake(uaddr, val);
+	}
+	return -ENOSYS;
+}
+
+static int64_t sys_linux_clone(SyscallHandler *sys, uint64_t flags, uint64_t newsp, uint64_t ptid, uint64_t tls,
+                               uint64_t ctid) {
+	using namespace rv_linux;
+	if (!(flags & CL_VM) || !(flags & CL_THREAD)) {
+		std::cerr << "[SyscallHandler] Warning: clone without CLONE_VM and CLONE_THREAD (fork) is not supported"
+		          << std::endl;
+		return -ENOSYS;
+	}
+
+	SyscallHandler::Thread *t = nullptr;
+	for (auto &x : sys->threads) {
+		if (!x->running) {
+			t = x.get();
+			break;
+		}
+	}
+	if (t == nullptr) {
+		std::cerr << "[SyscallHandler] Warning: clone failed, all " << sys->threads.size()
+		          << " thread harts are in use" << std::endl;
+		return -EAGAIN;
+	}
+
+	ISS *parent = sys->current;
+	ISS *child = t->core;
+	int64_t tid = sys->get_tid(child);
+
+	if (flags & CL_PARENT_SETTID) {
+		auto p = (int32_t *)sys->guest_range_to_host_pointer(ptid, sizeof(int32_t));
+		if (p == nullptr)
+			return -EFAULT;
+		*p = tid;
+	}
+	if (flags & CL_CHILD_SETTID) {
+		auto p = (int32_t *)sys->guest_range_to_host_pointer(ctid, sizeof(int32_t));
+		if (p == nullptr)
+			return -EFAULT;
+		*p = tid;
+	}
+	t->clear_child_tid = flags & CL_CHILD_CLEARTID ? ctid : 0;
+
+	/* the child continues after the ecall with a copy of the registers */
+	child->restart(parent->dbbcache.get_last_pc_before_callback() + 4, newsp);
+	for (unsigned i = 1; i < RegFile::NUM_REGS; ++i) child->write_register(i, parent->read_register(i));
+	child->fp_regs = parent->fp_regs;
+	child->csrs.fcsr.reg = parent->csrs.fcsr.reg;
+	child->csrs.mstatus.fields.fs = parent->csrs.mstatus.fields.fs;
+	child->prv = parent->prv;
+	if (newsp != 0)
+		child->write_register(RegFile::sp, newsp);
+	if (flags & CL_SETTLS)
+		child->write_register(RegFile::tp, tls);
+	child->write_register(RegFile::a0, 0);
+
+	t->running = true;
+	t->started = true;
+	t->start.notify(sc_core::SC_ZERO_TIME);
+	return tid;
+}
+
+static int64_t sys_linux_exit(SyscallHandler *sys, uint64_t code, bool group) {
+	SyscallHandler::Thread *t = sys->find_thread(sys->current);
+
+	if (!group && t != nullptr) {
+		/* a thread terminates, its hart becomes available again */
+		if (t->clear_child_tid) {
+			auto p = (int32_t *)sys->guest_range_to_host_pointer(t->clear_child_tid, sizeof(int32_t));
+			if (p != nullptr) {
+				*p = 0;
+				sys->futex_wake(t->clear_child_tid, 1);
+			}
+		}
+		sys->current->sys_exit();
+		return 0;
+	}
+
+	/* exit_group or exit of the initial thread, terminate the process (same as SYS_exit above) */
+	if (code)
+		exit(code);
+	sys->shall_exit = true;
+	for (auto &c : sys->cores) c.second->sys_exit();
+	/* the initial thread might be blocked, its runner would not stop the simulation */
+	if (t != nullptr)
+		sc_core::sc_stop();
+	return 0;
+}
+
+uint64_t SyscallHandler::execute_linux_syscall(uint64_t n, uint64_t _a0, uint64_t _a1, uint64_t _a2, uint64_t _a3,
+                                               uint64_t _a4, uint64_t _a5) {
+	switch (n) {
+		case SYS_read:
+		case SYS_write:
+		case SYS_pread:
+		case SYS_pwrite: {
+			auto p = guest_range_to_host_pointer(_a1, _a2);
+			if (p == nullptr)
+				return -EFAULT;
+			if (n == SYS_read)
+				return _linux_result(read(_a0, p, _a2));
+			if (n == SYS_write)
+				return _linux_result(write(_a0, p, _a2));
+			if (n == SYS_pread)
+				return _linux_result(pread(_a0, p, _a2, _a3));
+			return _linux_result(pwrite(_a0, p, _a2, _a3));
+		}
+
+		case SYS_readv:
+		case SYS_writev:
+			return sys_linux_iov(this, _a0, _a1, _a2, n == SYS_writev);
+
+		case SYS_openat: {
+			auto path = guest_string_to_host_pointer(_a1);
+			if (path == nullptr)
+				return -EFAULT;
+			return _linux_result(openat(_a0, path, _translate_linux_open_flags(_a2), mode_t(_a3)));
+		}
+
+		case SYS_close:
+			return _linux_result(sys_close(_a0));
+
+		case SYS_lseek:
+			return _linux_result(lseek(_a0, off_t(_a1), _a2));
+
+		case SYS_getdents: {
+			auto p = guest_range_to_host_pointer(_a1, _a2);
+			if (p == nullptr)
+				return -EFAULT;
+			return _linux_result(getdents64(_a0, p, _a2));
+		}
+
+		case SYS_fstat: {
+			auto p = (rv64_stat *)guest_range_to_host_pointer(_a1, sizeof(rv64_stat));
+			if (p == nullptr)
+				return -EFAULT;
+			struct stat x;
+			if (fstat(_a0, &x) < 0)
+				return -errno;
+			_copy_stat(p, x);
+			return 0;
+		}
+
+		case SYS_fstatat:
+			return sys_linux_fstatat(this, _a0, _a1, _a2, _a3);
+
+		case SYS_readlinkat:
+			return sys_linux_readlinkat(this, _a0, _a1, _a2, _a3);
+
+		case SYS_faccessat: {
+			auto path = guest_string_to_host_pointer(_a1);
+			if (path == nullptr)
+				return -EFAULT;
+			return _linux_result(faccessat(_a0, path, _a2, 0));
+		}
+
+		case SYS_getcwd: {
+			auto p = (char *)guest_range_to_host_pointer(_a0, _a1);
+			if (p == nullptr)
+				return -EFAULT;
+			if (getcwd(p, _a1) == nullptr)
+				return -errno;
+			return strlen(p) + 1;
+		}
+
+		case SYS_dup:
+			return _linux_result(dup(_a0));
+
+		case SYS_dup3:
+			return _linux_result(dup3(_a0, _a1, _translate_linux_open_flags(_a2)));
+
+		case SYS_fcntl:
+			/* F_DUPFD, F_GETFD, F_SETFD, F_GETFL, F_SETFL take an int, the commands are the same on all Linux hosts */
+			if (_a1 > 4)
+				return -EINVAL;
+			return _linux_result(fcntl(_a0, _a1, int(_a2)));
+
+		case SYS_ioctl:
+			if (_a1 == rv_linux::IOCTL_TCGETS) {
+				/* only used to detect terminals (isatty), the settings are not emulated */
+				auto p = guest_range_to_host_pointer(_a2, rv_linux::TERMIOS_SIZE);
+				if (p == nullptr)
+					return -EFAULT;
+				if (!isatty(_a0))
+					return -ENOTTY;
+				memset(p, 0, rv_linux::TERMIOS_SIZE);
+				return 0;
+			}
+			if (_a1 == rv_linux::IOCTL_TIOCGWINSZ) {
+				auto p = guest_range_to_host_pointer(_a2, sizeof(struct winsize));
+				if (p == nullptr)
+					return -EFAULT;
+				return _linux_result(ioctl(_a0, TIOCGWINSZ, p));
+			}
+			return -ENOTTY;
+
+		case SYS_brk:
+			return sys_linux_brk(this, _a0);
+
+		case SYS_mmap:
+			return sys_linux_mmap(this, _a0, _a1, _a3, _a4, _a5);
+
+		case SYS_munmap:
+			return sys_linux_munmap(this, _a0, _a1);
+
+		case SYS_mremap:
+			/* callers (e.g. realloc) fall back to mmap and copy */
+			return -ENOMEM;
+
+		case SYS_mprotect:
+		case SYS_madvise:
+			return guest_range_to_host_pointer(_a0, _a1) ? 0 : -ENOMEM;
+
+		case SYS_clock_gettime:
+			return sys_linux_clock_gettime(this, _a0, _a1);
+
+		case SYS_clock_getres: {
+			if (_a1 == 0)
+				return 0;
+			auto p = (rv64_timespec *)guest_range_to_host_pointer(_a1, sizeof(rv64_timespec));
+			if (p == nullptr)
+				return -EFAULT;
+			p->tv_sec = 0;
+			p->tv_nsec = 1;
+			return 0;
+		}
+
+		case SYS_gettimeofday: {
+			auto p = (rv64_timeval *)guest_range_to_host_pointer(_a0, sizeof(rv64_timeval));
+			if (p == nullptr)
+				return -EFAULT;
+			struct timeval x;
+			gettimeofday(&x, 0);
+			p->tv_sec = x.tv_sec;
+			p->tv_usec = x.tv_usec;
+			return 0;
+		}
+
+		case SYS_nanosleep:
+			return sys_linux_nanosleep(this, rv_linux::CLOCK_ID_MONOTONIC, 0, _a0);
+
+		case SYS_clock_nanosleep:
+			return sys_linux_nanosleep(this, _a0, _a1, _a2);
+
+		case SYS_sched_yield:
+			sc_core::wait(sc_core::SC_ZERO_TIME);
+			return 0;
+
+		case SYS_getrandom: {
+			auto p = guest_range_to_host_pointer(_a0, _a1);
+			if (p == nullptr)
+				return -EFAULT;
+			return _linux_result(getrandom(p, _a1, 0));
+		}
+
+		case SYS_uname: {
+			auto p = (rv64_utsname *)guest_range_to_host_pointer(_a0, sizeof(rv64_utsname));
+			if (p == nullptr)
+				return -EFAULT;
+			memset(p, 0, sizeof(rv64_utsname));
+			strcpy(p->sysname, "Linux");
+			strcpy(p->nodename, "riscv-vp");
+			strcpy(p->release, "6.1.0");
+			strcpy(p->version, "#1");
+			strcpy(p->machine, "riscv64");
+			return 0;
+		}
+
+		case SYS_prlimit64: {
+			if (_a3 == 0)
+				return 0;
+			auto p = (rv64_rlimit *)guest_range_to_host_pointer(_a3, sizeof(rv64_rlimit));
+			if (p == nullptr)
+				return -EFAULT;
+			p->rlim_cur = _a1 == rv_linux::RLIMIT_STACK ? USER_STACK_SIZE : ~uint64_t(0);
+			p->rlim_max = p->rlim_cur;
+			return 0;
+		}
+
+		case SYS_getpid:
+			return PID;
+
+		case SYS_gettid:
+			return get_tid(current);
+
+		case SYS_getuid:
+			return getuid();
+
+		case SYS_geteuid:
+			return geteuid();
+
+		case SYS_getgid:
+			return getgid();
+
+		case SYS_getegid:
+			return getegid();
+
+		case SYS_set_tid_address: {
+			auto t = find_thread(current);
+			if (t != nullptr)
+				t->clear_child_tid = _a0;
+			return get_tid(current);
+		}
+
+		case SYS_set_robust_list:
+			return 0;
+
+		case SYS_futex:
+			return sys_linux_futex(this, _a0, _a1, _a2, _a3);
+
+		case SYS_clone:
+			/* clone(flags, newsp, parent_tid, tls, child_tid) */
+			return sys_linux_clone(this, _a0, _a1, _a2, _a3, _a4);
+
+		case SYS_exit:
+			return sys_linux_exit(this, _a0, false);
+
+		case SYS_exit_group:
+			return sys_linux_exit(this, _a0, true);
+
+		case SYS_rt_sigaction:
+			/* signals are not delivered, report default actions */
+			if (_a2 != 0) {
+				auto p = guest_range_to_host_pointer(_a2, rv_linux::SIGACTION_SIZE);
+				if (p == nullptr)
+					return -EFAULT;
+				memset(p, 0, rv_linux::SIGACTION_SIZE);
+			}
+			return 0;
+
+		case SYS_rt_sigprocmask:
+			if (_a2 != 0) {
+				auto p = guest_range_to_host_pointer(_a2, _a3);
+				if (p == nullptr)
+					return -EFAULT;
+				memset(p, 0, _a3);
+			}
+			return 0;
+
+		case SYS_sigaltstack:
+			if (_a1 != 0) {
+				auto p = guest_range_to_host_pointer(_a1, rv_linux::STACK_T_SIZE);
+				if (p == nullptr)
+					return -EFAULT;
+				memset(p, 0, rv_linux::STACK_T_SIZE);
+			}
+			return 0;
+
+		case SYS_kill:
+		case SYS_tgkill: {
+			uint64_t sig = n == SYS_kill ? _a1 : _a2;
+			if (sig == 0)
+				return 0;
+			std::cerr << "[SyscallHandler] guest terminated by signal " << sig << std::endl;
+			exit(128 + sig);
+		}
+
+		case SYS_rseq:
+			return -ENOSYS;
+	}
+
+	if (unsupported_syscalls.insert(n).second)
+		std::cerr << "[SyscallHandler] Warning: unsupported syscall '" << n << "', returning ENOSYS" << std::endl;
+	return -ENOSYS;
+}
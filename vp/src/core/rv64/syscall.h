@@ -48,6 +48,29 @@
 #define SYS_fcntl 25
 #define SYS_getdents 61
 #define SYS_dup 23
+// additional Linux syscalls (see SyscallHandler::init_linux_user)
+#define SYS_dup3 24
+#define SYS_ioctl 29
+#define SYS_readv 65
+#define SYS_readlinkat 78
+#define SYS_set_tid_address 96
+#define SYS_futex 98
+#define SYS_set_robust_list 99
+#define SYS_nanosleep 101
+#define SYS_clock_gettime 113
+#define SYS_clock_getres 114
+#define SYS_clock_nanosleep 115
+#define SYS_sched_yield 124
+#define SYS_tgkill 131
+#define SYS_sigaltstack 132
+#define SYS_rt_sigprocmask 135
+#define SYS_gettid 178
+#define SYS_clone 220
+#define SYS_mprotect 226
+#define SYS_madvise 233
+#define SYS_prlimit64 261
+#define SYS_getrandom 278
+#define SYS_rseq 293
 
 // custom extensions
 #define SYS_host_error \
@@ -57,9 +80,16 @@
 
 #include <tlm_utils/simple_target_socket.h>
 
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
 #include <systemc>
+#include <vector>
 
 #include "core/common/syscall_if.h"
+#include "elf_loader.h"
 #include "iss.h"
 
 namespace rv64 {
@@ -73,6 +103,12 @@ struct SyscallHandler : public sc_core::sc_module, syscall_emulator_if {
 		cores[core->get_hart_id()] = core;
 	}
 
+	/* additional hart for guest threads, started by clone (Linux user-mode emulation, see UserThreadRunner) */
+	void register_thread_core(ISS *core) {
+		register_core(core);
+		threads.emplace_back(new Thread(core));
+	}
+
 	SyscallHandler(sc_core::sc_module_name) {
 		tsock.register_b_transport(this, &SyscallHandler::transport);
 	}
@@ -92,6 +128,8 @@ struct SyscallHandler : public sc_core::sc_module, syscall_emulator_if {
 
 	virtual void execute_syscall(iss_syscall_if *core) override {
 		auto syscall = core->read_register(core->get_syscall_register_index());
+		auto a5 = core->read_register(RegFile::a5);
+		auto a4 = core->read_register(RegFile::a4);
 		auto a3 = core->read_register(RegFile::a3);
 		auto a2 = core->read_register(RegFile::a2);
 		auto a1 = core->read_register(RegFile::a1);
@@ -99,7 +137,8 @@ struct SyscallHandler : public sc_core::sc_module, syscall_emulator_if {
 
 		// printf("a7=%u, a0=%u, a1=%u, a2=%u, a3=%u\n", a7, a0, a1, a2, a3);
 
-		auto ans = execute_syscall(syscall, a0, a1, a2, a3);
+		current = dynamic_cast<ISS *>(core);
+		auto ans = execute_syscall(syscall, a0, a1, a2, a3, a4, a5);
 
 		core->write_register(RegFile::a0, ans);
 
@@ -146,7 +185,108 @@ struct SyscallHandler : public sc_core::sc_module, syscall_emulator_if {
 	 * host as byte array). Note: the data structures on the host system might
 	 * not be binary compatible with those on the guest system.
 	 */
-	uint64_t execute_syscall(uint64_t n, uint64_t _a0, uint64_t _a1, uint64_t _a2, uint64_t _a3);
+	uint64_t execute_syscall(uint64_t n, uint64_t _a0, uint64_t _a1, uint64_t _a2, uint64_t _a3, uint64_t _a4 = 0,
+	                         uint64_t _a5 = 0);
+
+	/*
+	 * Linux user-mode emulation
+	 *
+	 * Runs statically linked Linux binaries (e.g. glibc or musl) without a kernel. The process is set up like by the
+	 * Linux ELF loader: the initial stack at the end of the guest memory holds argc, argv, envp and the auxiliary
+	 * vector, the heap (brk) starts after the loaded image. mmap allocates top-down between the heap and the stack.
+	 * Syscalls follow the Linux ABI (negative errno on error) and access guest buffers in place, each one is checked
+	 * against the guest memory (EFAULT). Limitations:
+	 *  - a single address space without protection: mprotect and madvise are accepted without effect and MAP_SHARED
+	 *    file mappings are not written back
+	 *  - signals are not delivered, except that kill/tgkill terminate the simulation
+	 *  - clone only creates threads (CLONE_VM | CLONE_THREAD), each one runs on a hart registered with
+	 *    register_thread_core, futex waits block the hart in simulated time
+	 *  - CLOCK_REALTIME (and gettimeofday) is the host time, all other clocks are the simulated time
+	 *
+	 * Returns the initial stack pointer, call after the image has been loaded and init was called.
+	 */
+	uint64_t init_linux_user(ISS &core, ELFLoader &elf, uint64_t mem_size, const std::vector<std::string> &argv,
+	                         const std::vector<std::string> &envp);
+
+	/* host pointer of [addr, addr + size), nullptr if the range is not in the guest memory */
+	uint8_t *guest_range_to_host_pointer(uint64_t addr, uint64_t size);
+	/* host pointer of a null terminated string, nullptr if it is not in the guest memory */
+	const char *guest_string_to_host_pointer(uint64_t addr);
+
+	/* called by UserThreadRunner: blocks until a thread was started on core by clone */
+	void wait_for_clone(ISS &core);
+
+	static constexpr uint64_t PAGE_SIZE = 4096;
+	static constexpr uint64_t USER_STACK_SIZE = 8 << 20;
+	static constexpr int64_t PID = 1000;  // the thread id of a hart is PID + hart id
+
+	struct Thread {
+		Thread(ISS *core) : core(core) {}
+
+		ISS *core;
+		bool running = false;
+		bool started = false;
+		uint64_t clear_child_tid = 0;
+		sc_core::sc_event start;
+	};
+
+	struct FutexWaiter {
+		uint64_t addr;
+		bool woken = false;
+		sc_core::sc_event event;
+	};
+
+	bool linux_user = false;
+	uint64_t mem_size = 0;
+	uint64_t mmap_top = 0;                  // mmap allocates top-down below, the stack is above
+	std::map<uint64_t, uint64_t> mappings;  // start -> length, mmap regions in use
+	std::vector<std::unique_ptr<Thread>> threads;
+	std::list<FutexWaiter *> futex_waiters;
+	std::set<uint64_t> unsupported_syscalls;
+	std::string exe_path;
+	ISS *current = nullptr;  // hart of the syscall being executed, only valid until the syscall blocks
+
+	uint64_t execute_linux_syscall(uint64_t n, uint64_t _a0, uint64_t _a1, uint64_t _a2, uint64_t _a3, uint64_t _a4,
+	                               uint64_t _a5);
+
+	Thread *find_thread(ISS *core);
+	int64_t get_tid(ISS *core) {
+		return PID + core->get_hart_id();
+	}
+	uint64_t get_simulated_time_ns();
+
+	/* start of a free range of length below mmap_top and above the heap (top-down), 0 if none */
+	uint64_t find_free_range(uint64_t length);
+	void unmap(uint64_t addr, uint64_t length);
+
+	int64_t futex_wait(uint64_t addr, const sc_core::sc_time *timeout);
+	unsigned futex_wake(uint64_t addr, unsigned n);
+};
+
+/* Runs the guest threads started on a hart by clone (see SyscallHandler::init_linux_user). */
+struct UserThreadRunner : public sc_core::sc_module {
+	SyscallHandler &sys;
+	ISS &core;
+	std::string thread_name;
+
+	SC_HAS_PROCESS(UserThreadRunner);
+
+	UserThreadRunner(SyscallHandler &sys, ISS &core)
+	    : sc_module(sc_core::sc_module_name(core.systemc_name.c_str())), sys(sys), core(core) {
+		thread_name = "run" + std::to_string(core.get_hart_id());
+		SC_NAMED_THREAD(run, thread_name.c_str());
+	}
+
+	void run() {
+		while (true) {
+			sys.wait_for_clone(core);
+			core.run();
+
+			if (core.get_status() == CoreExecStatus::HitBreakpoint) {
+				throw std::runtime_error("Breakpoints are not supported for user-mode threads.");
+			}
+		}
+	}
 };
 
 }  // namespace rv64
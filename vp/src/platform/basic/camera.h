@@ -4,13 +4,20 @@
 #ifndef RISCV_ISA_CAMERA_H
 #define RISCV_ISA_CAMERA_H
 
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <systemc>
 #include <tlm_utils/simple_target_socket.h>
 
+#include "core/common/host_profiler.h"
 #include "core/common/irq_if.h"
+#include "video_source.h"
 
 #include <boost/gil.hpp>
 #include <boost/gil/extension/io/jpeg.hpp>
@@ -60,6 +67,19 @@ struct CannyCamera : public sc_core::sc_module {
 #endif
   std::unordered_map<uint64_t, uint32_t *> addr_to_reg;
 
+  // optional video file (raw or Y4M), used instead of the image files
+  std::unique_ptr<VideoSource> video;
+
+  // decoded image files (AVAIL_IMG frames) for the current capture size, loaded once by a background thread
+  // (an empty frame means no suitable image file)
+  std::vector<std::shared_future<std::vector<unsigned char>>> frames;
+  unsigned frames_width = 0, frames_height = 0;
+  std::future<void> frame_loader;
+  std::atomic<bool> stop_loading{false};
+
+  // diagonal stripes used without image file, row h of image n starts at stripes[(h+n)%8]
+  std::vector<unsigned char> stripes;
+
   enum { CAPTURE_INTERVAL_REG_ADDR = 0xff0000,
 	 CAPTURE_WIDTH_ADDR        = 0xff0004,
 	 CAPTURE_HEIGHT_ADDR       = 0xff0008,
@@ -71,9 +91,16 @@ struct CannyCamera : public sc_core::sc_module {
 
   SC_HAS_PROCESS(CannyCamera);
 
-  CannyCamera(sc_core::sc_module_name, uint32_t irq_number)
+  CannyCamera(sc_core::sc_module_name, uint32_t irq_number, const std::string &video_file = "")
 		: irq_number(irq_number) {
     tsock.register_b_transport(this, &CannyCamera::transport);
+    tsock.register_get_direct_mem_ptr(this, &CannyCamera::get_direct_mem_ptr);
+
+    if (!video_file.empty())
+      video = std::make_unique<VideoSource>(video_file);
+    stripes.resize(CAM_MAX_WIDTH+8);
+    for (unsigned i=0; i<stripes.size(); i++)
+      stripes[i] = (i*32)%256;
 
     assert(CAM_FRAME_BUFFER_SIZE < CAPTURE_INTERVAL_REG_ADDR);
     frame_buffer = new unsigned char[CAM_FRAME_BUFFER_SIZE];
@@ -94,6 +121,31 @@ struct CannyCamera : public sc_core::sc_module {
     SC_THREAD(run);
   }
 
+  ~CannyCamera() {
+    stop_frame_loader();
+  }
+
+  // the frame buffer (and blur buffer) can be read directly, their content only changes on capture events
+  bool get_direct_mem_ptr(tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi) {
+    auto addr = trans.get_address();
+    if (addr < CAM_FRAME_BUFFER_SIZE) {
+      dmi.set_start_address(0);
+      dmi.set_end_address(CAM_FRAME_BUFFER_SIZE-1);
+      dmi.set_dmi_ptr(frame_buffer);
+#ifdef ENABLE_HARDWARE_BLUR_BUFFER
+    } else if (  (addr >= CAM_BLUR_BUFFER_ADDR)
+               &&(addr < CAM_BLUR_BUFFER_ADDR+CAM_BLUR_BUFFER_SIZE)) {
+      dmi.set_start_address(CAM_BLUR_BUFFER_ADDR);
+      dmi.set_end_address(CAM_BLUR_BUFFER_ADDR+CAM_BLUR_BUFFER_SIZE-1);
+      dmi.set_dmi_ptr(reinterpret_cast<unsigned char *>(blur_buffer));
+#endif
+    } else {
+      return false;
+    }
+    dmi.allow_read();
+    return true;
+  }
+
   void transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
     auto addr = trans.get_address();
     auto cmd = trans.get_command();
@@ -173,47 +225,19 @@ struct CannyCamera : public sc_core::sc_module {
 
 void run() {
    unsigned int n = 0;
-   char infilename[70];
+   HostProfiler::Section *profile = HostProfiler::instance().get_process_section();
    while (true) {
       if (capture_interval>0) {
          capture_event.notify(sc_core::sc_time(capture_interval, sc_core::SC_US));
       }
       sc_core::wait(capture_event);
+      HostProfiler::Scope scope(profile);
 
       // capture an image into the frame buffer
-      sprintf(infilename, IMG_IN, capture_width, capture_height, (n%AVAIL_IMG)+1);
-      
-      // Try to read image based on file extension
-      int read_success = 0;
-      std::string filename(infilename);
-      if (filename.substr(filename.size() - 4) == ".pgm") {
-         //define image type 
-         boost::gil::gray8_image_t image_t;
-         read_success = read_pgm_image(infilename, frame_buffer, capture_height, capture_width);
-      } else if (filename.substr(filename.size() - 4) == ".jpg" || filename.substr(filename.size() - 5) == ".jpeg") {
-         boost::gil::rgb8_image_t img;
-         read_success = read_jpg_image(infilename, frame_buffer, capture_height, capture_width);
-      } else if (filename.substr(filename.size() - 4) == ".png") {
-         boost::gil::rgb8_image_t img;
-         read_success = read_png_image(infilename, frame_buffer, capture_height, capture_width);
-      }
-
-      if (read_success == 0) {
-         // no suitable image file found, make a diagonally striped one
-         fprintf(stderr, "No suitable image file %s found, making a diagonally striped one.\n", infilename);
-         for(unsigned h=0; h<capture_height; h++) {
-               for(unsigned w=0; w<capture_width; w++) {
-                     frame_buffer[h*capture_width+w] = ((w+h+n)*32)%256;
-               }
-         }
-         if (VERBOSE) fprintf(stderr, "%s: %s captured image %u [%ux%u].\n",
-                           sc_time_stamp().to_string().c_str(), name(), n,
-                           capture_width, capture_height);
-      } else {
-         if (VERBOSE) fprintf(stderr, "%s: %s captured image %u [%ux%u] (%s).\n", 
+      std::string source = capture_frame(n);
+      if (VERBOSE) fprintf(stderr, "%s: %s captured image %u [%ux%u]%s.\n",
                            sc_time_stamp().to_string().c_str(), name(), n,
-                           capture_width, capture_height, infilename);
-      }
+                           capture_width, capture_height, source.c_str());
 
 #ifdef ENABLE_HARDWARE_BLUR_BUFFER
       if (blur_sigma100 > 0) {
@@ -229,6 +253,82 @@ void run() {
    }
 }
 
+// copies image n into the frame buffer, returns a description of its source
+std::string capture_frame(unsigned n) {
+   if (video && video->read_frame(n, frame_buffer, capture_width, capture_height))
+      return " (video)";
+
+   if (frames.empty() || frames_width != capture_width || frames_height != capture_height)
+      load_frames();
+
+   const std::vector<unsigned char> &frame = frames[n%AVAIL_IMG].get();
+   if (!frame.empty()) {
+      memcpy(frame_buffer, frame.data(), frame.size());
+      return " (" + frame_filename(n%AVAIL_IMG, capture_width, capture_height) + ")";
+   }
+
+   // no suitable image file found, use a diagonally striped one
+   for(unsigned h=0; h<capture_height; h++) {
+      memcpy(&frame_buffer[h*capture_width], &stripes[(h+n)%8], capture_width);
+   }
+   return "";
+}
+
+std::string frame_filename(unsigned i, unsigned width, unsigned height) {
+   char infilename[70];
+   snprintf(infilename, sizeof(infilename), IMG_IN, width, height, i+1);
+   return infilename;
+}
+
+// (re)starts decoding the image files for the current capture size, frames become available in order
+void load_frames() {
+   stop_frame_loader();
+
+   frames_width = capture_width;
+   frames_height = capture_height;
+   auto promises = std::make_shared<std::vector<std::promise<std::vector<unsigned char>>>>(AVAIL_IMG);
+   frames.clear();
+   for (auto &p : *promises) frames.push_back(p.get_future().share());
+
+   stop_loading = false;
+   frame_loader = std::async(std::launch::async, [this, promises, width = frames_width, height = frames_height] {
+      for (unsigned i = 0; i < AVAIL_IMG && !stop_loading; i++)
+         (*promises)[i].set_value(load_frame(i, width, height));
+   });
+}
+
+void stop_frame_loader() {
+   if (frame_loader.valid()) {
+      stop_loading = true;
+      frame_loader.wait();
+   }
+}
+
+std::vector<unsigned char> load_frame(unsigned i, unsigned width, unsigned height) {
+   std::string filename = frame_filename(i, width, height);
+   auto has_suffix = [&](const std::string &suffix) {
+      return filename.size() >= suffix.size() &&
+             filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0;
+   };
+
+   // Try to read image based on file extension
+   std::vector<unsigned char> image((size_t)width*height);
+   int read_success = 0;
+   if (has_suffix(".pgm")) {
+      read_success = read_pgm_image(filename.c_str(), image.data(), height, width);
+   } else if (has_suffix(".jpg") || has_suffix(".jpeg")) {
+      read_success = read_jpg_image(filename.c_str(), image.data(), height, width);
+   } else if (has_suffix(".png")) {
+      read_success = read_png_image(filename.c_str(), image.data(), height, width);
+   }
+
+   if (read_success == 0) {
+      fprintf(stderr, "No suitable image file %s found, making a diagonally striped one.\n", filename.c_str());
+      image.clear();
+   }
+   return image;
+}
+
 // inserted from Canny sources by Mike Heath (05/17/21, RD)
 
 /* source: http://marathon.csee.usf.edu/edge/edge_detection.html */
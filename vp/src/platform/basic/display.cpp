@@ -19,6 +19,7 @@ typedef Framebuffer::Frame Frame;
 
 Display::Display(sc_module_name) {
 	tsock.register_b_transport(this, &Display::transport);
+	tsock.register_get_direct_mem_ptr(this, &Display::get_direct_mem_ptr);
 	createSM();
 	memset(frame.raw, 0, sizeof(Framebuffer));
 }
@@ -87,6 +88,16 @@ void Display::transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay
 	delay += sc_core::sc_time(len * 5, sc_core::SC_NS);
 }
 
+bool Display::get_direct_mem_ptr(tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi) {
+	if (trans.get_address() < dmiStart)
+		return false;
+	dmi.set_start_address(dmiStart);
+	dmi.set_end_address(sizeof(Framebuffer) - 1);
+	dmi.set_dmi_ptr(frame.raw + dmiStart);
+	dmi.allow_read_write();
+	return true;
+}
+
 void Display::fillFrame(Framebuffer::Type type, Color color) {
 	assert(sizeof(Frame) % 8 == 0);
 	assert(8 % sizeof(Color) == 0);
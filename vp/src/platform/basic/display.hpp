@@ -29,8 +29,12 @@ struct Display : public sc_core::sc_module {
 
 	void createSM();
 
+	/* the frames (everything after command and parameter) can be accessed directly */
+	static const size_t dmiStart = offsetof(Framebuffer, frames);
+
 	Display(sc_module_name);
 	void transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
+	bool get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi);
 
 	// graphics acceleration functions
 	void fillFrame(Framebuffer::Type frame, Framebuffer::Color color);
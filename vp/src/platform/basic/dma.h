@@ -1,26 +1,69 @@
 #ifndef RISCV_ISA_DMA_H
 #define RISCV_ISA_DMA_H
 
+#include <string.h>
 #include <tlm_utils/simple_initiator_socket.h>
 #include <tlm_utils/simple_target_socket.h>
 
-#include <array>
+#include <algorithm>
+#include <memory>
 #include <systemc>
-#include <unordered_map>
+#include <vector>
 
+#include "core/common/bus_lock_if.h"
+#include "core/common/dmi.h"
+#include "core/common/irq_if.h"
+#include "util/initator_ext.h"
 #include "util/initiator_if.h"
-
+#include "util/register_map.h"
+
+/*
+ * Simple DMA with scatter-gather channels
+ *
+ * Operations: memcpy, memset (fill byte in src[7:0]), memcmp (result: -1/0/1), memchr (searches src for the byte in
+ * dst[7:0], result: address of the first match or 0) and memmove (overlapping buffers).
+ *
+ * Direct mode (registers 0x00-0x10): writing OP starts the operation given by SRC/DST/LEN, the result is available in
+ * STAT. An interrupt is raised on completion.
+ *
+ * Scatter-gather mode: NUM_CHANNELS independent channels at CHANNEL_BASE + n * CHANNEL_STRIDE. Each channel processes
+ * a chain of descriptors (see Descriptor) in memory starting at DESC, started by writing CTRL_START. The result of
+ * every descriptor is written back to its result field. After the whole chain (or on an error) STATUS_DONE (and
+ * STATUS_ERROR) is set and, if CTRL_IE is set, a single interrupt is raised. DONE/ERROR are cleared by writing 1.
+ *
+ * Buffers located in one of the DMI ranges (see add_dma_range) are accessed zero-copy via host pointers, everything
+ * else with chunked TLM transactions of burst_size bytes. The timing is modelled as setup_latency per operation plus
+ * burst_latency per burst_size bytes read or written (plus the latency of the targets for TLM transactions).
+ */
 struct SimpleDMA : public sc_core::sc_module, public initiator_if {
 	tlm_utils::simple_initiator_socket<SimpleDMA> isock;
 	tlm_utils::simple_target_socket<SimpleDMA> tsock;
 
-	tlm::tlm_generic_payload trans;
-	initiator_ext *ext;
-
 	interrupt_gateway *plic = 0;
 	uint32_t irq_number = 0;
 
-	std::array<uint8_t, 64> buffer;
+	/* optional: respect LR/SC of the harts on zero-copy writes (TLM writes go through PeripheralWriteConnector) */
+	std::shared_ptr<bus_lock_if> bus_lock;
+
+	/* timing parameters */
+	unsigned burst_size = 64;
+	sc_core::sc_time burst_latency = sc_core::sc_time(10, sc_core::SC_NS);
+	sc_core::sc_time setup_latency = sc_core::sc_time(10, sc_core::SC_NS);
+
+	std::vector<MemoryDMI> dma_ranges;
+
+	/* state of one running operation (direct mode or channel), operations of different channels may interleave */
+	struct Context {
+		tlm::tlm_generic_payload trans;
+		std::vector<uint8_t> buffer;
+		std::vector<uint8_t> buffer2;
+
+		Context(initiator_if *initiator) {
+			// tlm_generic_payload frees all extension objects in destructor, therefore dynamic allocation is needed
+			trans.set_extension<initiator_ext>(new initiator_ext(initiator));
+		}
+	};
+	std::unique_ptr<Context> direct_ctx;
 
 	uint32_t src = 0;
 	uint32_t dst = 0;
@@ -28,8 +71,6 @@ struct SimpleDMA : public sc_core::sc_module, public initiator_if {
 	uint32_t op = 0;
 	uint32_t stat = 0;
 
-	std::unordered_map<uint64_t, uint32_t *> addr_to_reg;
-
 	enum {
 		OP_NOP = 0,
 		OP_MEMCPY = 1,
@@ -47,6 +88,89 @@ struct SimpleDMA : public sc_core::sc_module, public initiator_if {
 		STAT_ADDR = 16,
 	};
 
+	/* scatter-gather channels */
+	static constexpr unsigned NUM_CHANNELS = 4;
+	static constexpr uint64_t CHANNEL_BASE = 0x100;
+	static constexpr uint64_t CHANNEL_STRIDE = 0x20;
+
+	enum {
+		CH_DESC_ADDR = 0,
+		CH_CTRL_ADDR = 4,
+		CH_STATUS_ADDR = 8,
+		CH_COUNT_ADDR = 12,
+	};
+
+	enum {
+		CTRL_START = 1 << 0,
+		CTRL_IE = 1 << 1,
+	};
+
+	enum {
+		STATUS_BUSY = 1 << 0,
+		STATUS_DONE = 1 << 1,
+		STATUS_ERROR = 1 << 2,
+	};
+
+	struct ChannelRegs {
+		uint32_t desc;
+		uint32_t ctrl;
+		uint32_t status;
+		uint32_t count;
+	};
+	static_assert(sizeof(ChannelRegs) <= CHANNEL_STRIDE, "channel registers overlap");
+	ChannelRegs channel_regs[NUM_CHANNELS] = {};
+
+	/* descriptor in memory (little endian, 4 byte aligned) */
+	struct Descriptor {
+		uint32_t src;
+		uint32_t dst;
+		uint32_t len;
+		uint32_t op;
+		uint32_t result;  // written back on completion
+		uint32_t next;    // address of the next descriptor, 0 terminates the chain
+	};
+
+	struct Channel : public sc_core::sc_module {
+		SimpleDMA &dma;
+		Context ctx;
+		ChannelRegs &regs;
+
+		sc_core::sc_event start_event;
+
+		SC_HAS_PROCESS(Channel);
+
+		Channel(sc_core::sc_module_name, SimpleDMA &dma, ChannelRegs &regs) : dma(dma), ctx(&dma), regs(regs) {
+			SC_THREAD(run);
+		}
+
+		void run() {
+			while (true) {
+				sc_core::wait(start_event);
+
+				bool ok = true;
+				uint32_t addr = regs.desc;
+				regs.count = 0;
+				while (addr != 0) {
+					Descriptor d;
+					dma.read_memory(ctx, addr, (uint8_t *)&d, sizeof(d));
+					if (!dma.execute(ctx, d.op, d.src, d.dst, d.len, d.result)) {
+						ok = false;
+						break;
+					}
+					dma.write_memory(ctx, addr + offsetof(Descriptor, result), (uint8_t *)&d.result, sizeof(d.result));
+					regs.count++;
+					addr = d.next;
+				}
+
+				regs.status = (regs.status & ~STATUS_BUSY) | STATUS_DONE | (ok ? 0 : STATUS_ERROR);
+				if (regs.ctrl & CTRL_IE)
+					dma.plic->gateway_trigger_interrupt(dma.irq_number);
+			}
+		}
+	};
+
+	std::vector<std::unique_ptr<Channel>> channels;
+
 	sc_core::sc_event run_event;
 
 	SC_HAS_PROCESS(SimpleDMA);
@@ -54,104 +178,232 @@ struct SimpleDMA : public sc_core::sc_module, public initiator_if {
 	SimpleDMA(sc_core::sc_module_name, uint32_t irq_number) : irq_number(irq_number) {
 		tsock.register_b_transport(this, &SimpleDMA::transport);
 
-		ext = new initiator_ext(this);  // tlm_generic_payload frees all extension objects in destructor, therefore
-		                                // dynamic allocation is needed
-		trans.set_extension<initiator_ext>(ext);
+		direct_ctx.reset(new Context(this));
 
 		SC_THREAD(run);
 
-		addr_to_reg = {
-		    {SRC_ADDR, &src},
-		    {DST_ADDR, &dst},
-		    {LEN_ADDR, &len},
-		    {OP_ADDR, &op},
-		};
+		for (unsigned i = 0; i < NUM_CHANNELS; i++)
+			channels.emplace_back(new Channel(("Channel" + std::to_string(i)).c_str(), *this, channel_regs[i]));
 	}
 
-	void _copy_block(uint32_t off, uint32_t n) {
-		do_transaction(tlm::TLM_READ_COMMAND, src + off, &buffer[0], n);
-		do_transaction(tlm::TLM_WRITE_COMMAND, dst + off, &buffer[0], n);
+	void add_dma_range(const MemoryDMI &dmi) {
+		dma_ranges.push_back(dmi);
 	}
 
-	void _perform_memcpy() {
-		auto n = len;
-		uint32_t off = 0;
+	uint8_t *get_dmi_ptr(uint64_t addr, uint64_t n, bool is_write = false) {
+		for (auto &e : dma_ranges) {
+			if (e.allows(addr, is_write) && n <= e.get_end() - addr)
+				return e.get_mem_ptr_to_global_addr<uint8_t>(addr);
+		}
+		return nullptr;
+	}
 
-		while (n > buffer.size()) {
-			_copy_block(off, buffer.size());
-			n -= buffer.size();
-			off += buffer.size();
+	uint8_t *get_dmi_write_ptr(uint64_t addr, uint64_t n) {
+		uint8_t *p = get_dmi_ptr(addr, n, true);
+		if (p && bus_lock) {
+			bus_lock->wait_until_unlocked();
+			bus_lock->snoop_store(addr, n);
 		}
+		return p;
+	}
 
-		_copy_block(off, n);
+	sc_core::sc_time bursts(uint64_t n) {
+		return burst_latency * (double)((n + burst_size - 1) / burst_size);
 	}
 
-	void run() {
-		while (true) {
-			sc_core::wait(run_event);
+	void read_memory(Context &ctx, uint64_t addr, uint8_t *data, unsigned n) {
+		if (auto p = get_dmi_ptr(addr, n))
+			memcpy(data, p, n);
+		else
+			do_transaction(ctx, tlm::TLM_READ_COMMAND, addr, data, n);
+	}
 
-			switch (op) {
-				case OP_NOP:
-					break;
+	void write_memory(Context &ctx, uint64_t addr, uint8_t *data, unsigned n) {
+		if (auto p = get_dmi_write_ptr(addr, n))
+			memcpy(p, data, n);
+		else
+			do_transaction(ctx, tlm::TLM_WRITE_COMMAND, addr, data, n);
+	}
 
-				case OP_MEMCPY:
-					_perform_memcpy();
-					break;
+	void _perform_memcpy(Context &ctx, uint32_t src, uint32_t dst, uint32_t len, bool overlap) {
+		uint8_t *s = get_dmi_ptr(src, len);
+		uint8_t *d = get_dmi_write_ptr(dst, len);
+		if (s && d) {
+			memmove(d, s, len);
+			return;
+		}
 
-				case OP_MEMSET:
-					assert(false && "not implemented");
-					break;
+		/* chunked, backwards if the destination overlaps the end of the source */
+		bool backwards = overlap && dst > src && dst < (uint64_t)src + len;
+		uint32_t off = backwards ? len : 0;
+		for (uint32_t done = 0; done < len;) {
+			uint32_t n = std::min<uint32_t>(burst_size, len - done);
+			if (backwards)
+				off -= n;
+			do_transaction(ctx, tlm::TLM_READ_COMMAND, src + off, &ctx.buffer[0], n);
+			do_transaction(ctx, tlm::TLM_WRITE_COMMAND, dst + off, &ctx.buffer[0], n);
+			if (!backwards)
+				off += n;
+			done += n;
+		}
+	}
 
-				case OP_MEMCMP:
-					assert(false && "not implemented");
-					break;
+	void _perform_memset(Context &ctx, uint32_t dst, uint8_t value, uint32_t len) {
+		if (uint8_t *d = get_dmi_write_ptr(dst, len)) {
+			memset(d, value, len);
+			return;
+		}
 
-				case OP_MEMCHR:
-					assert(false && "not implemented");
-					break;
+		memset(&ctx.buffer[0], value, burst_size);
+		for (uint32_t off = 0; off < len;) {
+			uint32_t n = std::min<uint32_t>(burst_size, len - off);
+			do_transaction(ctx, tlm::TLM_WRITE_COMMAND, dst + off, &ctx.buffer[0], n);
+			off += n;
+		}
+	}
 
-				case OP_MEMMOVE:
-					assert(false && "not implemented");
-					break;
+	/* returns the number of bytes compared (up to and including the first difference) */
+	uint32_t _perform_memcmp(Context &ctx, uint32_t a, uint32_t b, uint32_t len, uint32_t &result) {
+		uint8_t *pa = get_dmi_ptr(a, len);
+		uint8_t *pb = get_dmi_ptr(b, len);
+		for (uint32_t off = 0; off < len;) {
+			uint32_t n = std::min<uint32_t>(burst_size, len - off);
+			uint8_t *ca = pa ? pa + off : &ctx.buffer[0];
+			uint8_t *cb = pb ? pb + off : &ctx.buffer2[0];
+			if (!pa)
+				do_transaction(ctx, tlm::TLM_READ_COMMAND, a + off, ca, n);
+			if (!pb)
+				do_transaction(ctx, tlm::TLM_READ_COMMAND, b + off, cb, n);
+			int r = memcmp(ca, cb, n);
+			off += n;
+			if (r) {
+				result = r < 0 ? -1 : 1;
+				return off;
+			}
+		}
+		result = 0;
+		return len;
+	}
 
-				default:
-					assert(false && "unknown operation requested by software");
+	/* returns the number of bytes searched */
+	uint32_t _perform_memchr(Context &ctx, uint32_t src, uint8_t value, uint32_t len, uint32_t &result) {
+		uint8_t *ps = get_dmi_ptr(src, len);
+		for (uint32_t off = 0; off < len;) {
+			uint32_t n = std::min<uint32_t>(burst_size, len - off);
+			uint8_t *c = ps ? ps + off : &ctx.buffer[0];
+			if (!ps)
+				do_transaction(ctx, tlm::TLM_READ_COMMAND, src + off, c, n);
+			if (auto m = (uint8_t *)memchr(c, value, n)) {
+				result = src + off + (m - c);
+				return off + n;
 			}
+			off += n;
+		}
+		result = 0;
+		return len;
+	}
 
-			plic->gateway_trigger_interrupt(irq_number);
+	/* execute a single operation (including its timing), returns false on invalid operations */
+	bool execute(Context &ctx, uint32_t op, uint32_t src, uint32_t dst, uint32_t len, uint32_t &result) {
+		ctx.buffer.resize(burst_size);
+		ctx.buffer2.resize(burst_size);
+
+		sc_core::sc_time delay = setup_latency;
+		result = 0;
+
+		switch (op) {
+			case OP_NOP:
+				break;
+
+			case OP_MEMCPY:
+			case OP_MEMMOVE:
+				_perform_memcpy(ctx, src, dst, len, op == OP_MEMMOVE);
+				delay += 2 * bursts(len);
+				break;
+
+			case OP_MEMSET:
+				_perform_memset(ctx, dst, src, len);
+				delay += bursts(len);
+				break;
+
+			case OP_MEMCMP:
+				delay += 2 * bursts(_perform_memcmp(ctx, src, dst, len, result));
+				break;
+
+			case OP_MEMCHR:
+				delay += bursts(_perform_memchr(ctx, src, dst, len, result));
+				break;
+
+			default:
+				std::cerr << "[" << sc_core::sc_module::name() << "] unknown operation " << op << std::endl;
+				return false;
 		}
+
+		sc_core::wait(delay);
+		return true;
 	}
 
-	void transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
-		auto addr = trans.get_address();
-		auto cmd = trans.get_command();
-		auto len = trans.get_data_length();
-		auto ptr = trans.get_data_ptr();
-
-		assert(len == 4);  // NOTE: only allow to read/write whole register
-
-		auto it = addr_to_reg.find(addr);
-		assert(it != addr_to_reg.end());  // access to non-mapped address
-
-		// actual read/write
-		if (cmd == tlm::TLM_READ_COMMAND) {
-			*((uint32_t *)ptr) = *it->second;
-		} else if (cmd == tlm::TLM_WRITE_COMMAND) {
-			*it->second = *((uint32_t *)ptr);
-		} else {
-			assert(false && "unsupported tlm command for dma access");
+	void run() {
+		while (true) {
+			sc_core::wait(run_event);
+
+			execute(*direct_ctx, op, src, dst, len, stat);
+
+			plic->gateway_trigger_interrupt(irq_number);
 		}
+	}
 
-		// post read/write actions
-		if ((cmd == tlm::TLM_WRITE_COMMAND) && (addr == OP_ADDR)) {
+	void access_op(const vp::regmap::Access &r) {
+		r.fn();
+		if (r.write)
 			run_event.notify(sc_core::sc_time(10, sc_core::SC_NS));
+	}
+
+	void access_channel(const vp::regmap::Access &r) {
+		auto &ch = channel_regs[r.index];
+		uint32_t old_value = *r.vptr;
+
+		r.fn();
+		if (!r.write)
+			return;
+
+		switch (r.offset) {
+			case CH_CTRL_ADDR:
+				if ((ch.ctrl & CTRL_START) && !(ch.status & STATUS_BUSY)) {
+					ch.status |= STATUS_BUSY;
+					channels[r.index]->start_event.notify(setup_latency);
+				}
+				ch.ctrl &= ~CTRL_START;
+				break;
+			case CH_STATUS_ADDR:
+				/* write 1 to clear */
+				ch.status = old_value & ~(ch.status & (STATUS_DONE | STATUS_ERROR));
+				break;
+			case CH_COUNT_ADDR:
+				ch.count = old_value;  // read only
+				break;
 		}
+	}
 
-		(void)delay;  // zero delay
+	// NOTE: only allow to read/write whole registers
+	typedef vp::regmap::RegisterMap<
+	    4,
+	    vp::regmap::Bank<SRC_ADDR, STAT_ADDR + sizeof(uint32_t), vp::regmap::Reg<SRC_ADDR, &SimpleDMA::src>,
+	                     vp::regmap::Reg<DST_ADDR, &SimpleDMA::dst>, vp::regmap::Reg<LEN_ADDR, &SimpleDMA::len>,
+	                     vp::regmap::Reg<OP_ADDR, &SimpleDMA::op, &SimpleDMA::access_op>,
+	                     vp::regmap::Reg<STAT_ADDR, &SimpleDMA::stat>>,
+	    vp::regmap::Bank<CHANNEL_BASE, NUM_CHANNELS * CHANNEL_STRIDE,
+	                     vp::regmap::RegArray<CHANNEL_BASE, NUM_CHANNELS, CHANNEL_STRIDE, &SimpleDMA::channel_regs,
+	                                          &SimpleDMA::access_channel>>>
+	    register_map;
+
+	void transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
+		register_map::transport("SimpleDMA", *this, trans, delay);  // zero delay
 	}
 
-	void do_transaction(tlm::tlm_command cmd, uint64_t addr, uint8_t *data, unsigned num_bytes) {
+	void do_transaction(Context &ctx, tlm::tlm_command cmd, uint64_t addr, uint8_t *data, unsigned num_bytes) {
 		sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+		auto &trans = ctx.trans;
 
 		trans.set_command(cmd);
 		trans.set_address(addr);
@@ -169,7 +421,7 @@ struct SimpleDMA : public sc_core::sc_module, public initiator_if {
 	}
 
 	std::string name() {
-		return this->name();
+		return sc_core::sc_module::name();
 	}
 };
 
@@ -3,22 +3,44 @@
 
 #include <tlm_utils/simple_target_socket.h>
 
+#include <algorithm>
 #include <cmath>
-#include <cstdlib>
 #include <cstring>
 #include <systemc>
-#include <cmath> // Include the cmath library
+#include <vector>
 
 #include "core/common/irq_if.h"
+#include "ipu_engine.h"
+#include "util/register_map.h"
 
 #define IPU_MAX_WIDTH 1920
 #define IPU_MAX_HEIGHT 1080
 #define IPU_FRAME_BUFFER_SIZE (IPU_MAX_WIDTH * IPU_MAX_HEIGHT)
 
-#define VERBOSE true
-
-#define OUTPUT_BUFFER_SIZE (IPU_MAX_WIDTH * IPU_MAX_HEIGHT)
-
+/*
+ * Image processing unit (8 bit grayscale images)
+ *
+ * The input image is written to the frame buffer at offset 0x0, writing 1 to ENABLE runs the pipeline:
+ *
+ *  - warp: rotation by ROTATION_ANGLE degrees about the image center, the bounding box of the rotated image is scaled
+ *    to OUTPUT_WIDTH x OUTPUT_HEIGHT (nearest or bilinear, see SCALE_MODE). Writing 0 to OUTPUT_WIDTH/OUTPUT_HEIGHT
+ *    (the default) selects the size of the bounding box times SCALE_FACTOR instead, reduced to fit into the frame
+ *    buffer.
+ *  - crop (STAGE_CROP): window CROP_X, CROP_Y, CROP_WIDTH x CROP_HEIGHT of the warped image (clipped to the image,
+ *    a size of 0 extends the window to the image border)
+ *  - convolution (STAGE_CONV): kernel selected by CONV_MODE (see ipu::Convolution), custom kernels use CONV_COEFF
+ *    (16 bit signed) and CONV_SHIFT
+ *  - threshold (STAGE_THRESHOLD): pixels >= THRESHOLD[15:8] -> 255, pixels >= THRESHOLD[7:0] -> 128, others -> 0
+ *  - histogram (STAGE_HISTOGRAM): 256 bins of the output pixels, readable at HISTOGRAM
+ *
+ * The optional stages are enabled by the bits of STAGES. On completion ENABLE is cleared, the interrupt is triggered
+ * and the frame buffer contains the output image, whose size can be read from OUTPUT_WIDTH/OUTPUT_HEIGHT.
+ *
+ * The output is computed by the host right away into a separate buffer (see ipu_engine.h) and copied into the frame
+ * buffer on completion, so the frame buffer stays at a fixed host address and can be accessed directly (DMI). In the
+ * timing model all stages work in parallel on a stream of pixels: the slowest enabled stage determines the throughput
+ * (pixels per cycle), a convolution additionally delays the stream by the rows of its window.
+ */
 struct IPU : public sc_core::sc_module {
 	tlm_utils::simple_target_socket<IPU> tsock;
 
@@ -26,23 +48,34 @@ struct IPU : public sc_core::sc_module {
 	uint32_t irq_number = 0;
 	sc_core::sc_event process_event;
 
-	uint32_t enable = 0;  // TODO should probably be boolean flag, or event based
-
-	// memory mapped frame buffer at offset 0x0
-	unsigned char *frame_buffer = 0;
-	unsigned char *output_buffer = 0;
-
+	/* timing model */
+	sc_core::sc_time setup_latency = sc_core::sc_time(1, sc_core::SC_US);
+	sc_core::sc_time clock_period = sc_core::sc_time(5, sc_core::SC_NS);
+	double warp_pixels_per_cycle = 2;  // halved for bilinear scaling
+	double conv3_pixels_per_cycle = 2;
+	double conv5_pixels_per_cycle = 1;
+	double threshold_pixels_per_cycle = 4;
+	double histogram_pixels_per_cycle = 4;
 
 	// Configuration registers
-	uint32_t input_width = 640;   // default width
-	uint32_t input_height = 480;  // default height
-	uint32_t scale_factor = 1;    //TODO make float or something, default scale factor
-	uint32_t rotation_angle = 0;  // rotation angle in degrees (0, 90, 180, 270)
-
-	uint32_t output_width = 70;
-	uint32_t output_height = 100;
-
-	std::unordered_map<uint64_t, uint32_t *> addr_to_reg;
+	uint32_t input_width = 640;
+	uint32_t input_height = 480;
+	uint32_t scale_factor = 1;
+	uint32_t rotation_angle = 0;  // degrees
+	uint32_t enable = 0;
+	uint32_t output_width = 0;
+	uint32_t output_height = 0;
+	uint32_t scale_mode = ipu::NEAREST;
+	uint32_t stages = 0;
+	uint32_t crop_x = 0;
+	uint32_t crop_y = 0;
+	uint32_t crop_width = 0;
+	uint32_t crop_height = 0;
+	uint32_t conv_mode = ipu::CONV_NONE;
+	uint32_t conv_shift = 0;
+	uint32_t threshold = 0;
+	uint32_t conv_coeff[25] = {};
+	uint32_t histogram[256] = {};
 
 	enum {
 		INPUT_WIDTH_ADDR = 0xff0000,
@@ -52,24 +85,36 @@ struct IPU : public sc_core::sc_module {
 		ENABLE_REG_ADDR = 0xff0010,
 		OUTPUT_WIDTH_ADDR = 0xff0014,
 		OUTPUT_HEIGHT_ADDR = 0xff0018,
+		SCALE_MODE_ADDR = 0xff001c,
+		STAGES_ADDR = 0xff0020,
+		CROP_X_ADDR = 0xff0024,
+		CROP_Y_ADDR = 0xff0028,
+		CROP_WIDTH_ADDR = 0xff002c,
+		CROP_HEIGHT_ADDR = 0xff0030,
+		CONV_MODE_ADDR = 0xff0034,
+		CONV_SHIFT_ADDR = 0xff0038,
+		THRESHOLD_ADDR = 0xff003c,
+		CONV_COEFF_ADDR = 0xff0040,
+		HISTOGRAM_ADDR = 0xff0400,
+	};
+
+	enum {
+		STAGE_CROP = 1 << 0,
+		STAGE_CONV = 1 << 1,
+		STAGE_THRESHOLD = 1 << 2,
+		STAGE_HISTOGRAM = 1 << 3,
 	};
 
 	SC_HAS_PROCESS(IPU);
 
-	IPU(sc_core::sc_module_name, uint32_t irq_number) : irq_number(irq_number) {
+	IPU(sc_core::sc_module_name, uint32_t irq_number, unsigned host_threads = 0)
+	    : irq_number(irq_number), engine(host_threads) {
 		tsock.register_b_transport(this, &IPU::transport);
+		tsock.register_get_direct_mem_ptr(this, &IPU::get_direct_mem_ptr);
+
+		frame_buffer.resize(IPU_FRAME_BUFFER_SIZE + ipu::IMAGE_PADDING);
+		work_buffer.resize(IPU_FRAME_BUFFER_SIZE);
 
-		frame_buffer = new unsigned char[IPU_FRAME_BUFFER_SIZE];
-		output_buffer = new unsigned char[IPU_FRAME_BUFFER_SIZE];
-		addr_to_reg = {
-		    {INPUT_WIDTH_ADDR, &input_width},
-		    {INPUT_HEIGHT_ADDR, &input_height},
-		    {SCALE_FACTOR_ADDR, &scale_factor},
-		    {ROTATION_ANGLE_ADDR, &rotation_angle},
-		    {ENABLE_REG_ADDR, &enable},
-			{OUTPUT_WIDTH_ADDR, &output_width},
-			{OUTPUT_HEIGHT_ADDR, &output_height},
-		};
 		SC_THREAD(processing_thread);
 	}
 
@@ -80,221 +125,184 @@ struct IPU : public sc_core::sc_module {
 		auto ptr = trans.get_data_ptr();
 
 		if (addr < IPU_FRAME_BUFFER_SIZE) {
-			// Access frame buffer
-			assert(cmd == tlm::TLM_READ_COMMAND || cmd == tlm::TLM_WRITE_COMMAND);
-			assert((addr + len) <= IPU_FRAME_BUFFER_SIZE);
-			if(cmd == tlm::TLM_WRITE_COMMAND)
+			if (addr + len > IPU_FRAME_BUFFER_SIZE)
+				throw std::runtime_error("IPU frame buffer access out of bounds");
+
+			if (cmd == tlm::TLM_WRITE_COMMAND)
 				memcpy(&frame_buffer[addr], ptr, len);
-			else
+			else if (cmd == tlm::TLM_READ_COMMAND)
 				memcpy(ptr, &frame_buffer[addr], len);
 		} else {
-			assert(len == 4);  // NOTE: only allow to read/write whole register
-			fprintf(stderr, "Cmd: %x, Addr: %x, Val: %x\n", cmd, addr, *((uint32_t *)ptr));
-
-			// Register access
-			auto it = addr_to_reg.find(addr);
-			assert(it != addr_to_reg.end());  // access to non-mapped address
-
-			if ((cmd == tlm::TLM_WRITE_COMMAND) && (addr == INPUT_WIDTH_ADDR)) {
-				uint32_t value = *((uint32_t *)ptr);
-				if (value > IPU_MAX_WIDTH)  // greater than max?
-					return;                 // ignore invalid values
-			}
-			if ((cmd == tlm::TLM_WRITE_COMMAND) && (addr == INPUT_HEIGHT_ADDR)) {
-				uint32_t value = *((uint32_t *)ptr);
-				if (value > IPU_MAX_HEIGHT)  // greater than max?
-					return;                  // ignore invalid values
-			}
-			if ((cmd == tlm::TLM_WRITE_COMMAND) && (addr == ROTATION_ANGLE_ADDR)) {
-				uint32_t value = *((uint32_t *)ptr);
-				fprintf(stderr, "Setting rotation angle to %d\n", *((uint32_t *)ptr));
-			}
-			if ((cmd == tlm::TLM_WRITE_COMMAND) && (addr == SCALE_FACTOR_ADDR)) {
-				uint32_t value = *((uint32_t *)ptr);
-				if (value < 0)
-					return;  // ignore invalid values
-			}
-
-			// actual read/write
-			if (cmd == tlm::TLM_READ_COMMAND) {
-				*((uint32_t *)ptr) = *it->second;  // read the register
-			} else if (cmd == tlm::TLM_WRITE_COMMAND) {
-				*it->second = *((uint32_t *)ptr);  // write the register
-			} else {
-				assert(false && "unsupported tlm command for ipu access");
-			}
-
-			// trigger post read/write actions
-			if ((cmd == tlm::TLM_WRITE_COMMAND) && (addr == ENABLE_REG_ADDR)) {
-				process_event.cancel();
-				if (enable) {
-					process_event.notify(sc_core::sc_time(1e7, sc_core::SC_US)); //TODO remove time, just a placeholder for now
-				}
-			}
+			register_map::transport("IPU", *this, trans, delay);
 		}
 	}
 
+	bool get_direct_mem_ptr(tlm::tlm_generic_payload &trans, tlm::tlm_dmi &dmi) {
+		if (trans.get_address() >= IPU_FRAME_BUFFER_SIZE)
+			return false;
+		dmi.set_start_address(0);
+		dmi.set_end_address(IPU_FRAME_BUFFER_SIZE - 1);
+		dmi.set_dmi_ptr(frame_buffer.data());
+		dmi.allow_read_write();
+		return true;
+	}
+
+	uint8_t *get_frame_buffer() {
+		return frame_buffer.data();
+	}
+
 	void processing_thread() {
-		unsigned int n = 0;
-		char infilename[70];
 		while (true) {
-			fprintf(stderr, "%s: %s waiting for capture event.\n", sc_time_stamp().to_string().c_str(), name());
-			if (enable) {
-				process_event.notify(sc_core::sc_time(1e7, sc_core::SC_US)); //TODO remove time, just a placeholder for now
-			}
 			sc_core::wait(process_event);
-			//output_width = input_width;
-			//output_height = input_height;
-			
-
-			//process_image();
-			/*//fill frame buffer with input image mirrored on the y axis (flippes 180 degrees)
-			for (unsigned h = 0; h < input_height; h++) {
-				for (unsigned w = 0; w < input_width; w++) {
-					output_buffer[h * input_width + w] = frame_buffer[(input_height-1 - h)* input_width + w];
-				}
-			}*/
-
-			rotate(rotation_angle);
-
-			//memcpy(frame_buffer, output_buffer, IPU_FRAME_BUFFER_SIZE);
-			output_buffer = frame_buffer;
-			fprintf(stderr, "Trigger interrupt with number %d\n", irq_number);
+
+			ipu::Pipeline p = pipeline();
+			ipu::Image src = {frame_buffer.data(), input_width, input_height};
+			engine.process(src, work_buffer.data(), p);
+
+			sc_core::wait(processing_time(p));
+
+			memcpy(frame_buffer.data(), work_buffer.data(), (size_t)p.width * p.height);
+			output_width = p.width;
+			output_height = p.height;
+			if (p.histogram)
+				memcpy(histogram, pending_histogram, sizeof(histogram));
+			enable = 0;
 			plic->gateway_trigger_interrupt(irq_number);
-			enable = false;
-			n++;
 		}
 	}
 
    private:
-	void process_image() {
-		// First perform scaling
-		//scale_image();
+	ipu::ImageEngine engine;
+	std::vector<uint8_t> frame_buffer;  // visible at the bus
+	std::vector<uint8_t> work_buffer;   // output of the running operation
+
+	/* requested output size (0: automatic) */
+	uint32_t target_width = 0;
+	uint32_t target_height = 0;
+
+	/* histogram of the running operation, visible on completion */
+	uint32_t pending_histogram[256];
+
+	ipu::Pipeline pipeline(void) {
+		ipu::Pipeline p;
+
+		unsigned width = target_width, height = target_height;
+		output_size(width, height);
+		p.map = ipu::AffineMap::rotate_scale(input_width, input_height, rotation_angle, width, height);
+		p.filter = (ipu::Filter)scale_mode;
+
+		p.width = width;
+		p.height = height;
+		if (stages & STAGE_CROP) {
+			p.crop_x = std::min(crop_x, width - 1);
+			p.crop_y = std::min(crop_y, height - 1);
+			p.width = crop_width ? std::min(crop_width, width - p.crop_x) : width - p.crop_x;
+			p.height = crop_height ? std::min(crop_height, height - p.crop_y) : height - p.crop_y;
+		}
 
-		// Then perform rotation
-		rotate_image();
-	}
+		if (stages & STAGE_CONV) {
+			p.conv = (ipu::Convolution)conv_mode;
+			for (unsigned i = 0; i < 25; i++) p.coeff[i] = (int16_t)conv_coeff[i];
+			p.shift = conv_shift;
+		}
+
+		if (stages & STAGE_THRESHOLD) {
+			p.threshold = true;
+			p.low = threshold & 0xff;
+			p.high = threshold >> 8;
+		}
 
-	void scale_image() {
-		fprintf(stderr, "Scaling");
-		// Simple nearest neighbor scaling
-		//uint32_t output_width = input_width * scale_factor;
-		//uint32_t output_height = input_height * scale_factor;
+		if (stages & STAGE_HISTOGRAM)
+			p.histogram = pending_histogram;
+
+		return p;
 	}
 
-	void rotate_image() {
-		// Only support 90-degree rotations
-		fprintf(stderr, "Rotating image by %d degrees\n", rotation_angle);
-		switch (rotation_angle) {
-			case 0:
-				// Do fuck all
-				break;
-			case 90:
-				rotate_90();
-				break;
-			case 180:
-				rotate_180();
-				break;
-			case 270:
-				rotate_270();
-				break;
-			default:
-				rotate(rotation_angle);
-				break;
+	sc_core::sc_time processing_time(const ipu::Pipeline &p) {
+		double pixels_per_cycle = warp_pixels_per_cycle / (p.filter == ipu::BILINEAR ? 2 : 1);
+		double fill_cycles = 0;
+
+		if (p.conv != ipu::CONV_NONE) {
+			bool large = p.conv == ipu::GAUSSIAN_5X5 || p.conv == ipu::CUSTOM_5X5;
+			double conv = large ? conv5_pixels_per_cycle : conv3_pixels_per_cycle;
+			pixels_per_cycle = std::min(pixels_per_cycle, conv);
+			fill_cycles = (large ? 2 : 1) * p.width / conv;
 		}
+		if (p.threshold)
+			pixels_per_cycle = std::min(pixels_per_cycle, threshold_pixels_per_cycle);
+		if (p.histogram)
+			pixels_per_cycle = std::min(pixels_per_cycle, histogram_pixels_per_cycle);
+
+		double cycles = std::ceil((double)p.width * p.height / pixels_per_cycle + fill_cycles);
+		return setup_latency + clock_period * cycles;
 	}
 
-	void rotate_90() {
-		uint32_t output_width = input_height * scale_factor;
-		uint32_t output_height = input_width * scale_factor;
-		unsigned char *temp = new unsigned char[OUTPUT_BUFFER_SIZE];
-		for (uint32_t y = 0; y < output_height; y++) {
-			for (uint32_t x = 0; x < output_width; x++) {
-				temp[x * output_height + (output_height - 1 - y)] = output_buffer[y * output_width + x];
-			}
-		}
-		memcpy(output_buffer, temp, OUTPUT_BUFFER_SIZE);
-		delete[] temp;
+	void output_size(unsigned &width, unsigned &height) {
+		if (width && height)
+			return;
+
+		unsigned box_width, box_height;
+		ipu::AffineMap::rotated_size(input_width, input_height, rotation_angle, box_width, box_height);
+		double scale = std::max(scale_factor, 1u);
+		scale = std::min({scale, (double)IPU_MAX_WIDTH / std::max(box_width, 1u),
+		                  (double)IPU_MAX_HEIGHT / std::max(box_height, 1u)});
+
+		if (!width)
+			width = std::clamp((unsigned)(box_width * scale), 1u, (unsigned)IPU_MAX_WIDTH);
+		if (!height)
+			height = std::clamp((unsigned)(box_height * scale), 1u, (unsigned)IPU_MAX_HEIGHT);
 	}
 
-	void rotate_180() {
-		uint32_t output_width = input_width * scale_factor;
-		uint32_t output_height = input_height * scale_factor;
-		unsigned char *temp = new unsigned char[OUTPUT_BUFFER_SIZE];
-		for (uint32_t y = 0; y < output_height; y++) {
-			for (uint32_t x = 0; x < output_width; x++) {
-				temp[(output_height - 1 - y) * output_width + (output_width - 1 - x)] =
-				frame_buffer[y * output_width + x];
-			}
-		}
-		memcpy(frame_buffer, temp, OUTPUT_BUFFER_SIZE);
-		delete[] temp;
+	void access_input_size(const vp::regmap::Access &t) {
+		if (t.write && t.nv > (t.addr == INPUT_WIDTH_ADDR ? IPU_MAX_WIDTH : IPU_MAX_HEIGHT))
+			return;  // ignore invalid values
+		t.fn();
 	}
 
-	void rotate_270() {
-		uint32_t output_width = input_height * scale_factor;
-		uint32_t output_height = input_width * scale_factor;
-		unsigned char *temp = new unsigned char[OUTPUT_BUFFER_SIZE];
-		for (uint32_t y = 0; y < output_height; y++) {
-			for (uint32_t x = 0; x < output_width; x++) {
-				temp[(output_width - 1 - x) * output_height + y] = output_buffer[y * output_width + x];
-			}
-		}
-		memcpy(output_buffer, temp, OUTPUT_BUFFER_SIZE);
-		delete[] temp;
+	void access_output_size(const vp::regmap::Access &t) {
+		if (t.write && t.nv > (t.addr == OUTPUT_WIDTH_ADDR ? IPU_MAX_WIDTH : IPU_MAX_HEIGHT))
+			return;  // ignore invalid values
+		t.fn();
+		if (t.write)
+			(t.addr == OUTPUT_WIDTH_ADDR ? target_width : target_height) = t.nv;
 	}
 
-	//rotate arbitrary degrees (untested and mostly as a placeholder, might be garbage)
-	void rotate(uint32_t deg) {
-		//uint32_t output_width = input_width * scale_factor; //TODO allow adjusting of output width and height
-		//uint32_t output_height = input_height * scale_factor;
-		output_buffer = new unsigned char[OUTPUT_BUFFER_SIZE];
-		unsigned char *temp = new unsigned char[OUTPUT_BUFFER_SIZE];
-		
-		double angle = deg * M_PI / 180.0;
-
-		double cos_angle = cos(angle);
-		
-	
-		double sin_angle = sin(angle);
-
-		double abs_sin = sin_angle;
-		if (abs_sin < 0) abs_sin = -abs_sin;
-		double abs_cos = cos_angle;
-		if (abs_cos < 0) abs_cos = -abs_cos;
-		output_width = (uint32_t)(input_width * abs_cos + input_height * abs_sin);
-		output_height = (uint32_t)(input_width * abs_sin + input_height * abs_cos);
-		
-		
-		fprintf(stderr, "Rotating image by %d degrees, new dimensions: %d x %d\n", deg, output_width, output_height);
-
-		float center_x = input_width / 2.0f;
-		float center_y = input_height / 2.0f;
-
-		float out_center_x = output_width / 2.0f;
-		float out_center_y = output_height / 2.0f;
-
-		for(uint32_t y = 0; y < output_height; y++) {
-			for(uint32_t x = 0; x < output_width; x++) {
-				float dx = x - out_center_x;
-				float dy = y - out_center_y;
-				u_int32_t src_x = round(dx * cos_angle - dy * sin_angle + center_x);
-				u_int32_t src_y = round(dx * sin_angle + dy * cos_angle + center_y);
-				
-				
-
-				if(src_x >= 0 && src_x < input_width && src_y >= 0 && src_y < input_height) {
-					uint32_t ix = (uint32_t)src_x;
-					uint32_t iy = (uint32_t)src_y;
-					temp[y * output_width + x] = frame_buffer[iy * input_width + ix];
-				} else {
-					temp[y * output_width + x] = 0; // Fill outside areas with black
-				}
-			}
-		}
-		fprintf(stderr, "Rotated image\n");
-		memcpy(frame_buffer, temp, IPU_FRAME_BUFFER_SIZE);
-		delete[] temp;
-	} 
+	void access_conv_mode(const vp::regmap::Access &t) {
+		if (t.write && t.nv >= ipu::NUM_CONVOLUTIONS)
+			return;  // ignore invalid values
+		t.fn();
+	}
+
+	void access_enable(const vp::regmap::Access &t) {
+		/* a running operation can't be cancelled */
+		if (t.write && enable)
+			return;
+		t.fn();
+		if (t.write && enable)
+			process_event.notify(sc_core::SC_ZERO_TIME);
+	}
+
+	typedef vp::regmap::RegisterMap<
+	    4, vp::regmap::Bank<INPUT_WIDTH_ADDR, CONV_COEFF_ADDR + sizeof(conv_coeff) - INPUT_WIDTH_ADDR,
+	                        vp::regmap::Reg<INPUT_WIDTH_ADDR, &IPU::input_width, &IPU::access_input_size>,
+	                        vp::regmap::Reg<INPUT_HEIGHT_ADDR, &IPU::input_height, &IPU::access_input_size>,
+	                        vp::regmap::Reg<SCALE_FACTOR_ADDR, &IPU::scale_factor>,
+	                        vp::regmap::Reg<ROTATION_ANGLE_ADDR, &IPU::rotation_angle>,
+	                        vp::regmap::Reg<ENABLE_REG_ADDR, &IPU::enable, &IPU::access_enable, vp::regmap::RW, 0x1>,
+	                        vp::regmap::Reg<OUTPUT_WIDTH_ADDR, &IPU::output_width, &IPU::access_output_size>,
+	                        vp::regmap::Reg<OUTPUT_HEIGHT_ADDR, &IPU::output_height, &IPU::access_output_size>,
+	                        vp::regmap::Reg<SCALE_MODE_ADDR, &IPU::scale_mode, nullptr, vp::regmap::RW, 0x1>,
+	                        vp::regmap::Reg<STAGES_ADDR, &IPU::stages, nullptr, vp::regmap::RW, 0xf>,
+	                        vp::regmap::Reg<CROP_X_ADDR, &IPU::crop_x>, vp::regmap::Reg<CROP_Y_ADDR, &IPU::crop_y>,
+	                        vp::regmap::Reg<CROP_WIDTH_ADDR, &IPU::crop_width>,
+	                        vp::regmap::Reg<CROP_HEIGHT_ADDR, &IPU::crop_height>,
+	                        vp::regmap::Reg<CONV_MODE_ADDR, &IPU::conv_mode, &IPU::access_conv_mode>,
+	                        vp::regmap::Reg<CONV_SHIFT_ADDR, &IPU::conv_shift, nullptr, vp::regmap::RW, 0x1f>,
+	                        vp::regmap::Reg<THRESHOLD_ADDR, &IPU::threshold, nullptr, vp::regmap::RW, 0xffff>,
+	                        vp::regmap::RegArray<CONV_COEFF_ADDR, 25, 4, &IPU::conv_coeff, nullptr, vp::regmap::RW,
+	                                             0xffff>>,
+	       vp::regmap::Bank<HISTOGRAM_ADDR, sizeof(histogram),
+	                        vp::regmap::RegArray<HISTOGRAM_ADDR, 256, 4, &IPU::histogram, nullptr, vp::regmap::RO>>>
+	    register_map;
 };
 #endif  // RISCV_ISA_IPU_H
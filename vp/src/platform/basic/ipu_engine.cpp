@@ -0,0 +1,415 @@
+#include "ipu_engine.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define IPU_ENGINE_AVX2
+#include <immintrin.h>
+#endif
+
+using namespace ipu;
+
+static constexpr int32_t FIXED_ONE = 1 << 16;
+static constexpr int32_t FIXED_HALF = 1 << 15;
+
+static int32_t to_fixed(double v) {
+	/* positions far outside of any image are clamped, keeps the stepping along a row clear of overflows */
+	constexpr double limit = 1 << 14;
+	return (int32_t)std::lround(std::max(-limit, std::min(limit, v)) * FIXED_ONE);
+}
+
+/* exact values for multiples of 90 degrees, avoids rounding artifacts of sin/cos */
+static void sin_cos(uint32_t deg, double &s, double &c) {
+	deg %= 360;
+	switch (deg) {
+		case 0:
+			s = 0, c = 1;
+			break;
+		case 90:
+			s = 1, c = 0;
+			break;
+		case 180:
+			s = 0, c = -1;
+			break;
+		case 270:
+			s = -1, c = 0;
+			break;
+		default:
+			s = sin(deg * M_PI / 180.0);
+			c = cos(deg * M_PI / 180.0);
+			break;
+	}
+}
+
+void AffineMap::rotated_size(unsigned src_width, unsigned src_height, uint32_t deg, unsigned &width,
+                             unsigned &height) {
+	double s, c;
+	sin_cos(deg, s, c);
+	width = (unsigned)(src_width * fabs(c) + src_height * fabs(s));
+	height = (unsigned)(src_width * fabs(s) + src_height * fabs(c));
+}
+
+AffineMap AffineMap::rotate_scale(unsigned src_width, unsigned src_height, uint32_t deg, unsigned dst_width,
+                                  unsigned dst_height) {
+	double s, c;
+	sin_cos(deg, s, c);
+
+	unsigned box_width, box_height;
+	rotated_size(src_width, src_height, deg, box_width, box_height);
+	double sx = dst_width ? (double)box_width / dst_width : 1;
+	double sy = dst_height ? (double)box_height / dst_height : 1;
+
+	/* pixel centers of the output are mapped onto the bounding box, which is centered on the source image */
+	double bx = 0.5 * sx - box_width / 2.0;
+	double by = 0.5 * sy - box_height / 2.0;
+
+	AffineMap m;
+	m.xu = sx * c;
+	m.xv = -sy * s;
+	m.x0 = bx * c - by * s + (src_width - 1) / 2.0;
+	m.yu = sx * s;
+	m.yv = sy * c;
+	m.y0 = bx * s + by * c + (src_height - 1) / 2.0;
+	return m;
+}
+
+WorkerPool::WorkerPool(unsigned threads) {
+	if (threads == 0)
+		threads = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+	for (unsigned i = 0; i < threads; i++) workers.emplace_back(&WorkerPool::work, this);
+}
+
+WorkerPool::~WorkerPool(void) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	start_cond.notify_all();
+	for (auto &t : workers) t.join();
+}
+
+void WorkerPool::run(unsigned n, const std::function<void(unsigned)> &fn) {
+	if (workers.empty() || n <= 1) {
+		for (unsigned i = 0; i < n; i++) fn(i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &fn;
+		num_items = n;
+		next_item = 0;
+		active = workers.size();
+		generation++;
+	}
+	start_cond.notify_all();
+
+	drain();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done_cond.wait(lock, [this] { return active == 0; });
+	job = nullptr;
+}
+
+void WorkerPool::work(void) {
+	uint64_t seen = 0;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		start_cond.wait(lock, [&] { return stop || generation != seen; });
+		if (stop)
+			return;
+		seen = generation;
+
+		lock.unlock();
+		drain();
+		lock.lock();
+
+		if (--active == 0)
+			done_cond.notify_one();
+	}
+}
+
+void WorkerPool::drain(void) {
+	unsigned i;
+	while ((i = next_item.fetch_add(1)) < num_items) (*job)(i);
+}
+
+static inline bool inside(const Image &src, int32_t x, int32_t y) {
+	int32_t ix = (x + FIXED_HALF) >> 16;
+	int32_t iy = (y + FIXED_HALF) >> 16;
+	return ix >= 0 && ix < (int32_t)src.width && iy >= 0 && iy < (int32_t)src.height;
+}
+
+static inline uint8_t sample_nearest(const Image &src, int32_t x, int32_t y) {
+	if (!inside(src, x, y))
+		return 0;
+	return src.data[((y + FIXED_HALF) >> 16) * src.width + ((x + FIXED_HALF) >> 16)];
+}
+
+static inline uint8_t sample_bilinear(const Image &src, int32_t x, int32_t y) {
+	if (!inside(src, x, y))
+		return 0;
+
+	int32_t x0 = x >> 16, y0 = y >> 16;
+	uint32_t fx = (x >> 8) & 0xff, fy = (y >> 8) & 0xff;
+	int32_t wmax = src.width - 1, hmax = src.height - 1;
+	int32_t xa = std::clamp(x0, 0, wmax), xb = std::clamp(x0 + 1, 0, wmax);
+	const uint8_t *ra = src.data + std::clamp(y0, 0, hmax) * src.width;
+	const uint8_t *rb = src.data + std::clamp(y0 + 1, 0, hmax) * src.width;
+
+	uint32_t top = ra[xa] * (256 - fx) + ra[xb] * fx;
+	uint32_t bottom = rb[xa] * (256 - fx) + rb[xb] * fx;
+	return (top * (256 - fy) + bottom * fy + FIXED_HALF) >> 16;
+}
+
+/* position of the i-th pixel of a row, wraps like the vector kernels */
+static inline int32_t step(int32_t start, unsigned i, int32_t delta) {
+	return (int32_t)((uint32_t)start + i * (uint32_t)delta);
+}
+
+static void warp_row_scalar(const Image &src, uint8_t *dst, unsigned start, unsigned n, int32_t x, int32_t y,
+                            int32_t dx, int32_t dy, Filter filter) {
+	if (filter == BILINEAR) {
+		for (unsigned i = start; i < n; i++) dst[i] = sample_bilinear(src, step(x, i, dx), step(y, i, dy));
+	} else {
+		for (unsigned i = start; i < n; i++) dst[i] = sample_nearest(src, step(x, i, dx), step(y, i, dy));
+	}
+}
+
+#ifdef IPU_ENGINE_AVX2
+__attribute__((target("avx2"))) static inline void store_bytes(uint8_t *dst, __m256i v) {
+	__m128i w = _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	_mm_storel_epi64(reinterpret_cast<__m128i *>(dst), _mm_packus_epi16(w, w));
+}
+
+/* processes the pixels in multiples of 8, returns the number of processed pixels */
+__attribute__((target("avx2"))) static unsigned warp_row_avx2(const Image &src, uint8_t *dst, unsigned n, int32_t x,
+                                                              int32_t y, int32_t dx, int32_t dy, Filter filter) {
+	const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i minus_one = _mm256_set1_epi32(-1);
+	const __m256i half = _mm256_set1_epi32(FIXED_HALF);
+	const __m256i bytes = _mm256_set1_epi32(0xff);
+	const __m256i w = _mm256_set1_epi32(src.width);
+	const __m256i h = _mm256_set1_epi32(src.height);
+	const __m256i wmax = _mm256_set1_epi32(src.width - 1);
+	const __m256i hmax = _mm256_set1_epi32(src.height - 1);
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i full = _mm256_set1_epi32(256);
+	const __m256i step_x = _mm256_set1_epi32((uint32_t)dx * 8);
+	const __m256i step_y = _mm256_set1_epi32((uint32_t)dy * 8);
+	const int *base = reinterpret_cast<const int *>(src.data);
+
+	__m256i vx = _mm256_add_epi32(_mm256_set1_epi32(x), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(dx)));
+	__m256i vy = _mm256_add_epi32(_mm256_set1_epi32(y), _mm256_mullo_epi32(lanes, _mm256_set1_epi32(dy)));
+
+	unsigned i = 0;
+	for (; i + 8 <= n; i += 8) {
+		__m256i ix = _mm256_srai_epi32(_mm256_add_epi32(vx, half), 16);
+		__m256i iy = _mm256_srai_epi32(_mm256_add_epi32(vy, half), 16);
+		__m256i in = _mm256_and_si256(_mm256_and_si256(_mm256_cmpgt_epi32(w, ix), _mm256_cmpgt_epi32(ix, minus_one)),
+		                              _mm256_and_si256(_mm256_cmpgt_epi32(h, iy), _mm256_cmpgt_epi32(iy, minus_one)));
+		__m256i v;
+
+		if (filter == BILINEAR) {
+			__m256i x0 = _mm256_srai_epi32(vx, 16);
+			__m256i y0 = _mm256_srai_epi32(vy, 16);
+			__m256i fx = _mm256_and_si256(_mm256_srli_epi32(vx, 8), bytes);
+			__m256i fy = _mm256_and_si256(_mm256_srli_epi32(vy, 8), bytes);
+			__m256i xa = _mm256_max_epi32(_mm256_min_epi32(x0, wmax), zero);
+			__m256i xb = _mm256_max_epi32(_mm256_min_epi32(_mm256_add_epi32(x0, one), wmax), zero);
+			__m256i ya = _mm256_max_epi32(_mm256_min_epi32(y0, hmax), zero);
+			__m256i yb = _mm256_max_epi32(_mm256_min_epi32(_mm256_add_epi32(y0, one), hmax), zero);
+			__m256i ra = _mm256_mullo_epi32(ya, w);
+			__m256i rb = _mm256_mullo_epi32(yb, w);
+
+			__m256i p00 = _mm256_and_si256(_mm256_i32gather_epi32(base, _mm256_add_epi32(ra, xa), 1), bytes);
+			__m256i p01 = _mm256_and_si256(_mm256_i32gather_epi32(base, _mm256_add_epi32(ra, xb), 1), bytes);
+			__m256i p10 = _mm256_and_si256(_mm256_i32gather_epi32(base, _mm256_add_epi32(rb, xa), 1), bytes);
+			__m256i p11 = _mm256_and_si256(_mm256_i32gather_epi32(base, _mm256_add_epi32(rb, xb), 1), bytes);
+
+			__m256i gx = _mm256_sub_epi32(full, fx);
+			__m256i top = _mm256_add_epi32(_mm256_mullo_epi32(p00, gx), _mm256_mullo_epi32(p01, fx));
+			__m256i bottom = _mm256_add_epi32(_mm256_mullo_epi32(p10, gx), _mm256_mullo_epi32(p11, fx));
+			v = _mm256_add_epi32(_mm256_mullo_epi32(top, _mm256_sub_epi32(full, fy)), _mm256_mullo_epi32(bottom, fy));
+			v = _mm256_and_si256(_mm256_srli_epi32(_mm256_add_epi32(v, half), 16), in);
+		} else {
+			__m256i idx = _mm256_add_epi32(_mm256_mullo_epi32(iy, w), ix);
+			v = _mm256_and_si256(_mm256_mask_i32gather_epi32(zero, base, idx, in, 1), bytes);
+		}
+
+		store_bytes(dst + i, v);
+		vx = _mm256_add_epi32(vx, step_x);
+		vy = _mm256_add_epi32(vy, step_y);
+	}
+	return i;
+}
+
+static const bool has_avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+void ImageEngine::warp_row(const Image &src, uint8_t *dst, unsigned n, int32_t x, int32_t y, int32_t dx, int32_t dy,
+                           Filter filter) {
+	if (src.width == 0 || src.height == 0) {
+		memset(dst, 0, n);
+		return;
+	}
+
+	/* unscaled rows along the x axis are plain copies (if bilinear sampling hits the pixels exactly) */
+	if (dx == FIXED_ONE && dy == 0 && (filter == NEAREST || ((x | y) & 0xffff) == 0)) {
+		int64_t iy = (y + FIXED_HALF) >> 16;
+		int64_t ix = (x + FIXED_HALF) >> 16;
+		int64_t begin = iy >= 0 && iy < src.height ? std::clamp<int64_t>(-ix, 0, n) : n;
+		int64_t end = std::clamp<int64_t>(src.width - ix, begin, n);
+		memset(dst, 0, begin);
+		if (end > begin)
+			memcpy(dst + begin, src.data + iy * src.width + ix + begin, end - begin);
+		memset(dst + end, 0, n - end);
+		return;
+	}
+
+	unsigned done = 0;
+#ifdef IPU_ENGINE_AVX2
+	if (has_avx2)
+		done = warp_row_avx2(src, dst, n, x, y, dx, dy, filter);
+#endif
+	warp_row_scalar(src, dst, done, n, x, y, dx, dy, filter);
+}
+
+static const int16_t GAUSSIAN_3X3_COEFF[9] = {1, 2, 1, 2, 4, 2, 1, 2, 1};
+static const int16_t GAUSSIAN_5X5_COEFF[25] = {1, 4,  6,  4,  1, 4, 16, 24, 16, 4, 6, 24, 36,
+                                               24, 6, 4, 16, 24, 16, 4, 1,  4,  6,  4, 1};
+static const int16_t SOBEL_X_COEFF[9] = {-1, 0, 1, -2, 0, 2, -1, 0, 1};
+static const int16_t SOBEL_Y_COEFF[9] = {-1, -2, -1, 0, 0, 0, 1, 2, 1};
+
+static unsigned conv_radius(Convolution conv) {
+	switch (conv) {
+		case CONV_NONE:
+			return 0;
+		case GAUSSIAN_5X5:
+		case CUSTOM_5X5:
+			return 2;
+		default:
+			return 1;
+	}
+}
+
+/* acc[u] = sum of coeff * pixel over the kernel, rows[ky] point to the rows of the window padded by radius pixels */
+static void convolve_row(const uint8_t *const *rows, unsigned size, const int16_t *coeff, int32_t *acc, unsigned n) {
+	std::fill(acc, acc + n, 0);
+	for (unsigned ky = 0; ky < size; ky++) {
+		for (unsigned kx = 0; kx < size; kx++) {
+			int32_t c = coeff[ky * size + kx];
+			if (c == 0)
+				continue;
+			const uint8_t *r = rows[ky] + kx;
+			for (unsigned u = 0; u < n; u++) acc[u] += c * r[u];
+		}
+	}
+}
+
+static void finish_row(const Pipeline &p, const int32_t *acc, uint8_t *dst, unsigned n) {
+	switch (p.conv) {
+		case SOBEL_X:
+		case SOBEL_Y:
+			for (unsigned u = 0; u < n; u++) dst[u] = std::min(std::abs(acc[u]), 255);
+			break;
+		case SOBEL_MAGNITUDE:
+			for (unsigned u = 0; u < n; u++) dst[u] = std::min(std::abs(acc[u]) + std::abs(acc[n + u]), 255);
+			break;
+		default: {
+			unsigned shift = p.conv == GAUSSIAN_3X3 ? 4 : p.conv == GAUSSIAN_5X5 ? 8 : p.shift;
+			int32_t round = shift ? 1 << (shift - 1) : 0;
+			for (unsigned u = 0; u < n; u++) dst[u] = std::clamp((acc[u] + round) >> shift, 0, 255);
+			break;
+		}
+	}
+}
+
+void ImageEngine::process(const Image &src, uint8_t *dst, const Pipeline &p) {
+	if (p.histogram)
+		std::fill(p.histogram, p.histogram + 256, 0);
+
+	unsigned tiles = (p.height + TILE_ROWS - 1) / TILE_ROWS;
+	pool.run(tiles, [&](unsigned tile) { process_tile(src, dst, p, tile); });
+}
+
+void ImageEngine::process_tile(const Image &src, uint8_t *dst, const Pipeline &p, unsigned tile) {
+	/* per host thread, reused across tiles and frames */
+	static thread_local std::vector<uint8_t> window;
+	static thread_local std::vector<int32_t> acc;
+
+	unsigned begin = tile * TILE_ROWS;
+	unsigned end = std::min(p.height, begin + TILE_ROWS);
+	int32_t dx = to_fixed(p.map.xu);
+	int32_t dy = to_fixed(p.map.yu);
+
+	/* row v of the cropped image, row start positions are computed exactly, only the stepping along the row
+	 * accumulates errors */
+	auto warp = [&](unsigned v, uint8_t *row) {
+		double u0 = p.crop_x, v0 = p.crop_y + v;
+		int32_t x = to_fixed(p.map.xu * u0 + p.map.xv * v0 + p.map.x0);
+		int32_t y = to_fixed(p.map.yu * u0 + p.map.yv * v0 + p.map.y0);
+		warp_row(src, row, p.width, x, y, dx, dy, p.filter);
+	};
+
+	unsigned radius = conv_radius(p.conv);
+	if (radius == 0) {
+		for (unsigned v = begin; v < end; v++) warp(v, dst + (size_t)v * p.width);
+	} else {
+		/* warped rows of the tile and the rows around it, padded by replicating the border pixels */
+		unsigned first = begin >= radius ? begin - radius : 0;
+		unsigned last = std::min(p.height, end + radius);
+		unsigned stride = p.width + 2 * radius;
+		window.resize((size_t)(last - first) * stride);
+		for (unsigned v = first; v < last; v++) {
+			uint8_t *row = &window[(size_t)(v - first) * stride];
+			warp(v, row + radius);
+			std::fill(row, row + radius, row[radius]);
+			std::fill(row + radius + p.width, row + stride, row[radius + p.width - 1]);
+		}
+
+		const int16_t *coeff = p.coeff;
+		if (p.conv == GAUSSIAN_3X3)
+			coeff = GAUSSIAN_3X3_COEFF;
+		else if (p.conv == GAUSSIAN_5X5)
+			coeff = GAUSSIAN_5X5_COEFF;
+		else if (p.conv == SOBEL_X || p.conv == SOBEL_MAGNITUDE)
+			coeff = SOBEL_X_COEFF;
+		else if (p.conv == SOBEL_Y)
+			coeff = SOBEL_Y_COEFF;
+
+		unsigned size = 2 * radius + 1;
+		acc.resize(2 * p.width);
+		for (unsigned v = begin; v < end; v++) {
+			const uint8_t *rows[5];
+			for (unsigned k = 0; k < size; k++) {
+				int w = std::clamp<int>(v + k - radius, 0, p.height - 1);
+				rows[k] = &window[(size_t)(w - first) * stride];
+			}
+			convolve_row(rows, size, coeff, acc.data(), p.width);
+			if (p.conv == SOBEL_MAGNITUDE)
+				convolve_row(rows, size, SOBEL_Y_COEFF, acc.data() + p.width, p.width);
+			finish_row(p, acc.data(), dst + (size_t)v * p.width, p.width);
+		}
+	}
+
+	uint8_t *out = dst + (size_t)begin * p.width;
+	size_t n = (size_t)(end - begin) * p.width;
+
+	if (p.threshold) {
+		for (size_t i = 0; i < n; i++) out[i] = out[i] >= p.high ? 255 : out[i] >= p.low ? 128 : 0;
+	}
+
+	if (p.histogram) {
+		uint32_t histogram[256] = {};
+		for (size_t i = 0; i < n; i++) histogram[out[i]]++;
+
+		std::lock_guard<std::mutex> lock(histogram_mutex);
+		for (unsigned i = 0; i < 256; i++) p.histogram[i] += histogram[i];
+	}
+}
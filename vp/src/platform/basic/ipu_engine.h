@@ -0,0 +1,142 @@
+#ifndef RISCV_VP_IPU_ENGINE_H
+#define RISCV_VP_IPU_ENGINE_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Host side image processing of the IPU (8 bit grayscale images, rows stored without padding).
+ *
+ * An image is processed by a pipeline of stages: warp (rotate + scale) -> crop -> convolution -> threshold ->
+ * histogram. The output is computed in tiles of rows which are distributed over a pool of host threads, all stages are
+ * applied to a tile before the next one is started (a convolution recomputes the warped rows around its tile).
+ *
+ * The source position of every warped pixel is given by an affine map, which is stepped incrementally in 16.16 fixed
+ * point along a row. The warp kernels have an AVX2 variant (selected at runtime), which produces exactly the same
+ * results as the scalar kernels. The convolution is computed per kernel tap over whole rows, which the compiler
+ * vectorizes.
+ *
+ * Source images have to be readable up to IMAGE_PADDING bytes after the last pixel (the AVX2 kernels load 32 bit
+ * words per pixel).
+ */
+
+namespace ipu {
+
+constexpr unsigned IMAGE_PADDING = 4;
+
+struct Image {
+	const uint8_t *data;
+	unsigned width;
+	unsigned height;
+};
+
+enum Filter : uint32_t {
+	NEAREST = 0,
+	BILINEAR = 1,
+};
+
+/* source position (x, y) of the output pixel (u, v): x = xu * u + xv * v + x0, y = yu * u + yv * v + y0 */
+struct AffineMap {
+	double xu, xv, x0;
+	double yu, yv, y0;
+
+	/* bounding box of a src_width x src_height image rotated by deg degrees */
+	static void rotated_size(unsigned src_width, unsigned src_height, uint32_t deg, unsigned &width, unsigned &height);
+
+	/* rotation by deg degrees about the image center, the bounding box of the rotated image is scaled to the output */
+	static AffineMap rotate_scale(unsigned src_width, unsigned src_height, uint32_t deg, unsigned dst_width,
+	                              unsigned dst_height);
+};
+
+enum Convolution : uint32_t {
+	CONV_NONE = 0,
+	GAUSSIAN_3X3 = 1,
+	GAUSSIAN_5X5 = 2,
+	SOBEL_X = 3,          // |gx|
+	SOBEL_Y = 4,          // |gy|
+	SOBEL_MAGNITUDE = 5,  // |gx| + |gy|
+	CUSTOM_3X3 = 6,
+	CUSTOM_5X5 = 7,
+	NUM_CONVOLUTIONS
+};
+
+struct Pipeline {
+	/* warp: source position of the warped pixels */
+	AffineMap map = {};
+	Filter filter = NEAREST;
+
+	/* crop: output window of the warped image */
+	unsigned crop_x = 0;
+	unsigned crop_y = 0;
+	unsigned width = 0;
+	unsigned height = 0;
+
+	/* convolution with replicated borders, custom kernels: (sum of coeff * pixel) >> shift (row major coefficients,
+	 * 3x3 kernels use the first 9), results are clamped to 0..255 */
+	Convolution conv = CONV_NONE;
+	int16_t coeff[25] = {};
+	unsigned shift = 0;
+
+	/* threshold: pixels >= high -> 255, pixels >= low -> 128, others -> 0 */
+	bool threshold = false;
+	uint8_t low = 0;
+	uint8_t high = 0;
+
+	/* histogram of the output pixels (256 bins) */
+	uint32_t *histogram = nullptr;
+};
+
+/* computes fn(i) for all i in [0, n) on the worker threads and the calling thread */
+class WorkerPool {
+   public:
+	/* threads == 0: one worker per additional host cpu */
+	explicit WorkerPool(unsigned threads = 0);
+	~WorkerPool(void);
+
+	void run(unsigned n, const std::function<void(unsigned)> &fn);
+
+   private:
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable start_cond;
+	std::condition_variable done_cond;
+	const std::function<void(unsigned)> *job = nullptr;
+	unsigned num_items = 0;
+	std::atomic<unsigned> next_item{0};
+	unsigned active = 0;
+	uint64_t generation = 0;
+	bool stop = false;
+
+	void work(void);
+	void drain(void);
+};
+
+class ImageEngine {
+   public:
+	static constexpr unsigned TILE_ROWS = 32;
+
+	explicit ImageEngine(unsigned threads = 0) : pool(threads) {}
+
+	/* dst: p.width x p.height output image, pixels mapped outside of src are black */
+	void process(const Image &src, uint8_t *dst, const Pipeline &p);
+
+	/* single row of warp starting at the 16.16 fixed point source position (x, y) */
+	static void warp_row(const Image &src, uint8_t *dst, unsigned n, int32_t x, int32_t y, int32_t dx, int32_t dy,
+	                     Filter filter);
+
+   private:
+	WorkerPool pool;
+	std::mutex histogram_mutex;
+
+	void process_tile(const Image &src, uint8_t *dst, const Pipeline &p, unsigned tile);
+};
+
+}  // namespace ipu
+
+#endif  // RISCV_VP_IPU_ENGINE_H
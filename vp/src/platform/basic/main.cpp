@@ -22,6 +22,7 @@
 #include "memory.h"
 #include "memory_mapped_file.h"
 #include "net_trace.h"
+#include "platform/common/instrumentation.h"
 #include "platform/common/options.h"
 #include "platform/common/terminal.h"
 #include "sensor.h"
@@ -43,6 +44,7 @@ class BasicOptions : public Options {
 	std::string flash_device;
 	std::string network_device;
 	std::string test_signature;
+	std::string camera_video;
 
 	addr_t mem_size = 1024 * 1024 * 32;  // 32 MB ram, to place it before the CLINT and run the base examples (assume
 	                                     // memory start at zero) without modifications
@@ -95,7 +97,8 @@ class BasicOptions : public Options {
 			("mram-image-size", po::value<unsigned int>(&mram_size), "MRAM image size")
 			("flash-device", po::value<std::string>(&flash_device)->default_value(""),"blockdevice for flash emulation")
 			("network-device", po::value<std::string>(&network_device)->default_value(""),"name of the tap network adapter, e.g. /dev/tap6")
-			("signature", po::value<std::string>(&test_signature)->default_value(""),"output filename for the test execution signature");
+			("signature", po::value<std::string>(&test_signature)->default_value(""),"output filename for the test execution signature")
+			("camera-video", po::value<std::string>(&camera_video)->default_value(""),"raw (8 bit grayscale) or Y4M video file for the camera");
 		// clang-format on
 	};
 
@@ -139,7 +142,7 @@ int sc_main(int argc, char **argv) {
 	CLINT<1> clint("CLINT");
 	SimpleSensor sensor("SimpleSensor", 2);
 	//SimpleSensor2 sensor2("SimpleSensor2", 5);
-	CannyCamera camera("CannyCamera", 5);
+	CannyCamera camera("CannyCamera", 5, opt.camera_video);
 	BasicTimer timer("BasicTimer", 3);
 	MemoryMappedFile mram("MRAM", opt.mram_image, opt.mram_size);
 	SimpleDMA dma("SimpleDMA", 4);
@@ -165,8 +168,25 @@ int sc_main(int argc, char **argv) {
 	data_memory_if *data_mem_if = &iss_mem_if;
 	if (opt.use_instr_dmi)
 		instr_mem_if = &instr_mem;
+	/*
+	 * image buffers of the camera, display and IPU can be accessed by software and DMA without transactions, the camera
+	 * buffers are read-only (written by the camera only)
+	 */
+	std::vector<MemoryDMI> device_dmi = {
+	    MemoryDMI::create_read_only_start_size_mapping(camera.frame_buffer, opt.camera_start_addr,
+	                                                   CAM_FRAME_BUFFER_SIZE),
+	    MemoryDMI::create_start_size_mapping(display.frame.raw + Display::dmiStart,
+	                                         opt.display_start_addr + Display::dmiStart,
+	                                         Display::addressRange - Display::dmiStart),
+	    MemoryDMI::create_start_size_mapping(ipu.get_frame_buffer(), opt.ipu_start_addr, IPU_FRAME_BUFFER_SIZE)};
+#ifdef ENABLE_HARDWARE_BLUR_BUFFER
+	device_dmi.push_back(MemoryDMI::create_read_only_start_size_mapping(
+	    reinterpret_cast<uint8_t *>(camera.blur_buffer), opt.camera_start_addr + CAM_BLUR_BUFFER_ADDR,
+	    CAM_BLUR_BUFFER_SIZE));
+#endif
 	if (opt.use_data_dmi) {
 		iss_mem_if.dmi_ranges.emplace_back(dmi);
+		for (auto &d : device_dmi) iss_mem_if.dmi_ranges.emplace_back(d);
 	}
 
 	uint64_t entry_point = loader.get_entrypoint();
@@ -223,6 +243,9 @@ int sc_main(int argc, char **argv) {
 	dma_connector.isock.bind(bus.tsocks[1]);
 	dma.isock.bind(dma_connector.tsock);
 	dma_connector.bus_lock = bus_lock;
+	dma.bus_lock = bus_lock;
+	dma.add_dma_range(dmi);
+	for (auto &d : device_dmi) dma.add_dma_range(d);
 
 	{
 		unsigned it = 0;
@@ -259,6 +282,13 @@ int sc_main(int argc, char **argv) {
 	threads.push_back(&core);
 
 	core.enable_trace(opt.trace_mode);  // switch for printing instructions
+
+	Instrumentation instrumentation(opt);
+	instrumentation.add_program(loader);
+	instrumentation.add_core(core, iss_mem_if);
+	instrumentation.add_bus(bus);
+	instrumentation.start();
+
 	if (opt.use_debug_runner) {
 		auto server = new GDBServer("GDBServer", threads, &dbg_if, opt.debug_port);
 		new GDBServerRunner("GDBRunner", server, &core);
@@ -269,6 +299,7 @@ int sc_main(int argc, char **argv) {
 	if (opt.quiet)
 		sc_core::sc_report_handler::set_verbosity_level(sc_core::SC_NONE);
 	sc_core::sc_start();
+	instrumentation.finish();
 	if (!opt.quiet)
 		core.show();
 
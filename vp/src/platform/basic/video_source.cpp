@@ -0,0 +1,128 @@
+#include "video_source.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+static const char Y4M_MAGIC[] = "YUV4MPEG2 ";
+static const char Y4M_FRAME[] = "FRAME";
+
+VideoSource::VideoSource(const std::string &path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		throw std::system_error(errno, std::generic_category(), "unable to open video file \"" + path + "\"");
+
+	struct stat st;
+	if (fstat(fd, &st) == -1) {
+		close(fd);
+		throw std::system_error(errno, std::generic_category(), "unable to stat video file \"" + path + "\"");
+	}
+	size = st.st_size;
+
+	if (size > 0) {
+		void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p == MAP_FAILED) {
+			close(fd);
+			throw std::runtime_error("unable to map video file \"" + path + "\"");
+		}
+		/* frames are consumed in order */
+		madvise(p, size, MADV_SEQUENTIAL);
+		data = static_cast<const uint8_t *>(p);
+	}
+	close(fd);
+
+	if (size >= sizeof(Y4M_MAGIC) - 1 && !memcmp(data, Y4M_MAGIC, sizeof(Y4M_MAGIC) - 1))
+		parse_y4m(path);
+}
+
+VideoSource::~VideoSource(void) {
+	if (data)
+		munmap(const_cast<uint8_t *>(data), size);
+}
+
+void VideoSource::parse_y4m(const std::string &path) {
+	const uint8_t *end = data + size;
+	const uint8_t *eol = std::find(data, end, '\n');
+	if (eol == end)
+		throw std::runtime_error("invalid Y4M header in \"" + path + "\"");
+
+	std::string colorspace = "420";
+	std::istringstream header(std::string(data + sizeof(Y4M_MAGIC) - 1, eol));
+	std::string param;
+	while (header >> param) {
+		if (param[0] == 'W')
+			frame_width = std::stoul(param.substr(1));
+		else if (param[0] == 'H')
+			frame_height = std::stoul(param.substr(1));
+		else if (param[0] == 'C')
+			colorspace = param.substr(1);
+	}
+	if (frame_width == 0 || frame_height == 0)
+		throw std::runtime_error("Y4M file \"" + path + "\" doesn't specify the frame size");
+
+	size_t luma = (size_t)frame_width * frame_height;
+	size_t chroma;
+	if (colorspace.compare(0, 4, "mono") == 0)
+		chroma = 0;
+	else if (colorspace.compare(0, 8, "444alpha") == 0)
+		chroma = 3 * luma;
+	else if (colorspace.compare(0, 3, "444") == 0)
+		chroma = 2 * luma;
+	else if (colorspace.compare(0, 3, "422") == 0)
+		chroma = 2 * (size_t)((frame_width + 1) / 2) * frame_height;
+	else if (colorspace.compare(0, 3, "411") == 0)
+		chroma = 2 * (size_t)((frame_width + 3) / 4) * frame_height;
+	else if (colorspace.compare(0, 3, "420") == 0)
+		chroma = 2 * (size_t)((frame_width + 1) / 2) * ((frame_height + 1) / 2);
+	else
+		throw std::runtime_error("unsupported Y4M colorspace " + colorspace + " in \"" + path + "\"");
+
+	/* every frame: "FRAME" [parameters] '\n' planes */
+	const uint8_t *p = eol + 1;
+	while ((size_t)(end - p) >= sizeof(Y4M_FRAME) - 1 && !memcmp(p, Y4M_FRAME, sizeof(Y4M_FRAME) - 1)) {
+		eol = std::find(p, end, '\n');
+		if (eol == end || (size_t)(end - eol - 1) < luma + chroma)
+			break;  // truncated frame
+		frame_offsets.push_back(eol + 1 - data);
+		p = eol + 1 + luma + chroma;
+	}
+	y4m = true;
+}
+
+bool VideoSource::read_frame(unsigned n, uint8_t *dst, unsigned width, unsigned height) {
+	const uint8_t *frame;
+	unsigned fw = width, fh = height;
+
+	if (y4m) {
+		if (frame_offsets.empty())
+			return false;
+		frame = data + frame_offsets[n % frame_offsets.size()];
+		fw = frame_width;
+		fh = frame_height;
+	} else {
+		size_t frame_size = (size_t)width * height;
+		if (frame_size == 0 || size < frame_size)
+			return false;
+		frame = data + (n % (size / frame_size)) * frame_size;
+	}
+
+	if (fw == width && fh == height) {
+		memcpy(dst, frame, (size_t)width * height);
+		return true;
+	}
+
+	unsigned w = std::min(fw, width), h = std::min(fh, height);
+	for (unsigned r = 0; r < h; r++) {
+		memcpy(dst + (size_t)r * width, frame + (size_t)r * fw, w);
+		memset(dst + (size_t)r * width + w, 0, width - w);
+	}
+	memset(dst + (size_t)h * width, 0, (size_t)(height - h) * width);
+	return true;
+}
@@ -0,0 +1,49 @@
+#ifndef RISCV_VP_VIDEO_SOURCE_H
+#define RISCV_VP_VIDEO_SOURCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+/*
+ * Memory mapped video file providing 8 bit grayscale frames:
+ *  - YUV4MPEG2 (*.y4m): the luma plane of every frame is used, chroma planes are skipped
+ *  - everything else: raw frames of the requested size without any header
+ *
+ * Frames are copied straight from the mapping, the file is never decoded or read as a whole.
+ */
+class VideoSource {
+   public:
+	explicit VideoSource(const std::string &path);
+	~VideoSource(void);
+
+	VideoSource(const VideoSource &) = delete;
+	VideoSource &operator=(const VideoSource &) = delete;
+
+	/* copies frame n (wraps around at the end of the file) into the width x height image dst, frames of a different
+	 * size are cropped/padded with black. Returns false if the file doesn't contain a single frame. */
+	bool read_frame(unsigned n, uint8_t *dst, unsigned width, unsigned height);
+
+	/* frame size of Y4M files (0 for raw files) */
+	unsigned get_width(void) const {
+		return frame_width;
+	}
+	unsigned get_height(void) const {
+		return frame_height;
+	}
+
+   private:
+	const uint8_t *data = nullptr;
+	size_t size = 0;
+
+	bool y4m = false;
+	unsigned frame_width = 0;
+	unsigned frame_height = 0;
+	std::vector<size_t> frame_offsets;  // start of the luma planes (Y4M)
+
+	void parse_y4m(const std::string &path);
+};
+
+#endif  // RISCV_VP_VIDEO_SOURCE_H
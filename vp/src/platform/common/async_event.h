@@ -27,6 +27,8 @@
 #pragma once
 #include <systemc>
 
+#include "core/common/idle_detector.h"
+
 class AsyncEvent : public sc_core::sc_prim_channel {
 	sc_core::sc_time m_delay;
 	sc_core::sc_event m_event;
@@ -43,6 +45,8 @@ class AsyncEvent : public sc_core::sc_prim_channel {
 	void notify(sc_core::sc_time delay = sc_core::SC_ZERO_TIME) {
 		m_delay = delay;
 		async_request_update();
+		// wake up the simulation in case it is blocked while all harts are idle
+		IdleDetector::instance().notify_host_input();
 	}
 
 	// only allow waiting for the event
@@ -11,6 +11,8 @@
 #include <stdexcept>
 #include <systemc>
 
+#include "bus_stats.h"
+#include "core/common/host_profiler.h"
 #include "net_trace.h"
 #include "util/initator_ext.h"
 
@@ -47,6 +49,8 @@ struct SimpleBus : sc_core::sc_module {
 
 	NetTrace *debug_bus;
 	bool break_on_transaction;
+	BusStats *stats = nullptr;  // optional, set while the statistics are enabled
+	std::array<HostProfiler::Section *, NR_OF_TARGETS> target_profiles{};  // set if the host profiler is enabled
 
 	SimpleBus(sc_core::sc_module_name, NetTrace *debug_bus, bool trans_break)
 	    : debug_bus(debug_bus), break_on_transaction(trans_break) {
@@ -76,6 +80,14 @@ struct SimpleBus : sc_core::sc_module {
 		}
 	}
 
+	void end_of_elaboration() override {
+		auto &profiler = HostProfiler::instance();
+		if (!profiler.is_enabled())
+			return;
+		for (unsigned i = 0; i < NR_OF_TARGETS; ++i)
+			target_profiles[i] = profiler.get_section(std::string(ports[i]->module.name()) + ".b_transport");
+	}
+
 	static inline initiator_if *get_tlm_initiator(tlm::tlm_generic_payload &trans) {
 		auto init_ext = trans.get_extension<initiator_ext>();
 		if (init_ext != nullptr) {
@@ -102,7 +114,14 @@ struct SimpleBus : sc_core::sc_module {
 		}
 
 		trans.set_address(ports[id]->global_to_local(addr));
-		isocks[id]->b_transport(trans, delay);
+		sc_core::sc_time start_delay = delay;
+		{
+			HostProfiler::Scope scope(target_profiles[id]);
+			isocks[id]->b_transport(trans, delay);
+		}
+
+		if (stats != nullptr)
+			stats->record(get_tlm_initiator(trans), id, trans.is_read(), trans.get_data_length(), delay - start_delay);
 
 		if (debug_bus != nullptr) {
 			std::string init_name = "UNKNOWN";
@@ -148,6 +167,9 @@ struct PeripheralWriteConnector : sc_core::sc_module {
 	void transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
 		bus_lock->wait_until_unlocked();
 
+		if (trans.is_write())
+			bus_lock->snoop_store(trans.get_address(), trans.get_data_length());
+
 		isock->b_transport(trans, delay);
 
 		if (trans.get_response_status() == tlm::TLM_ADDRESS_ERROR_RESPONSE)
@@ -160,6 +182,9 @@ class BusLock : public bus_lock_if {
 	unsigned owner = 0;
 	sc_core::sc_event lock_event;
 
+	static constexpr uint64_t RESERVATION_GRANULE = 8;
+	std::map<unsigned, uint64_t> reservations;  // hart_id -> start of reserved granule
+
    public:
 	virtual void lock(unsigned hart_id) override {
 		if (locked && (hart_id != owner)) {
@@ -189,6 +214,28 @@ class BusLock : public bus_lock_if {
 	virtual void wait_until_unlocked() override {
 		while (locked) sc_core::wait(lock_event);
 	}
+
+	virtual void set_reservation(unsigned hart_id, uint64_t addr) override {
+		reservations[hart_id] = addr & ~(RESERVATION_GRANULE - 1);
+	}
+
+	virtual bool has_reservation(unsigned hart_id) override {
+		return !reservations.empty() && reservations.count(hart_id);
+	}
+
+	virtual void clear_reservation(unsigned hart_id) override {
+		if (!reservations.empty())
+			reservations.erase(hart_id);
+	}
+
+	virtual void snoop_store(uint64_t addr, unsigned num_bytes) override {
+		for (auto it = reservations.begin(); it != reservations.end();) {
+			if (addr < it->second + RESERVATION_GRANULE && it->second < addr + num_bytes)
+				it = reservations.erase(it);
+			else
+				++it;
+		}
+	}
 };
 
 #endif  // RISCV_ISA_BUS_H
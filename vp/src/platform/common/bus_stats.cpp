@@ -0,0 +1,137 @@
+#include "bus_stats.h"
+
+#include <signal.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <system_error>
+
+static volatile sig_atomic_t toggle_requested = 0;
+
+static void handle_sigusr2(int) {
+	toggle_requested = 1;
+}
+
+BusStats::BusStats(sc_core::sc_module_name, const std::string &path, sc_core::sc_time interval, bool enabled)
+    : path(path), interval(interval), enabled(enabled), ns_value(sc_core::sc_time(1, sc_core::SC_NS).value()) {
+	if (!path.empty()) {
+		report.open(path);
+		if (!report)
+			throw std::system_error(errno, std::generic_category(), "unable to open bus statistics \"" + path + "\"");
+	}
+
+	/* SIGUSR1 is already used by the Timer (and raised by the gd32 CLI server) */
+	struct sigaction sa;
+	sa.sa_handler = handle_sigusr2;
+	sa.sa_flags = SA_RESTART;
+	if (sigemptyset(&sa.sa_mask) == -1 || sigaction(SIGUSR2, &sa, NULL) == -1)
+		throw std::system_error(errno, std::generic_category(), "unable to install the bus statistics signal handler");
+
+	SC_THREAD(run);
+}
+
+unsigned BusStats::add_initiator(initiator_if *initiator) {
+	unsigned index = initiators.size();
+	initiators.push_back(initiator != nullptr ? initiator->name() : "unknown");
+	initiator_index[initiator] = index;
+	counters.emplace_back(targets.size());
+	return index;
+}
+
+void BusStats::set_enabled(bool enabled) {
+	this->enabled = enabled;
+	for (auto &f : attach) f(enabled);
+}
+
+void BusStats::run() {
+	sc_core::sc_time poll(POLL_INTERVAL_NS, sc_core::SC_NS);
+	sc_core::sc_time next_report = interval;
+
+	while (true) {
+		sc_core::wait(interval != sc_core::SC_ZERO_TIME ? std::min(poll, next_report - sc_core::sc_time_stamp())
+		                                                : poll);
+
+		if (toggle_requested) {
+			toggle_requested = 0;
+			set_enabled(!enabled);
+			std::cerr << "[BusStats] collection " << (enabled ? "enabled" : "disabled") << " at "
+			          << sc_core::sc_time_stamp() << std::endl;
+		}
+		if (interval != sc_core::SC_ZERO_TIME && sc_core::sc_time_stamp() >= next_report) {
+			next_report += interval;
+			if (report.is_open())
+				write_report(report, false);
+		}
+	}
+}
+
+void BusStats::write_report(std::ostream &os, bool final) const {
+	os << "{\"time_ns\": " << sc_core::sc_time_stamp().value() / ns_value << ", \"final\": " << std::boolalpha
+	   << final << ", \"enabled\": " << enabled << std::noboolalpha << ", \"transactions\": [";
+	bool first = true;
+	for (unsigned i = 0; i < initiators.size(); ++i) {
+		for (unsigned t = 0; t < targets.size(); ++t) {
+			auto &c = counters[i][t];
+			if (c.reads + c.writes == 0)
+				continue;
+			os << (first ? "" : ", ") << "{\"initiator\": \"" << initiators[i] << "\", \"target\": \"" << targets[t]
+			   << "\", \"reads\": " << c.reads << ", \"writes\": " << c.writes << ", \"read_bytes\": " << c.read_bytes
+			   << ", \"write_bytes\": " << c.write_bytes << ", \"delay_ns\": " << c.delay_ns
+			   << ", \"delay_histogram\": [";
+			for (unsigned b = 0; b < NUM_BUCKETS; ++b) os << (b ? ", " : "") << c.histogram[b];
+			os << "]}";
+			first = false;
+		}
+	}
+	os << "], \"memory_interfaces\": [";
+	for (unsigned i = 0; i < memory_interfaces.size(); ++i) {
+		auto &m = *memory_interfaces[i];
+		os << (i ? ", " : "") << "{\"name\": \"" << m.name << "\", \"dmi_loads\": " << m.stats.dmi_loads
+		   << ", \"dmi_stores\": " << m.stats.dmi_stores << ", \"tlm_loads\": " << m.stats.tlm_loads
+		   << ", \"tlm_stores\": " << m.stats.tlm_stores << "}";
+	}
+	os << "]}" << std::endl;
+}
+
+void BusStats::finish() {
+	if (report.is_open())
+		write_report(report, true);
+}
+
+void BusStats::show(std::ostream &os) const {
+	struct Row {
+		unsigned initiator;
+		unsigned target;
+		uint64_t transactions;
+	};
+	std::vector<Row> rows;
+	for (unsigned i = 0; i < initiators.size(); ++i) {
+		for (unsigned t = 0; t < targets.size(); ++t) {
+			uint64_t n = counters[i][t].reads + counters[i][t].writes;
+			if (n)
+				rows.push_back({i, t, n});
+		}
+	}
+	std::sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) { return a.transactions > b.transactions; });
+
+	os << "[BusStats] " << std::left << std::setw(20) << "initiator" << std::setw(24) << "target" << std::right
+	   << std::setw(14) << "reads" << std::setw(14) << "writes" << std::setw(14) << "bytes" << std::setw(18)
+	   << "delay [ns]" << std::setw(12) << "avg [ns]" << std::endl;
+	for (auto &r : rows) {
+		auto &c = counters[r.initiator][r.target];
+		os << "[BusStats] " << std::left << std::setw(20) << initiators[r.initiator] << std::setw(24)
+		   << targets[r.target] << std::right << std::setw(14) << c.reads << std::setw(14) << c.writes
+		   << std::setw(14) << c.read_bytes + c.write_bytes << std::setw(18) << c.delay_ns << std::setw(12)
+		   << c.delay_ns / r.transactions << std::endl;
+	}
+
+	for (auto &m : memory_interfaces) {
+		uint64_t dmi = m->stats.dmi_loads + m->stats.dmi_stores;
+		uint64_t tlm = m->stats.tlm_loads + m->stats.tlm_stores;
+		os << "[BusStats] " << m->name << ": " << dmi << " DMI accesses, " << tlm << " TLM accesses";
+		if (dmi + tlm)
+			os << " (" << std::fixed << std::setprecision(1) << 100.0 * dmi / (dmi + tlm) << "% DMI)"
+			   << std::defaultfloat;
+		os << std::endl;
+	}
+}
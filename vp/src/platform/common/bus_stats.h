@@ -0,0 +1,125 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <systemc>
+#include <unordered_map>
+#include <vector>
+
+#include "core/common/mem_if.h"
+#include "util/initiator_if.h"
+
+/*
+ * Aggregate bus statistics, a cheap alternative to the transaction dump of the debug bus
+ *
+ * SimpleBus::transport counts per initiator and target: transactions (read/write), bytes and the delay annotated by
+ * the target, with a histogram of the annotated delay (bucket i: [2^(i-1), 2^i) ns, bucket 0: no delay). The memory
+ * interfaces of the cores count their DMI and TLM accesses (accesses served by the LSCache do not reach the memory
+ * interface). Together they show which targets keep the cores off the DMI/LSCache fast path and how much simulated
+ * time they cost.
+ *
+ * Reports are JSON objects, one per line, with the counters since the start of the simulation: periodically every
+ * interval of simulated time (if not zero) and a final one (see write_report). show prints a summary.
+ *
+ * Collection can be switched at runtime with SIGUSR2. Disabled statistics are detached from the bus and the memory
+ * interfaces, i.e. there is no overhead except a null pointer check per transaction.
+ */
+class BusStats : public sc_core::sc_module {
+   public:
+	static constexpr unsigned NUM_BUCKETS = 24;
+	/* SIGUSR2 is checked with this period (simulated time) */
+	static constexpr unsigned POLL_INTERVAL_NS = 1000000;
+
+	SC_HAS_PROCESS(BusStats);
+
+	/* path: report file, empty for no reports; interval: period of the reports, zero for the final report only */
+	BusStats(sc_core::sc_module_name, const std::string &path, sc_core::sc_time interval, bool enabled);
+
+	template <typename T_Bus>
+	void add_bus(T_Bus &bus) {
+		for (auto port : bus.ports) targets.push_back(port->module.name());
+		attach.push_back([this, &bus](bool enabled) { bus.stats = enabled ? this : nullptr; });
+		attach.back()(enabled);
+	}
+
+	template <typename T_MemIf>
+	void add_memory_interface(T_MemIf &memif) {
+		memory_interfaces.emplace_back(new MemoryInterface{memif.iss.name(), {}});
+		MemoryAccessStats *stats = &memory_interfaces.back()->stats;
+		attach.push_back([&memif, stats](bool enabled) { memif.access_stats = enabled ? stats : nullptr; });
+		attach.back()(enabled);
+	}
+
+	/* called by the bus for each transaction, delay: annotated by the target */
+	inline void record(initiator_if *initiator, unsigned target, bool is_read, unsigned num_bytes,
+	                   const sc_core::sc_time &delay) {
+		Counters &c = counters[get_initiator_index(initiator)][target];
+		uint64_t ns = delay.value() / ns_value;
+		if (is_read) {
+			c.reads++;
+			c.read_bytes += num_bytes;
+		} else {
+			c.writes++;
+			c.write_bytes += num_bytes;
+		}
+		c.delay_ns += ns;
+
+		unsigned bucket = 0;
+		while (ns != 0 && bucket < NUM_BUCKETS - 1) {
+			ns >>= 1;
+			bucket++;
+		}
+		c.histogram[bucket]++;
+	}
+
+	void set_enabled(bool enabled);
+
+	/* one JSON object (single line) */
+	void write_report(std::ostream &os, bool final) const;
+	/* final report to the report file, if any */
+	void finish();
+	void show(std::ostream &os = std::cout) const;
+
+   private:
+	struct Counters {
+		uint64_t reads = 0;
+		uint64_t writes = 0;
+		uint64_t read_bytes = 0;
+		uint64_t write_bytes = 0;
+		uint64_t delay_ns = 0;
+		uint64_t histogram[NUM_BUCKETS] = {};
+	};
+
+	struct MemoryInterface {
+		std::string name;
+		MemoryAccessStats stats;
+	};
+
+	std::string path;
+	std::ofstream report;
+	sc_core::sc_time interval;
+	bool enabled;
+	uint64_t ns_value;
+
+	std::vector<std::string> targets;
+	std::vector<std::string> initiators;
+	std::unordered_map<initiator_if *, unsigned> initiator_index;
+	std::vector<std::vector<Counters>> counters;  // [initiator][target]
+	std::vector<std::unique_ptr<MemoryInterface>> memory_interfaces;
+	std::vector<std::function<void(bool enabled)>> attach;
+
+	inline unsigned get_initiator_index(initiator_if *initiator) {
+		auto it = initiator_index.find(initiator);
+		if (it != initiator_index.end())
+			return it->second;
+		return add_initiator(initiator);
+	}
+
+	unsigned add_initiator(initiator_if *initiator);
+	void run();
+};
@@ -27,6 +27,7 @@ FD_ABSTRACT_UART::~FD_ABSTRACT_UART(void) {
 }
 
 void FD_ABSTRACT_UART::start_threads(int fd, bool write_only) {
+	stop = false;
 	fds[0] = newpollfd(stop_fd);
 	fds[1] = newpollfd(fd);
 
@@ -42,6 +43,7 @@ void FD_ABSTRACT_UART::stop_threads(void) {
 		spost(&txfull);  // unblock transmit thread
 		txthr->join();
 		delete txthr;
+		txthr = NULL;
 	}
 
 	if (rcvthr) {
@@ -51,7 +53,21 @@ void FD_ABSTRACT_UART::stop_threads(void) {
 		spost(&rxempty);  // unblock receive thread
 		rcvthr->join();
 		delete rcvthr;
+		rcvthr = NULL;
+
+		// drain stop pipe (the receive thread does not consume the byte)
+		if (read(stop_pipe[0], &byte, sizeof(byte)) == -1)
+			err(EXIT_FAILURE, "couldn't drain uart stop pipe");
 	}
+
+	/*
+	 * The unblocking posts above are not necessarily consumed by the threads
+	 * -> re-synchronize semaphores with the fifo levels to allow restarting the threads
+	 */
+	sem_destroy(&txfull);
+	sem_destroy(&rxempty);
+	if (sem_init(&txfull, 0, tx_fifo.size()) || sem_init(&rxempty, 0, UART_FIFO_DEPTH - rx_fifo.size()))
+		throw std::system_error(errno, std::generic_category());
 }
 
 void FD_ABSTRACT_UART::transmit(void) {
@@ -81,8 +97,10 @@ void FD_ABSTRACT_UART::receive(void) {
 			} else if (ev & POLLIN) {
 				if (fd == stop_fd)
 					break;
-				else
-					handle_input(fd);
+				else if (!handle_input(fd))
+					return;  // end of input, the transmit thread keeps running
+			} else if (ev & POLLHUP) {
+				return;  // writing side closed without pending data
 			}
 		}
 	}
@@ -20,7 +20,8 @@ class FD_ABSTRACT_UART : public UART_IF {
 
    private:
 	virtual void write_data(uint8_t) = 0;
-	virtual void handle_input(int fd) = 0;
+	/* returns false at the end of the input (e.g. the peer closed its write side) */
+	virtual bool handle_input(int fd) = 0;
 
 	void transmit();
 	void receive();
@@ -1,12 +1,13 @@
 #pragma once
 
+#include <stddef.h>
 #include <tlm_utils/simple_target_socket.h>
 
 #include <systemc>
 
+#include "core/common/host_profiler.h"
 #include "core/common/irq_if.h"
-#include "util/memory_map.h"
-#include "util/tlm_map.h"
+#include "util/register_map.h"
 
 static constexpr bool trace_mode = false;
 
@@ -22,6 +23,9 @@ struct FE310_PLIC : public sc_core::sc_module, public interrupt_gateway {
 	static constexpr unsigned WORDS_FOR_INTERRUPT_ENTRIES = NumberInterruptEntries;
 	// this does not work for the snake example
 	// static constexpr unsigned WORDS_FOR_INTERRUPT_ENTRIES = (NumberInterruptEntries+(32))/32;
+	static constexpr unsigned IRQ_WORDS = (NumberInterrupts + 31) / 32;
+	static_assert(IRQ_WORDS <= WORDS_FOR_INTERRUPT_ENTRIES, "out of bound");
+	static_assert(MaxPriority < 63, "out of bound");
 
 	tlm_utils::simple_target_socket<FE310_PLIC> tsock;
 
@@ -30,28 +34,27 @@ struct FE310_PLIC : public sc_core::sc_module, public interrupt_gateway {
 	// shared for all harts priority 1 is the lowest. Zero means do not interrupt
 	// NOTE: addressing starts at 0x4 because interrupt 0 is reserved, however some example SW still writes to address
 	// 0x0, hence we added it to the address map
-	RegisterRange regs_interrupt_priorities{0x0, sizeof(uint32_t) * (NumberInterrupts + 1)};
-	ArrayView<uint32_t> interrupt_priorities{regs_interrupt_priorities};
+	uint32_t interrupt_priorities[NumberInterrupts + 1] = {};
 
-	RegisterRange regs_pending_interrupts{0x1000, sizeof(uint32_t) * WORDS_FOR_INTERRUPT_ENTRIES};
-	ArrayView<uint32_t> pending_interrupts{regs_pending_interrupts};
+	uint32_t pending_interrupts[WORDS_FOR_INTERRUPT_ENTRIES] = {};
 
 	struct HartConfig {
 		uint32_t priority_threshold;
 		uint32_t claim_response;
 	};
-	RegisterRange regs_hart_enabled_interrupts{0x2000, sizeof(uint32_t) * WORDS_FOR_INTERRUPT_ENTRIES *NumberCores};
-	ArrayView<uint32_t> hart_enabled_interrupts{regs_hart_enabled_interrupts};
+	// all interrupts disabled by default
+	uint32_t hart_enabled_interrupts[NumberCores][WORDS_FOR_INTERRUPT_ENTRIES] = {};
 
-	RegisterRange regs_hart_config{0x200000, sizeof(HartConfig) * NumberCores};
-	ArrayView<HartConfig> hart_config{regs_hart_config};
-
-	std::vector<RegisterRange *> register_ranges{&regs_interrupt_priorities, &regs_pending_interrupts,
-	                                             &regs_hart_enabled_interrupts, &regs_hart_config};
+	HartConfig hart_config[NumberCores] = {};
 
 	PrivilegeLevel irq_level;
 	std::array<bool, NumberCores> hart_eip{};
 
+	// interrupts bucketed by priority (bit i of priority_masks[p] is set if interrupt i has priority p), bit p of
+	// used_priorities is set if bucket p is not empty
+	std::array<std::array<uint32_t, IRQ_WORDS>, MaxPriority + 1> priority_masks{};
+	uint64_t used_priorities = 0;
+
 	sc_core::sc_event e_run;
 	sc_core::sc_time clock_cycle;
 
@@ -61,45 +64,9 @@ struct FE310_PLIC : public sc_core::sc_module, public interrupt_gateway {
 		clock_cycle = sc_core::sc_time(10, sc_core::SC_NS);
 		tsock.register_b_transport(this, &FE310_PLIC::transport);
 
-		regs_pending_interrupts.readonly = true;
-		regs_hart_config.alignment = 4;
-
-		regs_interrupt_priorities.post_write_callback =
-		    std::bind(&FE310_PLIC::post_write_interrupt_priorities, this, std::placeholders::_1);
-		regs_hart_config.post_write_callback =
-		    std::bind(&FE310_PLIC::post_write_hart_config, this, std::placeholders::_1);
-		regs_hart_config.pre_read_callback = std::bind(&FE310_PLIC::pre_read_hart_config, this, std::placeholders::_1);
-
-		if (trace_mode) {
-			regs_hart_enabled_interrupts.post_write_callback = [this](RegisterRange::WriteInfo t) {
-				std::cout << "[vp::plic] Wrote enabled_interrupts at offs +" << std::dec << t.addr << " value 0x"
-				          << std::hex << *reinterpret_cast<uint32_t *>(t.trans.get_data_ptr()) << std::dec << std::endl;
-				for (unsigned n = 0; n < NumberCores; ++n) {
-					for (unsigned i = 0; i < WORDS_FOR_INTERRUPT_ENTRIES; ++i) {
-						const uint32_t itr_group = hart_enabled_interrupts(n, i);
-						if (itr_group) {
-							for (unsigned b = 0; b < 32; b++) {
-								if ((1 << b) & itr_group) {
-									std::cout << "[vp::plic]\t Hart " << n << " ITR " << i * 32 + b << " enabled."
-									          << std::dec << std::endl;
-								}
-							}
-						}
-					}
-				}
-			};
-		}
-
-		for (unsigned i = 0; i < NumberInterrupts; ++i) {
-			interrupt_priorities[i] = 0;
-		}
-
 		for (unsigned n = 0; n < NumberCores; ++n) {
 			target_harts[n] = nullptr;
 			hart_eip[n] = false;
-			for (unsigned i = 0; i < WORDS_FOR_INTERRUPT_ENTRIES; ++i) {
-				hart_enabled_interrupts(n, i) = 0;  // all interrupts disabled by default
-			}
 		}
 
 		irq_level = level;
@@ -132,81 +99,115 @@ struct FE310_PLIC : public sc_core::sc_module, public interrupt_gateway {
 	}
 
 	unsigned hart_get_next_pending_interrupt(unsigned hart_id, bool consider_threshold) {
-		unsigned min_id = 0;
-		unsigned max_priority = 0;
-
-		for (unsigned i = 1; i < NumberInterrupts; ++i) {
-			unsigned idx = i / 32;
-			unsigned off = i % 32;
+		std::array<uint32_t, IRQ_WORDS> candidates;
+		uint32_t any = 0;
 
-			if (hart_enabled_interrupts(hart_id, idx) & (1 << off)) {
-				if (trace_mode)
-					std::cout << "[vp::plic] hart " << hart_id << " has enabled ITR " << i << std::endl;
-				if (pending_interrupts[idx] & (1 << off)) {
-					auto prio = interrupt_priorities[i];
+		for (unsigned idx = 0; idx < IRQ_WORDS; ++idx) {
+			candidates[idx] = hart_enabled_interrupts[hart_id][idx] & pending_interrupts[idx];
+			any |= candidates[idx];
+		}
+		candidates[0] &= ~1u;  // interrupt 0 does not exist
+		if (!any)
+			return 0;
+
+		// priority zero never interrupts, only consider buckets above the threshold
+		uint64_t prios = used_priorities & ~1ull;
+		if (consider_threshold)
+			prios &= ~0ull << (std::min(hart_config[hart_id].priority_threshold, MaxPriority) + 1);
+
+		// highest priority first, within a priority the lowest id wins
+		while (prios) {
+			unsigned prio = 63 - __builtin_clzll(prios);
+			prios &= ~(1ull << prio);
+
+			for (unsigned idx = 0; idx < IRQ_WORDS; ++idx) {
+				uint32_t m = candidates[idx] & priority_masks[prio][idx];
+				if (m) {
+					unsigned id = idx * 32 + __builtin_ctz(m);
 					if (trace_mode)
-						std::cout << "[vp::plic] .. and it is pending with priority " << prio << std::endl;
-					if (prio > 0 && (!consider_threshold || (prio > hart_config[hart_id].priority_threshold))) {
-						if (trace_mode)
-							std::cout << "[vp::plic]   .. which is greater than the hart's threshold of "
-							          << hart_config[hart_id].priority_threshold << std::endl;
-						if (prio > max_priority) {
-							max_priority = prio;
-							min_id = i;
-						}
-					}
+						std::cout << "[vp::plic] hart " << hart_id << " next pending ITR " << id << " with priority "
+						          << prio << std::endl;
+					return id;
 				}
 			}
 		}
 
-		return min_id;
+		return 0;
 	}
 
 	void transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
 		delay += 4 * clock_cycle;
 		// std::cout << "[vp::plic] Writing at 0x" << trans.get_address() << " value 0x" <<
 		// *reinterpret_cast<uint32_t*>(trans.get_data_ptr()) << std::endl;
-		vp::mm::route("FE310_PLIC", register_ranges, trans, delay);
+		register_map::transport("FE310_PLIC", *this, trans, delay);
 	}
 
-	void post_write_interrupt_priorities(RegisterRange::WriteInfo) {
+	void access_interrupt_priorities(const vp::regmap::Access &t) {
+		t.fn();
+		if (!t.write)
+			return;
+
 		if (trace_mode)
 			std::cout << "[vp::plic] wrote ITR priority:" << std::endl;
 		unsigned i = 0;
+		for (auto &m : priority_masks) m.fill(0);
+		used_priorities = 0;
 		for (auto &x : interrupt_priorities) {
 			x = std::min(x, MaxPriority);
 			if (trace_mode)
 				if (x)
 					std::cout << "[vp::plic]\t Prio for ITR nr. " << i << ": " << x << std::endl;
+			if (i > 0 && i < NumberInterrupts) {
+				priority_masks[x][i / 32] |= 1 << (i % 32);
+				used_priorities |= 1ull << x;
+			}
 			i++;
 		}
+		e_run.notify(clock_cycle);
 	}
 
-	bool pre_read_hart_config(RegisterRange::ReadInfo t) {
-		assert(t.addr % 4 == 0);
-		unsigned idx = t.addr / 4;
+	void access_enabled_interrupts(const vp::regmap::Access &t) {
+		t.fn();
+		if (!t.write)
+			return;
 
-		if ((idx % 2) == 1) {
-			// access is directed to claim response register
-			assert(t.size == 4);
-			--idx;
+		e_run.notify(clock_cycle);
+		if (trace_mode) {
+			std::cout << "[vp::plic] Wrote enabled_interrupts at offs +" << std::dec << t.addr - 0x2000 << " value 0x"
+			          << std::hex << t.nv << std::dec << std::endl;
+			for (unsigned n = 0; n < NumberCores; ++n) {
+				for (unsigned i = 0; i < WORDS_FOR_INTERRUPT_ENTRIES; ++i) {
+					const uint32_t itr_group = hart_enabled_interrupts[n][i];
+					if (itr_group) {
+						for (unsigned b = 0; b < 32; b++) {
+							if ((1 << b) & itr_group) {
+								std::cout << "[vp::plic]\t Hart " << n << " ITR " << i * 32 + b << " enabled."
+								          << std::dec << std::endl;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void access_hart_config(const vp::regmap::Access &t) {
+		ensure(t.offset % 4 == 0 && t.len == 4);
+		unsigned idx = t.index;
+		bool claim = t.offset == offsetof(HartConfig, claim_response);
 
-			unsigned min_id = hart_get_next_pending_interrupt(0, false);
+		if (t.read && claim) {
+			unsigned min_id = hart_get_next_pending_interrupt(idx, false);
 			hart_config[idx].claim_response = min_id;
 			clear_pending_interrupt(min_id);
 		}
 
-		return true;
-	}
-
-	void post_write_hart_config(RegisterRange::WriteInfo t) {
-		assert(t.addr % 4 == 0);
-		unsigned idx = t.addr / 4;
+		t.fn();
+		if (!t.write)
+			return;
 
-		if ((idx % 2) == 1) {
+		if (claim) {
 			// access is directed to claim response register
-			assert(t.size == 4);
-			--idx;
 			if (trace_mode)
 				std::cout << "[vp::plic] wrote ITR claim/response" << std::endl;
 
@@ -221,9 +222,10 @@ struct FE310_PLIC : public sc_core::sc_module, public interrupt_gateway {
 					std::cout << "[vp::plic] clear eip" << std::endl;
 			}
 		} else {
+			// a lowered threshold may unmask pending interrupts
+			e_run.notify(clock_cycle);
 			if (trace_mode)
-				std::cout << "[vp::plic] wrote ITR priority threshold 0x" << std::hex
-				          << *reinterpret_cast<uint32_t *>(t.trans.get_data_ptr()) << " for hart " << idx / 2
+				std::cout << "[vp::plic] wrote ITR priority threshold 0x" << std::hex << t.nv << " for hart " << idx
 				          << std::dec << std::endl;
 		}
 	}
@@ -233,8 +235,11 @@ struct FE310_PLIC : public sc_core::sc_module, public interrupt_gateway {
 	}
 
 	void run() {
+		HostProfiler::Section *profile = HostProfiler::instance().get_process_section();
+
 		while (true) {
 			sc_core::wait(e_run);
+			HostProfiler::Scope scope(profile);
 
 			for (unsigned i = 0; i < NumberCores; ++i) {
 				if (!hart_eip[i]) {
@@ -249,4 +254,20 @@ struct FE310_PLIC : public sc_core::sc_module, public interrupt_gateway {
 			}
 		}
 	}
+
+	typedef vp::regmap::RegisterMap<
+	    1,
+	    vp::regmap::Bank<0x0, sizeof(interrupt_priorities),
+	                     vp::regmap::Reg<0x0, &FE310_PLIC::interrupt_priorities,
+	                                     &FE310_PLIC::access_interrupt_priorities>>,
+	    vp::regmap::Bank<0x1000, sizeof(pending_interrupts),
+	                     vp::regmap::Reg<0x1000, &FE310_PLIC::pending_interrupts, nullptr, vp::regmap::RO>>,
+	    vp::regmap::Bank<0x2000, sizeof(hart_enabled_interrupts),
+	                     vp::regmap::RegArray<0x2000, NumberCores, sizeof(hart_enabled_interrupts[0]),
+	                                          &FE310_PLIC::hart_enabled_interrupts,
+	                                          &FE310_PLIC::access_enabled_interrupts>>,
+	    vp::regmap::Bank<0x200000, sizeof(hart_config),
+	                     vp::regmap::RegArray<0x200000, NumberCores, sizeof(HartConfig), &FE310_PLIC::hart_config,
+	                                          &FE310_PLIC::access_hart_config>>>
+	    register_map;
 };
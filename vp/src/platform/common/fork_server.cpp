@@ -0,0 +1,132 @@
+#include "fork_server.h"
+
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+
+#define REAP_INTERVAL_MS 100
+
+ForkServer::ForkServer(const std::string &socket_path, unsigned max_jobs)
+    : socket_path(socket_path), max_jobs(max_jobs) {
+	if (max_jobs == 0)
+		throw std::invalid_argument("fork server requires at least one job");
+}
+
+ForkServer::~ForkServer(void) {
+	if (listen_fd >= 0 && !child) {
+		close(listen_fd);
+		unlink(socket_path.c_str());
+	}
+}
+
+void ForkServer::open_socket(void) {
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (socket_path.size() >= sizeof(addr.sun_path))
+		throw std::invalid_argument("fork server socket path too long: " + socket_path);
+	strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+	listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (listen_fd < 0)
+		throw std::system_error(errno, std::generic_category());
+
+	unlink(socket_path.c_str());
+	if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) || listen(listen_fd, 16))
+		throw std::system_error(errno, std::generic_category());
+}
+
+void ForkServer::reap_jobs(bool block) {
+	int status;
+	pid_t pid;
+
+	while ((pid = waitpid(-1, &status, block ? 0 : WNOHANG)) > 0) {
+		auto it = jobs.find(pid);
+		if (it == jobs.end())
+			continue;
+
+		int code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+		std::string msg = "\n[fork-server] exit " + std::to_string(code) + "\n";
+		if (write(it->second, msg.c_str(), msg.size()) < 0) {
+			/* client already gone -> ignore */
+		}
+		close(it->second);
+		jobs.erase(it);
+
+		block = false;  // reaped one -> do not block for further ones
+	}
+}
+
+void ForkServer::serve(void) {
+	if (child)
+		return;  // fork point reached again in a child -> just continue
+
+	for (auto &fn : before_fork) fn();
+
+	open_socket();
+	/* do not terminate the server (or children) when a client disconnects early */
+	signal(SIGPIPE, SIG_IGN);
+
+	std::cout << "[fork-server] listening on " << socket_path << std::endl;
+
+	while (true) {
+		reap_jobs(jobs.size() >= max_jobs);
+		if (jobs.size() >= max_jobs)
+			continue;
+
+		struct pollfd pfd = {.fd = listen_fd, .events = POLLIN, .revents = 0};
+		int ret = poll(&pfd, 1, REAP_INTERVAL_MS);
+		if (ret < 0 && errno != EINTR)
+			throw std::system_error(errno, std::generic_category());
+		if (ret <= 0)
+			continue;
+
+		int conn = accept(listen_fd, nullptr, nullptr);
+		if (conn < 0) {
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			throw std::system_error(errno, std::generic_category());
+		}
+
+		/* avoid duplicated output from buffers of the parent */
+		std::cout.flush();
+		std::cerr.flush();
+		fflush(nullptr);
+
+		pid_t pid = fork();
+		if (pid < 0)
+			throw std::system_error(errno, std::generic_category());
+
+		if (pid == 0) {
+			child = true;
+			close(listen_fd);
+			for (auto &e : jobs) close(e.second);
+			jobs.clear();
+
+			if (dup2(conn, STDIN_FILENO) < 0 || dup2(conn, STDOUT_FILENO) < 0)
+				throw std::system_error(errno, std::generic_category());
+			close(conn);
+
+			for (auto &fn : in_child) fn();
+			return;
+		}
+
+		jobs[pid] = conn;
+	}
+}
+
+void ForkServer::exit_child(int code) {
+	std::cout.flush();
+	std::cerr.flush();
+	fflush(nullptr);
+	_exit(code);
+}
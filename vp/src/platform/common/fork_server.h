@@ -0,0 +1,57 @@
+#ifndef RISCV_VP_FORK_SERVER_H
+#define RISCV_VP_FORK_SERVER_H
+
+#include <sys/types.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+ * Fork server
+ *
+ * Allows to run many independent test cases from a single booted state. The guest signals the fork point (see
+ * MiscDev), then serve() turns the VP process into a server listening on a local (unix domain) socket. For every
+ * connection, a child process is forked, which continues the simulation copy-on-write from the fork point with stdin
+ * and stdout redirected to the connection (i.e. everything sent by the client is injected as UART input and the
+ * UART output is sent back). When the child exits (e.g. the guest writes to SIFIVE_Test), the parent sends a final
+ * line "[fork-server] exit <code>" and closes the connection.
+ *
+ * Only the calling thread survives a fork(). Hence, devices using host threads have to be stopped before forking and
+ * restarted in the child using before_fork/in_child (e.g. UART::stop_io/UART::start_io). Devices without such
+ * handlers (e.g. SLIP, VNC) do not work in the children.
+ */
+class ForkServer {
+   public:
+	/* called once in the parent before the first fork */
+	std::vector<std::function<void()>> before_fork;
+	/* called in every child directly after fork */
+	std::vector<std::function<void()>> in_child;
+
+	ForkServer(const std::string &socket_path, unsigned max_jobs = 1);
+	~ForkServer(void);
+
+	/* serve requests (in the parent: never returns, in the child: returns to continue the simulation) */
+	void serve(void);
+
+	bool is_child(void) {
+		return child;
+	}
+
+	/* terminate a child (flush output, but do not run destructors of devices which have been left in the parent) */
+	[[noreturn]] void exit_child(int code);
+
+   private:
+	std::string socket_path;
+	unsigned max_jobs;
+	int listen_fd = -1;
+	bool child = false;
+
+	std::map<pid_t, int> jobs;  // pid -> connection fd
+
+	void open_socket(void);
+	void reap_jobs(bool block);
+};
+
+#endif  // RISCV_VP_FORK_SERVER_H
@@ -40,33 +40,6 @@ enum {
 FU540_GPIO::FU540_GPIO(const sc_core::sc_module_name &, const int *interrupts)
     : GPIO_IF(FU540_N_GPIOS), interrupts(interrupts) {
 	tsock.register_b_transport(this, &FU540_GPIO::transport);
-	router
-	    .add_register_bank({
-	        {REG_RISE_IP, &reg_rise_ip},
-	        {REG_FALL_IP, &reg_fall_ip},
-	        {REG_HIGH_IP, &reg_high_ip},
-	        {REG_LOW_IP, &reg_low_ip},
-	    })
-	    .register_handler(this, &FU540_GPIO::register_update_pending_callback);
-	router
-	    .add_register_bank({
-	        {REG_INPUT_EN, &reg_input_en},
-	        {REG_OUTPUT_EN, &reg_output_en},
-	        {REG_OUTPUT_VAL, &reg_output_val},
-	        {REG_RISE_IE, &reg_rise_ie},
-	        {REG_FALL_IE, &reg_fall_ie},
-	        {REG_HIGH_IE, &reg_high_ie},
-	        {REG_LOW_IE, &reg_low_ie},
-	        {REG_OUT_XOR, &reg_out_xor},
-	    })
-	    .register_handler(this, &FU540_GPIO::register_update_callback);
-	router
-	    .add_register_bank({
-	        {REG_INPUT_VAL, &reg_input_val},
-	        {REG_PUE, &reg_pue},
-	        {REG_DS, &reg_ds},
-	    })
-	    .register_handler(this, &FU540_GPIO::register_update_default_callback);
 }
 
 FU540_GPIO::~FU540_GPIO(void) {}
@@ -147,7 +120,7 @@ void FU540_GPIO::update_gpios(uint32_t gpio_val_last) {
 	reg_input_val = gpio_val & reg_input_en;
 }
 
-void FU540_GPIO::register_update_pending_callback(const vp::map::register_access_t &r) {
+void FU540_GPIO::register_update_pending_callback(const vp::regmap::Access &r) {
 	if (r.write) {
 		/* FU540-C000-V1.0-1.pdf
 		 * pending bit is reset to 0, if 1 is written
@@ -172,15 +145,29 @@ void FU540_GPIO::register_update_pending_callback(const vp::map::register_access
 	}
 }
 
-void FU540_GPIO::register_update_callback(const vp::map::register_access_t &r) {
+void FU540_GPIO::register_update_callback(const vp::regmap::Access &r) {
 	r.fn();
 	update_gpios();
 }
 
-void FU540_GPIO::register_update_default_callback(const vp::map::register_access_t &r) {
-	r.fn();
-}
-
 void FU540_GPIO::transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
-	router.transport(trans, delay);
+	using namespace vp::regmap;
+	typedef RegisterMap<
+	    1, Bank<0x0, REG_OUT_XOR + sizeof(uint32_t), Reg<REG_INPUT_VAL, &FU540_GPIO::reg_input_val>,
+	            Reg<REG_INPUT_EN, &FU540_GPIO::reg_input_en, &FU540_GPIO::register_update_callback>,
+	            Reg<REG_OUTPUT_EN, &FU540_GPIO::reg_output_en, &FU540_GPIO::register_update_callback>,
+	            Reg<REG_OUTPUT_VAL, &FU540_GPIO::reg_output_val, &FU540_GPIO::register_update_callback>,
+	            Reg<REG_PUE, &FU540_GPIO::reg_pue>, Reg<REG_DS, &FU540_GPIO::reg_ds>,
+	            Reg<REG_RISE_IE, &FU540_GPIO::reg_rise_ie, &FU540_GPIO::register_update_callback>,
+	            Reg<REG_RISE_IP, &FU540_GPIO::reg_rise_ip, &FU540_GPIO::register_update_pending_callback>,
+	            Reg<REG_FALL_IE, &FU540_GPIO::reg_fall_ie, &FU540_GPIO::register_update_callback>,
+	            Reg<REG_FALL_IP, &FU540_GPIO::reg_fall_ip, &FU540_GPIO::register_update_pending_callback>,
+	            Reg<REG_HIGH_IE, &FU540_GPIO::reg_high_ie, &FU540_GPIO::register_update_callback>,
+	            Reg<REG_HIGH_IP, &FU540_GPIO::reg_high_ip, &FU540_GPIO::register_update_pending_callback>,
+	            Reg<REG_LOW_IE, &FU540_GPIO::reg_low_ie, &FU540_GPIO::register_update_callback>,
+	            Reg<REG_LOW_IP, &FU540_GPIO::reg_low_ip, &FU540_GPIO::register_update_pending_callback>,
+	            Reg<REG_OUT_XOR, &FU540_GPIO::reg_out_xor, &FU540_GPIO::register_update_callback>>>
+	    register_map;
+
+	register_map::transport("FU540_GPIO", *this, trans, delay);
 }
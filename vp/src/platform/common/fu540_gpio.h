@@ -6,12 +6,13 @@
  */
 
 #include <stdint.h>
+#include <tlm_utils/simple_target_socket.h>
 
 #include <systemc>
 
 #include "core/common/irq_if.h"
 #include "platform/common/gpio_if.h"
-#include "util/tlm_map.h"
+#include "util/register_map.h"
 
 /* fu540 gpio with 16 gpios */
 class FU540_GPIO : public sc_core::sc_module, public GPIO_IF {
@@ -43,9 +44,8 @@ class FU540_GPIO : public sc_core::sc_module, public GPIO_IF {
 		update_gpios(gpio_val);
 	}
 
-	void register_update_pending_callback(const vp::map::register_access_t &);
-	void register_update_callback(const vp::map::register_access_t &);
-	void register_update_default_callback(const vp::map::register_access_t &);
+	void register_update_pending_callback(const vp::regmap::Access &);
+	void register_update_callback(const vp::regmap::Access &);
 	void transport(tlm::tlm_generic_payload &, sc_core::sc_time &);
 
 	uint32_t reg_input_val = 0;
@@ -65,8 +65,6 @@ class FU540_GPIO : public sc_core::sc_module, public GPIO_IF {
 	uint32_t reg_out_xor = 0;
 
 	uint32_t gpio_val = 0;
-
-	vp::map::LocalRouter router = {"FU540_GPIO"};
 };
 
 #endif /* RISCV_VP_FU540_GPIO_H */
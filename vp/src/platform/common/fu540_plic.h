@@ -3,12 +3,11 @@
 #include <stdint.h>
 #include <tlm_utils/simple_target_socket.h>
 
-#include <map>
 #include <systemc>
+#include <vector>
 
 #include "core/common/irq_if.h"
-#include "util/memory_map.h"
-#include "util/tlm_map.h"
+#include "util/register_map.h"
 
 /**
  * This class implements a Platform-Level Interrupt Controller (PLIC) as
@@ -19,6 +18,9 @@ struct FU540_PLIC : public sc_core::sc_module, public interrupt_gateway {
 	static constexpr int NUMIRQ = 53;
 	static constexpr uint32_t MAX_THR = 7;
 	static constexpr uint32_t MAX_PRIO = 7;
+	static constexpr unsigned MAX_HARTS = 8;
+	/* hart 0 only has a m-mode context, all other harts a m-mode and a s-mode context */
+	static constexpr unsigned MAX_CONTEXTS = 2 * MAX_HARTS - 1;
 
 	static constexpr uint32_t ENABLE_BASE = 0x2000;
 	static constexpr uint32_t ENABLE_PER_HART = 0x80;
@@ -35,47 +37,59 @@ struct FU540_PLIC : public sc_core::sc_module, public interrupt_gateway {
 	SC_HAS_PROCESS(FU540_PLIC);
 
    private:
-	class HartConfig {
-	   public:
-		ArrayView<uint32_t> m_mode;
-		ArrayView<uint32_t> s_mode; /* same as m_mode for hart0 */
-
-		HartConfig(RegisterRange &r1, RegisterRange &r2) : m_mode(r1), s_mode(r2) {
-			return;
-		}
-
-		bool is_enabled(unsigned int, PrivilegeLevel);
+	struct ContextRegs {
+		uint32_t threshold;
+		uint32_t claim;
 	};
 
 	sc_core::sc_event e_run;
 	sc_core::sc_time clock_cycle;
 
-	std::vector<RegisterRange *> register_ranges;
-
-	/* hart_id (0..4) → hart_config */
-	typedef std::map<unsigned int, HartConfig *> hartmap;
-	hartmap enabled_irqs;
-	hartmap hart_context;
-
 	/* See Section 10.3 */
-	RegisterRange regs_interrupt_priorities{0x4, sizeof(uint32_t) * NUMIRQ};
-	ArrayView<uint32_t> interrupt_priorities{regs_interrupt_priorities};
+	uint32_t interrupt_priorities[NUMIRQ] = {};
 
 	/* See Section 10.4 */
-	RegisterRange regs_pending_interrupts{0x1000, sizeof(uint32_t) * 2};
-	ArrayView<uint32_t> pending_interrupts{regs_pending_interrupts};
+	uint32_t pending_interrupts[2] = {};
+
+	/* context → enabled interrupts bitmap, threshold and claim/complete register */
+	uint32_t enabled_irqs[MAX_CONTEXTS][2] = {};
+	ContextRegs hart_context[MAX_CONTEXTS] = {};
+	unsigned num_contexts;
+
+	/* bit irq is set in priority_masks[p] if irq has priority p (irq ids fit into a single 64 bit mask) */
+	static_assert(NUMIRQ < 64, "interrupt bitmaps limited to 64 bit");
+	uint64_t priority_masks[MAX_PRIO + 1] = {};
+
+	/* external interrupt lines currently raised by the PLIC (hart_id → bitmask of 1 << PrivilegeLevel) */
+	std::vector<unsigned> raised_levels;
 
-	void create_registers(void);
-	void create_hart_regs(uint64_t, uint64_t, hartmap &);
 	void transport(tlm::tlm_generic_payload &, sc_core::sc_time &);
-	bool read_hartctx(RegisterRange::ReadInfo, unsigned int, PrivilegeLevel);
-	void write_hartctx(RegisterRange::WriteInfo, unsigned int, PrivilegeLevel);
-	void write_irq_prios(RegisterRange::WriteInfo);
+	void access_irq_prios(const vp::regmap::Access &);
+	void access_pending(const vp::regmap::Access &);
+	void access_enable(const vp::regmap::Access &);
+	void access_hartctx(const vp::regmap::Access &);
 	void run(void);
+	unsigned int get_context(unsigned int, PrivilegeLevel);
 	unsigned int next_pending_irq(unsigned int, PrivilegeLevel, bool);
-	bool has_pending_irq(unsigned int, PrivilegeLevel *);
-	uint32_t get_threshold(unsigned int, PrivilegeLevel);
+	bool has_pending_irq(unsigned int, PrivilegeLevel);
+	void update_hart(unsigned int, PrivilegeLevel);
+	uint64_t get_pending(void);
 	void clear_pending(unsigned int);
-	bool is_pending(unsigned int);
-	bool is_claim_access(uint64_t addr);
+
+	/* only supports "naturally aligned 32-bit memory accesses" */
+	typedef vp::regmap::RegisterMap<
+	    sizeof(uint32_t),
+	    /* The priorities end address, as documented in the FU540-C000
+	     * manual, is incorrect <https://github.com/riscv/opensbi/pull/138> */
+	    vp::regmap::Bank<0x4, sizeof(interrupt_priorities),
+	                     vp::regmap::Reg<0x4, &FU540_PLIC::interrupt_priorities, &FU540_PLIC::access_irq_prios>>,
+	    vp::regmap::Bank<0x1000, sizeof(pending_interrupts),
+	                     vp::regmap::Reg<0x1000, &FU540_PLIC::pending_interrupts, &FU540_PLIC::access_pending>>,
+	    vp::regmap::Bank<ENABLE_BASE, ENABLE_PER_HART * MAX_CONTEXTS,
+	                     vp::regmap::RegArray<ENABLE_BASE, MAX_CONTEXTS, ENABLE_PER_HART, &FU540_PLIC::enabled_irqs,
+	                                          &FU540_PLIC::access_enable>>,
+	    vp::regmap::Bank<CONTEXT_BASE, CONTEXT_PER_HART * MAX_CONTEXTS,
+	                     vp::regmap::RegArray<CONTEXT_BASE, MAX_CONTEXTS, CONTEXT_PER_HART, &FU540_PLIC::hart_context,
+	                                          &FU540_PLIC::access_hartctx>>>
+	    register_map;
 };
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <systemc>
+#include <vector>
+
+#include "bus_stats.h"
+#include "core/common/guest_coverage.h"
+#include "core/common/guest_profiler.h"
+#include "core/common/host_profiler.h"
+#include "core/common/native_routines.h"
+#include "core/common/roi.h"
+#include "options.h"
+
+/*
+ * Guest and host instrumentation of a platform, as configured by the common Options
+ *
+ * Owns the instrumentation features and attaches the enabled ones to the cores and buses of the platform. Disabled
+ * features are not attached, i.e. have no overhead. Features:
+ *  - guest profiler (--profile-out)
+ *  - guest code coverage (--coverage-out)
+ *  - region of interest fast-forward (--roi)
+ *  - native routines (--native-routines)
+ *  - bus statistics (--bus-stats)
+ *  - host time profiler (--host-profile)
+ *
+ * Usage in sc_main: add the program(s), cores and buses, call start before sc_start and finish after it.
+ */
+class Instrumentation {
+   public:
+	Instrumentation(const Options &opt)
+	    : opt(opt), profiler(opt.profile_interval), roi(sc_core::sc_time(opt.tlm_global_quantum, sc_core::SC_NS)) {
+		if (opt.native_routines) {
+			for (auto &r : opt.native_routine) native_routines.add_spec(r);
+			native_routines.cost_base = opt.native_cost_base;
+			native_routines.cost_per_byte = opt.native_cost_per_byte;
+		}
+		if (opt.bus_stats)
+			bus_stats.reset(new BusStats("BusStats", opt.bus_stats_out,
+			                             sc_core::sc_time(opt.bus_stats_interval, sc_core::SC_NS),
+			                             !opt.bus_stats_paused));
+	}
+
+	/* the main program, also loads the additional ELF files of the options (--profile-elf, --coverage-elf) */
+	template <typename T_ElfLoader>
+	void add_program(T_ElfLoader &elf) {
+		add_elf(elf);
+		if (!opt.profile_out.empty())
+			for (auto &f : opt.profile_elf) profiler.add_symbol_file<T_ElfLoader>(f);
+		if (!opt.coverage_out.empty())
+			for (auto &f : opt.coverage_elf) coverage.add_elf_file<T_ElfLoader>(f);
+	}
+
+	/* symbols of a further guest image, e.g. a kernel */
+	template <typename T_ElfLoader>
+	void add_elf(T_ElfLoader &elf, uint64_t bias = 0) {
+		if (!opt.profile_out.empty())
+			profiler.add_symbols(elf, bias);
+		if (!opt.coverage_out.empty())
+			coverage.add_elf(elf, bias);
+		if (opt.native_routines)
+			native_routines.add_elf(elf, bias);
+	}
+
+	template <typename T_ISS, typename T_MemIf>
+	void add_core(T_ISS &core, T_MemIf &memif) {
+		if (!opt.profile_out.empty())
+			core.profiler = &profiler;
+		if (!opt.coverage_out.empty()) {
+			core.dbbcache.set_coverage(&coverage);
+			collect_coverage.push_back([&core]() { core.dbbcache.collect_coverage(); });
+		}
+		if (opt.native_routines)
+			core.native_routines = &native_routines;
+		if (opt.roi)
+			roi.add_core(core, memif, opt.trace_mode, opt.roi_use_lscache, opt.roi_use_data_dmi);
+		if (bus_stats)
+			bus_stats->add_memory_interface(memif);
+	}
+
+	/* call after the debug bus of the bus was set up */
+	template <typename T_Bus>
+	void add_bus(T_Bus &bus) {
+		if (opt.roi)
+			roi.add_bus(bus);
+		if (bus_stats)
+			bus_stats->add_bus(bus);
+	}
+
+	/* call after all cores and buses were added */
+	void start() {
+		if (opt.roi)
+			roi.fast_forward();
+		if (opt.host_profile)
+			HostProfiler::instance().enable();
+	}
+
+	/* write the reports, call after sc_start */
+	void finish() {
+		if (!opt.profile_out.empty())
+			profiler.write(opt.profile_out);
+		if (!opt.coverage_out.empty()) {
+			for (auto &collect : collect_coverage) collect();
+			coverage.write(opt.coverage_out);
+		}
+		if (opt.native_routines)
+			native_routines.show();
+		if (bus_stats) {
+			bus_stats->finish();
+			bus_stats->show();
+		}
+		HostProfiler::instance().show();
+	}
+
+   private:
+	const Options &opt;
+	GuestProfiler profiler;
+	GuestCoverage coverage;
+	NativeRoutines native_routines;
+	RegionOfInterest roi;
+	std::unique_ptr<BusStats> bus_stats;
+	std::vector<std::function<void()>> collect_coverage;
+};
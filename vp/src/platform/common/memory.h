@@ -1,33 +1,56 @@
 #ifndef RISCV_ISA_MEMORY_H
 #define RISCV_ISA_MEMORY_H
 
+#include <fcntl.h>
 #include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <tlm_utils/simple_target_socket.h>
+#include <unistd.h>
 
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
 #include <systemc>
 
 #include "bus.h"
 #include "load_if.h"
 
+/*
+ * The memory is allocated with an anonymous mmap and MAP_NORESERVE, i.e. host pages are only committed (and zeroed by
+ * the host kernel) when the guest touches them. Large memories are additionally advised to be backed by transparent
+ * huge pages.
+ */
 struct SimpleMemory : public sc_core::sc_module, public load_if {
 	tlm_utils::simple_target_socket<SimpleMemory> tsock;
 
 	uint8_t *data;
-	uint32_t size;
+	uint64_t size;
 	bool read_only;
 
-	SimpleMemory(sc_core::sc_module_name, uint32_t size, bool read_only = false)
-	    : data(new uint8_t[size]()), size(size), read_only(read_only) {
+	SimpleMemory(sc_core::sc_module_name, uint64_t size, bool read_only = false)
+	    : data(allocate(size)), size(size), read_only(read_only) {
 		tsock.register_b_transport(this, &SimpleMemory::transport);
 		tsock.register_get_direct_mem_ptr(this, &SimpleMemory::get_direct_mem_ptr);
 		tsock.register_transport_dbg(this, &SimpleMemory::transport_dbg);
 	}
 
 	~SimpleMemory(void) {
-		delete[] data;
+		munmap(data, size);
+	}
+
+	static uint8_t *allocate(uint64_t size) {
+		assert(size > 0);
+		void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		if (p == MAP_FAILED)
+			throw std::runtime_error("unable to allocate " + std::to_string(size) + " bytes of memory");
+#ifdef MADV_HUGEPAGE
+		static constexpr uint64_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+		if (size >= HUGE_PAGE_SIZE)
+			madvise(p, size, MADV_HUGEPAGE);  // only a hint, failure is not critical
+#endif
+		return (uint8_t *)p;
 	}
 
 	void load_data(const char *src, uint64_t dst_addr, size_t n) override {
@@ -40,7 +63,7 @@ struct SimpleMemory : public sc_core::sc_module, public load_if {
 		memset(&data[dst_addr], 0, n);
 	}
 
-	void load_binary_file(const std::string &filename, unsigned addr) {
+	void load_binary_file(const std::string &filename, uint64_t addr) {
 		/*
 		 * check, if file exists, is readable and don't has zero size
 		 * (prevent segfault on mapped_source_file)
@@ -58,13 +81,41 @@ struct SimpleMemory : public sc_core::sc_module, public load_if {
 		write_data(addr, (const uint8_t *)mf.data(), mf.size());
 	}
 
-	void write_data(unsigned addr, const uint8_t *src, unsigned num_bytes) {
+	/*
+	 * Map a file copy-on-write into the memory at addr (instead of copying it). The file is only read from the host
+	 * page cache when the guest touches a page, and guest writes do not modify the file.
+	 * Falls back to load_binary_file if addr is not aligned to the host page size.
+	 */
+	void map_binary_file(const std::string &filename, uint64_t addr) {
+		uint64_t page_size = sysconf(_SC_PAGESIZE);
+		if (addr % page_size) {
+			load_binary_file(filename, addr);
+			return;
+		}
+
+		int fd = open(filename.c_str(), O_RDONLY);
+		struct stat st;
+		if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+			std::cerr << name() << ": ERROR: Open: \"" << filename << "\"!" << std::endl;
+			assert(0);
+		}
+		uint64_t file_size = st.st_size;
+		assert(addr + file_size <= size);
+
+		/* remainder of the last page (beyond the end of file) reads as zero */
+		void *p = mmap(data + addr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+		close(fd);
+		if (p == MAP_FAILED)
+			throw std::runtime_error("unable to map file \"" + filename + "\" into " + name());
+	}
+
+	void write_data(uint64_t addr, const uint8_t *src, uint64_t num_bytes) {
 		assert(addr + num_bytes <= size);
 
 		memcpy(data + addr, src, num_bytes);
 	}
 
-	void read_data(unsigned addr, uint8_t *dst, unsigned num_bytes) {
+	void read_data(uint64_t addr, uint8_t *dst, uint64_t num_bytes) {
 		assert(addr + num_bytes <= size);
 
 		memcpy(dst, data + addr, num_bytes);
@@ -77,7 +128,7 @@ struct SimpleMemory : public sc_core::sc_module, public load_if {
 
 	unsigned transport_dbg(tlm::tlm_generic_payload &trans) {
 		tlm::tlm_command cmd = trans.get_command();
-		unsigned addr = trans.get_address();
+		uint64_t addr = trans.get_address();
 		auto *ptr = trans.get_data_ptr();
 		auto len = trans.get_data_length();
 
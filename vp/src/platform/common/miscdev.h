@@ -4,6 +4,7 @@
  * A module that provides small miscellaneous functionality
  * Currently implemented:
  *  * reg 0 .. hardware random number generator (e.g. for linux timeriomem_rng)
+ *  * reg 4 .. fork server trigger (write any value, see fork_server.h; ignored if no fork server is configured)
  *
  * TODO:
  *  * Make the random number generation configurable to deliver real random
@@ -22,16 +23,21 @@ extern "C" {
 
 #include <systemc>
 
+#include "fork_server.h"
 #include "util/tlm_map.h"
 
 struct MiscDev : public sc_core::sc_module {
 	tlm_utils::simple_target_socket<MiscDev> tsock;
 
+	ForkServer *fork_server = nullptr;
+
 	// memory mapped registers
 	uint32_t hwrand_reg = 0;
+	uint32_t fork_server_reg = 0;
 
 	enum {
 		HWRAND_REG_ADDR = 0x0,
+		FORK_SERVER_REG_ADDR = 0x4,
 	};
 
 	vp::map::LocalRouter router = {"MiscDev"};
@@ -42,6 +48,7 @@ struct MiscDev : public sc_core::sc_module {
 		router
 		    .add_register_bank({
 		        {HWRAND_REG_ADDR, &hwrand_reg},
+		        {FORK_SERVER_REG_ADDR, &fork_server_reg},
 		    })
 		    .register_handler(this, &MiscDev::register_access_callback);
 	}
@@ -55,6 +62,10 @@ struct MiscDev : public sc_core::sc_module {
 		}
 
 		r.fn();
+
+		if (r.write && r.vptr == &fork_server_reg && fork_server) {
+			fork_server->serve();
+		}
 	}
 
 	void transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
@@ -0,0 +1,232 @@
+#include "net_backend.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/if.h>
+#include <linux/if_tun.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <system_error>
+#include <systemc>
+
+#define MAX_FRAME_SIZE 65536
+
+#define PCAP_MAGIC 0xa1b2c3d4
+#define PCAP_LINKTYPE_ETHERNET 1
+
+struct PcapFileHeader {
+	uint32_t magic;
+	uint16_t version_major;
+	uint16_t version_minor;
+	int32_t thiszone;
+	uint32_t sigfigs;
+	uint32_t snaplen;
+	uint32_t linktype;
+};
+
+struct PcapRecordHeader {
+	uint32_t ts_sec;
+	uint32_t ts_usec;
+	uint32_t incl_len;
+	uint32_t orig_len;
+};
+
+static std::vector<std::string> split(const std::string &s, char delim) {
+	std::vector<std::string> parts;
+	size_t start = 0, pos;
+	while ((pos = s.find(delim, start)) != std::string::npos) {
+		parts.push_back(s.substr(start, pos - start));
+		start = pos + 1;
+	}
+	parts.push_back(s.substr(start));
+	return parts;
+}
+
+std::unique_ptr<NetBackend> NetBackend::create(const std::string &spec) {
+	auto args = split(spec, ':');
+
+	if (args[0] == "tap" && args.size() == 2)
+		return std::make_unique<TapBackend>(args[1]);
+	if (args[0] == "loopback" && args.size() == 1)
+		return std::make_unique<SocketBackend>();
+	if (args[0] == "unix" && args.size() == 3)
+		return std::make_unique<SocketBackend>(args[1], args[2]);
+	if (args[0] == "pcap" && args.size() == 3)
+		return std::make_unique<PcapBackend>(args[1], args[2]);
+
+	throw std::invalid_argument("invalid network backend: " + spec);
+}
+
+/* TapBackend */
+
+TapBackend::TapBackend(const std::string &ifname) {
+	fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK | O_CLOEXEC);
+	if (fd < 0)
+		throw std::system_error(errno, std::generic_category(), "open /dev/net/tun");
+
+	struct ifreq ifr;
+	memset(&ifr, 0, sizeof(ifr));
+	ifr.ifr_flags = IFF_TAP | IFF_NO_PI; /* read/write raw ethernet frames */
+	strncpy(ifr.ifr_name, ifname.c_str(), IFNAMSIZ - 1);
+	if (ioctl(fd, TUNSETIFF, (void *)&ifr) == -1) {
+		int e = errno;
+		close(fd);
+		throw std::system_error(e, std::generic_category(), "TUNSETIFF " + ifname);
+	}
+}
+
+TapBackend::~TapBackend(void) {
+	close(fd);
+}
+
+void TapBackend::send(const uint8_t *frame, size_t len) {
+	if (write(fd, frame, len) < 0) {
+		/* interface down or queue full -> drop */
+	}
+}
+
+bool TapBackend::receive(std::vector<uint8_t> &frame) {
+	frame.resize(MAX_FRAME_SIZE);
+	ssize_t ret = read(fd, frame.data(), frame.size());
+	if (ret <= 0)
+		return false;
+	frame.resize(ret);
+	return true;
+}
+
+/* SocketBackend */
+
+SocketBackend::SocketBackend(void) {
+	int sv[2];
+	if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, sv))
+		throw std::system_error(errno, std::generic_category());
+	tx_fd = sv[0];
+	rx_fd = sv[1];
+	fcntl(tx_fd, F_SETFL, O_NONBLOCK);
+	fcntl(rx_fd, F_SETFL, O_NONBLOCK);
+}
+
+static void set_unix_addr(struct sockaddr_un &addr, const std::string &path) {
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(addr.sun_path))
+		throw std::invalid_argument("unix socket path too long: " + path);
+	strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+}
+
+SocketBackend::SocketBackend(const std::string &local_path, const std::string &remote_path) : local_path(local_path) {
+	struct sockaddr_un local, remote;
+	set_unix_addr(local, local_path);
+	set_unix_addr(remote, remote_path);
+
+	rx_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (rx_fd < 0)
+		throw std::system_error(errno, std::generic_category());
+
+	unlink(local_path.c_str());
+	if (bind(rx_fd, (struct sockaddr *)&local, sizeof(local)))
+		throw std::system_error(errno, std::generic_category(), "bind " + local_path);
+
+	/* a separate socket is used for sending to keep the remote address across peer restarts */
+	tx_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (tx_fd < 0)
+		throw std::system_error(errno, std::generic_category());
+	this->remote = remote;
+}
+
+SocketBackend::~SocketBackend(void) {
+	close(tx_fd);
+	close(rx_fd);
+	if (!local_path.empty())
+		unlink(local_path.c_str());
+}
+
+void SocketBackend::send(const uint8_t *frame, size_t len) {
+	ssize_t ret;
+	if (local_path.empty())
+		ret = ::send(tx_fd, frame, len, 0);
+	else
+		ret = sendto(tx_fd, frame, len, 0, (struct sockaddr *)&remote, sizeof(remote));
+	if (ret < 0) {
+		/* peer not running or receive queue full -> drop */
+	}
+}
+
+bool SocketBackend::receive(std::vector<uint8_t> &frame) {
+	frame.resize(MAX_FRAME_SIZE);
+	ssize_t ret = recv(rx_fd, frame.data(), frame.size(), 0);
+	if (ret <= 0)
+		return false;
+	frame.resize(ret);
+	return true;
+}
+
+/* PcapBackend */
+
+PcapBackend::PcapBackend(const std::string &in_file, const std::string &out_file) {
+	if (!in_file.empty()) {
+		in = fopen(in_file.c_str(), "rb");
+		if (!in)
+			throw std::system_error(errno, std::generic_category(), "pcap input " + in_file);
+
+		PcapFileHeader hdr;
+		if (fread(&hdr, sizeof(hdr), 1, in) != 1)
+			throw std::runtime_error("pcap input " + in_file + ": truncated header");
+		if (hdr.magic == __builtin_bswap32(PCAP_MAGIC)) {
+			swapped = true;
+			hdr.linktype = __builtin_bswap32(hdr.linktype);
+		} else if (hdr.magic != PCAP_MAGIC) {
+			throw std::runtime_error("pcap input " + in_file + ": unsupported format");
+		}
+		if (hdr.linktype != PCAP_LINKTYPE_ETHERNET)
+			throw std::runtime_error("pcap input " + in_file + ": link type is not ethernet");
+	}
+
+	if (!out_file.empty()) {
+		out = fopen(out_file.c_str(), "wb");
+		if (!out)
+			throw std::system_error(errno, std::generic_category(), "pcap output " + out_file);
+
+		PcapFileHeader hdr = {PCAP_MAGIC, 2, 4, 0, 0, MAX_FRAME_SIZE, PCAP_LINKTYPE_ETHERNET};
+		fwrite(&hdr, sizeof(hdr), 1, out);
+	}
+}
+
+PcapBackend::~PcapBackend(void) {
+	if (in)
+		fclose(in);
+	if (out)
+		fclose(out);
+}
+
+void PcapBackend::send(const uint8_t *frame, size_t len) {
+	if (!out)
+		return;
+
+	/* timestamps are simulation time -> captures are reproducible */
+	uint64_t us = sc_core::sc_time_stamp().value() / sc_core::sc_time(1, sc_core::SC_US).value();
+	PcapRecordHeader rec = {(uint32_t)(us / 1000000), (uint32_t)(us % 1000000), (uint32_t)len, (uint32_t)len};
+	fwrite(&rec, sizeof(rec), 1, out);
+	fwrite(frame, len, 1, out);
+	fflush(out);
+}
+
+bool PcapBackend::receive(std::vector<uint8_t> &frame) {
+	if (!in)
+		return false;
+
+	PcapRecordHeader rec;
+	if (fread(&rec, sizeof(rec), 1, in) != 1)
+		return false;
+	uint32_t len = swapped ? __builtin_bswap32(rec.incl_len) : rec.incl_len;
+	if (len > MAX_FRAME_SIZE)
+		return false;
+
+	frame.resize(len);
+	return fread(frame.data(), len, 1, in) == 1 || len == 0;
+}
@@ -0,0 +1,93 @@
+#ifndef RISCV_VP_NET_BACKEND_H
+#define RISCV_VP_NET_BACKEND_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/un.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Host side of an emulated ethernet link
+ *
+ * Supported backends (selected by a spec string, see create):
+ *   tap:<ifname>             TAP device (requires privileges to create/configure the interface)
+ *   loopback                 every transmitted frame is received again
+ *   unix:<local>:<remote>    unix datagram socket bound to <local>, sending to <remote>. Two VPs with swapped paths
+ *                            form a point-to-point link (frames are dropped while the peer is not running).
+ *   pcap:<in>:<out>          replay the frames of pcap file <in> and capture transmitted frames to pcap file <out>
+ *                            (either may be empty)
+ *
+ * send is called from the simulation, receive from a host thread (see VirtioNet), hence implementations have to be
+ * safe for this concurrent use.
+ */
+class NetBackend {
+   public:
+	virtual ~NetBackend(void) {}
+
+	/* transmit an ethernet frame (frames which can not be delivered are dropped) */
+	virtual void send(const uint8_t *frame, size_t len) = 0;
+	/* fd which becomes readable if a frame can be received, -1 if receive never blocks */
+	virtual int get_fd(void) = 0;
+	/* receive the next frame, returns false if no frame is available (or no more frames, if get_fd() is -1) */
+	virtual bool receive(std::vector<uint8_t> &frame) = 0;
+
+	static std::unique_ptr<NetBackend> create(const std::string &spec);
+};
+
+class TapBackend : public NetBackend {
+   public:
+	TapBackend(const std::string &ifname);
+	~TapBackend(void);
+
+	void send(const uint8_t *frame, size_t len) override;
+	int get_fd(void) override {
+		return fd;
+	}
+	bool receive(std::vector<uint8_t> &frame) override;
+
+   private:
+	int fd = -1;
+};
+
+class SocketBackend : public NetBackend {
+   public:
+	/* loopback */
+	SocketBackend(void);
+	/* point-to-point link via unix datagram sockets */
+	SocketBackend(const std::string &local_path, const std::string &remote_path);
+	~SocketBackend(void);
+
+	void send(const uint8_t *frame, size_t len) override;
+	int get_fd(void) override {
+		return rx_fd;
+	}
+	bool receive(std::vector<uint8_t> &frame) override;
+
+   private:
+	int tx_fd = -1;
+	int rx_fd = -1;
+	std::string local_path;
+	struct sockaddr_un remote;
+};
+
+class PcapBackend : public NetBackend {
+   public:
+	PcapBackend(const std::string &in_file, const std::string &out_file);
+	~PcapBackend(void);
+
+	void send(const uint8_t *frame, size_t len) override;
+	int get_fd(void) override {
+		return -1;
+	}
+	bool receive(std::vector<uint8_t> &frame) override;
+
+   private:
+	FILE *in = nullptr;
+	FILE *out = nullptr;
+	bool swapped = false;
+};
+
+#endif  // RISCV_VP_NET_BACKEND_H
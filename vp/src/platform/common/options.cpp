@@ -27,6 +27,21 @@ Options::Options(void) {
 		("debug-bus-mode", po::bool_switch(&use_debug_bus), "dump tlm transaction data via TCP connection")
 		("debug-bus-port", po::value<unsigned int>(&debug_bus_port),"select port number for tlm transaction data")
 		("break-on-transaction", po::bool_switch(&break_on_transaction),"break on every transaction when in --debug-mode")
+		("profile-out", po::value<std::string>(&profile_out), "sample the guest code and write the profile to this file (flat profile, folded stacks in <file>.folded)")
+		("profile-interval", po::value<unsigned long>(&profile_interval), "sampling interval of the guest profiler (in instructions)")
+		("profile-elf", po::value<std::vector<std::string>>(&profile_elf), "additional ELF file with symbols for the guest profiler, optionally relocated by <offset>: <file>[@<offset>] (can be given multiple times)")
+		("coverage-out", po::value<std::string>(&coverage_out), "record the executed guest instructions and write the coverage to this file (drcov, lcov in <file>.info)")
+		("coverage-elf", po::value<std::vector<std::string>>(&coverage_elf), "additional ELF file (module) for the guest coverage, optionally relocated by <offset>: <file>[@<offset>] (can be given multiple times)")
+		("native-routines", po::bool_switch(&native_routines), "execute calls of memcpy, memset, memmove, strlen and memcmp (entry points from the ELF symbols) on the host if the arguments are located in DMI memory")
+		("native-routine", po::value<std::vector<std::string>>(&native_routine), "additional native routine entry point: <name>@<addr>, e.g. memcpy@0x80001234 (can be given multiple times, implies 'native-routines')")
+		("native-cost-base", po::value<unsigned int>(&native_cost_base), "instructions accounted per native routine call")
+		("native-cost-per-byte", po::value<double>(&native_cost_per_byte), "instructions accounted per byte processed by a native routine")
+		("roi", po::bool_switch(&roi), "fast-forward (large quantum, DBBCache, LSCache and data DMI, no tracing) to the region of interest marker of the guest (slti zero, zero, 1), simulate the region with the configured settings and exit at the end marker (slti zero, zero, 2)")
+		("bus-stats", po::bool_switch(&bus_stats), "count bus transactions per initiator and target and DMI/TLM accesses per core, print a summary at exit (collection is toggled with SIGUSR2)")
+		("bus-stats-out", po::value<std::string>(&bus_stats_out), "write the bus statistics as JSON reports (one per line) to this file (implies 'bus-stats')")
+		("bus-stats-interval", po::value<unsigned long>(&bus_stats_interval), "period of the bus statistics reports (in NS of simulated time), 0: final report only")
+		("bus-stats-paused", po::bool_switch(&bus_stats_paused), "start with the bus statistics collection disabled (implies 'bus-stats')")
+		("host-profile", po::bool_switch(&host_profile), "measure the host time of the SystemC processes (e.g. cores, CLINT, PLIC) and bus targets, print a report sorted by host time at exit")
 		("input-file", po::value<std::string>(&input_program)->required(), "input file to use for execution");
 	// clang-format on
 
@@ -62,6 +77,25 @@ void Options::parse(int argc, char **argv) {
 			          << std::endl;
 			exit(1);
 		}
+		if (!native_routine.empty())
+			native_routines = true;
+		if (!bus_stats_out.empty() || bus_stats_paused)
+			bus_stats = true;
+		if (native_routines && !use_data_dmi) {
+			std::cerr << "[Options] Info: switch 'native-routines' also activates 'use-data-dmi' if unset."
+			          << std::endl;
+			use_data_dmi = true;
+		}
+		if (roi) {
+			std::cerr << "[Options] Info: switch 'roi' activates 'use-dbbcache', 'use-lscache' and "
+			             "'use-data-dmi' until the region of interest begins."
+			          << std::endl;
+			roi_use_lscache = use_lscache;
+			roi_use_data_dmi = use_data_dmi;
+			use_dbbcache = true;
+			use_lscache = true;
+			use_data_dmi = true;
+		}
 		if (vm["intercept-syscalls"].as<bool>() && vm.count("error-on-zero-traphandler") == 0) {
 			// intercept syscalls active, but no overriding error-on-zero-traphandler switch
 			std::cerr
@@ -87,4 +121,10 @@ void Options::printValues(std::ostream &os) const {
 	os << "tlm_global_quantum: " << tlm_global_quantum << std::endl;
 	os << "use_instr_dmi: " << use_instr_dmi << std::endl;
 	os << "use_data_dmi: " << use_data_dmi << std::endl;
+	os << "profile_out: " << profile_out << std::endl;
+	os << "coverage_out: " << coverage_out << std::endl;
+	os << "native_routines: " << native_routines << std::endl;
+	os << "roi: " << roi << std::endl;
+	os << "bus_stats: " << bus_stats << std::endl;
+	os << "host_profile: " << host_profile << std::endl;
 }
@@ -3,6 +3,8 @@
 
 #include <boost/program_options.hpp>
 #include <iostream>
+#include <string>
+#include <vector>
 
 class Options : public boost::program_options::options_description {
    public:
@@ -27,11 +29,31 @@ class Options : public boost::program_options::options_description {
 	bool use_debug_bus = false;
 	unsigned int debug_bus_port = 5006;
 	bool break_on_transaction = false;
+	std::string profile_out;
+	unsigned long profile_interval = 10000;
+	std::vector<std::string> profile_elf;
+	std::string coverage_out;
+	std::vector<std::string> coverage_elf;
+	bool native_routines = false;
+	std::vector<std::string> native_routine;
+	unsigned int native_cost_base = 20;
+	double native_cost_per_byte = 0.25;
+	bool roi = false;
+	/* configured settings, used inside of the region of interest (see --roi) */
+	bool roi_use_lscache = false;
+	bool roi_use_data_dmi = false;
+	bool bus_stats = false;
+	std::string bus_stats_out;
+	unsigned long bus_stats_interval = 0;
+	bool bus_stats_paused = false;
+	bool host_profile = false;
 
 	virtual void printValues(std::ostream& os = std::cout) const;
 
-   private:
+   protected:
 	boost::program_options::positional_options_description pos;
+
+   private:
 	boost::program_options::variables_map vm;
 };
 
@@ -3,6 +3,14 @@
 
 /*
  * SPI Host for SiFive HiFive
+ *
+ * Extension (not available on the real hardware): bulk transfer DMA
+ * Transfers DMA_LEN bytes between memory (DMI ranges, see add_dma_range) and the selected device in a single step.
+ * DMA_CTRL selects the direction: with DMA_CTRL_TX the bytes are read from DMA_SRC (otherwise 0xff is sent), with
+ * DMA_CTRL_RX the received bytes are written to DMA_DST (otherwise discarded). Chip select is handled as for a
+ * single frame (see csmode). The transfer is busy for the time it takes on the wire (see sckdiv), afterwards
+ * DMA_STATUS_DONE and the DMA interrupt pending bit (IP_DMA) are set. Writing 1 to DONE/ERROR clears them.
+ * The data itself is moved at the start, i.e. software has to wait for DONE before accessing it.
  */
 
 #include <tlm_utils/simple_target_socket.h>
@@ -10,10 +18,12 @@
 #include <map>
 #include <queue>
 #include <systemc>
+#include <vector>
 
+#include "core/common/dmi.h"
 #include "core/common/irq_if.h"
 #include "platform/common/spi_if.h"
-#include "util/tlm_map.h"
+#include "util/register_map.h"
 
 /* see code below */
 //#define SIFIVE_SPI_QUEUE_FULL_HANDING_ALT
@@ -48,6 +58,16 @@ class SIFIVE_SPI : public sc_core::sc_module, public SPI_IF {
 	uint32_t ffmt = 0;
 	uint32_t ie = 0;
 	uint32_t ip = 0;
+	uint32_t dma_src_lo = 0;
+	uint32_t dma_src_hi = 0;
+	uint32_t dma_dst_lo = 0;
+	uint32_t dma_dst_hi = 0;
+	uint32_t dma_len = 0;
+	uint32_t dma_ctrl = 0;
+	uint32_t dma_status = 0;
+
+	std::vector<MemoryDMI> dma_ranges;
+	sc_core::sc_event dma_done_event;
 
 	// set by csmode
 	// assert chipselect at beginning of each frame
@@ -72,14 +92,34 @@ class SIFIVE_SPI : public sc_core::sc_module, public SPI_IF {
 		FFMT_REG_ADDR = 0x64,
 		IE_REG_ADDR = 0x70,
 		IP_REG_ADDR = 0x74,
+		/* extension */
+		DMA_SRC_LO_REG_ADDR = 0x80,
+		DMA_SRC_HI_REG_ADDR = 0x84,
+		DMA_DST_LO_REG_ADDR = 0x88,
+		DMA_DST_HI_REG_ADDR = 0x8C,
+		DMA_LEN_REG_ADDR = 0x90,
+		DMA_CTRL_REG_ADDR = 0x94,
+		DMA_STATUS_REG_ADDR = 0x98,
+	};
+
+	enum DMA_CTRL_BITS {
+		DMA_CTRL_START = (1 << 0),
+		DMA_CTRL_TX = (1 << 1),
+		DMA_CTRL_RX = (1 << 2),
+	};
+
+	enum DMA_STATUS_BITS {
+		DMA_STATUS_BUSY = (1 << 0),
+		DMA_STATUS_DONE = (1 << 1),
+		DMA_STATUS_ERROR = (1 << 2),
 	};
 
 	enum CSMODE_VALS { AUTO = 0, RESERVED = 1, HOLD = 2, OFF = 3 };
 
 	static constexpr uint_fast8_t SIFIVE_SPI_IP_TXWM = 0x1;
 	static constexpr uint_fast8_t SIFIVE_SPI_IP_RXWM = 0x2;
+	static constexpr uint_fast8_t SIFIVE_SPI_IP_DMA = 0x4;
 
-	vp::map::LocalRouter router = {"SIFIVE_SPI"};
 	void trigger_interrupt() {
 		if (plic == nullptr || interrupt < 0) {
 			return;
@@ -115,7 +155,49 @@ class SIFIVE_SPI : public sc_core::sc_module, public SPI_IF {
 		}
 	}
 
-	void register_access_callback(const vp::map::register_access_t &r) {
+	uint8_t *dma_ptr(uint64_t addr, uint64_t len) {
+		for (auto &e : dma_ranges) {
+			if (e.contains(addr) && len <= e.get_end() - addr)
+				return e.get_mem_ptr_to_global_addr<uint8_t>(addr);
+		}
+		return nullptr;
+	}
+
+	sc_core::sc_time get_byte_time() {
+		/* f_sck = f_in / (2 * (div + 1)), 8 bit frames */
+		return clock_period * (double)(2 * ((sckdiv & 0xfff) + 1) * 8);
+	}
+
+	void dma_start() {
+		uint8_t *mosi = nullptr;
+		uint8_t *miso = nullptr;
+
+		if (dma_ctrl & DMA_CTRL_TX) {
+			mosi = dma_ptr((uint64_t)dma_src_hi << 32 | dma_src_lo, dma_len);
+		}
+		if (dma_ctrl & DMA_CTRL_RX) {
+			miso = dma_ptr((uint64_t)dma_dst_hi << 32 | dma_dst_lo, dma_len);
+		}
+		if (((dma_ctrl & DMA_CTRL_TX) && !mosi) || ((dma_ctrl & DMA_CTRL_RX) && !miso)) {
+			std::cerr << "SIFIVE_SPI: DMA buffer outside of dma memory" << std::endl;
+			dma_status |= DMA_STATUS_ERROR;
+			dma_done_event.notify(sc_core::SC_ZERO_TIME);
+		} else {
+			transfer_bulk(csid, cs_select, cs_deselect, mosi, miso, dma_len);
+			dma_done_event.notify(get_byte_time() * (double)dma_len);
+		}
+		dma_status |= DMA_STATUS_BUSY;
+	}
+
+	void dma_done() {
+		dma_status = (dma_status & ~DMA_STATUS_BUSY) | DMA_STATUS_DONE;
+		ip |= SIFIVE_SPI_IP_DMA;
+		if (ie & SIFIVE_SPI_IP_DMA) {
+			trigger_interrupt();
+		}
+	}
+
+	void register_access_callback(const vp::regmap::Access &r) {
 		bool trigger_interrupt = false;
 
 		if (r.read) {
@@ -143,10 +225,24 @@ class SIFIVE_SPI : public sc_core::sc_module, public SPI_IF {
 		}
 
 		uint32_t csid_old = csid;
+		uint32_t dma_status_old = dma_status;
 		r.fn();
 
 		if (r.write) {
-			if (r.vptr == &csdef) {
+			if (r.vptr == &dma_status) {
+				/* write 1 to clear */
+				dma_status = dma_status_old & ~(dma_status & (DMA_STATUS_DONE | DMA_STATUS_ERROR));
+				if (!(dma_status & DMA_STATUS_DONE)) {
+					ip &= ~SIFIVE_SPI_IP_DMA;
+				}
+
+			} else if (r.vptr == &dma_ctrl) {
+				if ((dma_ctrl & DMA_CTRL_START) && !(dma_status & DMA_STATUS_BUSY)) {
+					dma_start();
+				}
+				dma_ctrl &= ~DMA_CTRL_START;
+
+			} else if (r.vptr == &csdef) {
 				csdef &= cs_width_mask;
 
 			} else if (r.vptr == &csid) {
@@ -201,13 +297,52 @@ class SIFIVE_SPI : public sc_core::sc_module, public SPI_IF {
 		}
 	}
 
+	template <uint64_t Addr, uint32_t SIFIVE_SPI::*Field>
+	using Reg = vp::regmap::Reg<Addr, Field, &SIFIVE_SPI::register_access_callback>;
+
+	typedef vp::regmap::RegisterMap<
+	    1, vp::regmap::Bank<0x0, DMA_STATUS_REG_ADDR + sizeof(uint32_t),
+	                        Reg<SCKDIV_REG_ADDR, &SIFIVE_SPI::sckdiv>,
+	                        Reg<SCKMODE_REG_ADDR, &SIFIVE_SPI::sckmode>,
+	                        Reg<CSID_REG_ADDR, &SIFIVE_SPI::csid>,
+	                        Reg<CSDEF_REG_ADDR, &SIFIVE_SPI::csdef>,
+	                        Reg<CSMODE_REG_ADDR, &SIFIVE_SPI::csmode>,
+	                        Reg<DELAY0_REG_ADDR, &SIFIVE_SPI::delay0>,
+	                        Reg<DELAY1_REG_ADDR, &SIFIVE_SPI::delay1>,
+	                        Reg<FMT_REG_ADDR, &SIFIVE_SPI::fmt>,
+	                        Reg<TXDATA_REG_ADDR, &SIFIVE_SPI::txdata>,
+	                        Reg<RXDATA_REG_ADDR, &SIFIVE_SPI::rxdata>,
+	                        Reg<TXMARK_REG_ADDR, &SIFIVE_SPI::txmark>,
+	                        Reg<RXMARK_REG_ADDR, &SIFIVE_SPI::rxmark>,
+	                        Reg<FCTRL_REG_ADDR, &SIFIVE_SPI::fctrl>,
+	                        Reg<FFMT_REG_ADDR, &SIFIVE_SPI::ffmt>,
+	                        Reg<IE_REG_ADDR, &SIFIVE_SPI::ie>,
+	                        Reg<IP_REG_ADDR, &SIFIVE_SPI::ip>,
+	                        Reg<DMA_SRC_LO_REG_ADDR, &SIFIVE_SPI::dma_src_lo>,
+	                        Reg<DMA_SRC_HI_REG_ADDR, &SIFIVE_SPI::dma_src_hi>,
+	                        Reg<DMA_DST_LO_REG_ADDR, &SIFIVE_SPI::dma_dst_lo>,
+	                        Reg<DMA_DST_HI_REG_ADDR, &SIFIVE_SPI::dma_dst_hi>,
+	                        Reg<DMA_LEN_REG_ADDR, &SIFIVE_SPI::dma_len>,
+	                        Reg<DMA_CTRL_REG_ADDR, &SIFIVE_SPI::dma_ctrl>,
+	                        Reg<DMA_STATUS_REG_ADDR, &SIFIVE_SPI::dma_status>>>
+	    register_map;
+
 	void transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
-		router.transport(trans, delay);
+		register_map::transport("SIFIVE_SPI", *this, trans, delay);
 	}
 
    public:
 	tlm_utils::simple_target_socket<SIFIVE_SPI> tsock;
 	interrupt_gateway *plic = nullptr;
+	/* input clock (tlclk) used for the timing of dma transfers */
+	sc_core::sc_time clock_period = sc_core::sc_time(10, sc_core::SC_NS);
+
+	SC_HAS_PROCESS(SIFIVE_SPI);
+
+	/* memory accessible by the dma extension */
+	void add_dma_range(const MemoryDMI &dmi) {
+		dma_ranges.push_back(dmi);
+	}
 
 	bool is_chipselect_valid(unsigned int cs) override {
 		/*
@@ -230,26 +365,9 @@ class SIFIVE_SPI : public sc_core::sc_module, public SPI_IF {
 
 		tsock.register_b_transport(this, &SIFIVE_SPI::transport);
 
-		router
-		    .add_register_bank({
-		        {SCKDIV_REG_ADDR, &sckdiv},
-		        {SCKMODE_REG_ADDR, &sckmode},
-		        {CSID_REG_ADDR, &csid},
-		        {CSDEF_REG_ADDR, &csdef},
-		        {CSMODE_REG_ADDR, &csmode},
-		        {DELAY0_REG_ADDR, &delay0},
-		        {DELAY1_REG_ADDR, &delay1},
-		        {FMT_REG_ADDR, &fmt},
-		        {TXDATA_REG_ADDR, &txdata},
-		        {RXDATA_REG_ADDR, &rxdata},
-		        {TXMARK_REG_ADDR, &txmark},
-		        {RXMARK_REG_ADDR, &rxmark},
-		        {FCTRL_REG_ADDR, &fctrl},
-		        {FFMT_REG_ADDR, &ffmt},
-		        {IE_REG_ADDR, &ie},
-		        {IP_REG_ADDR, &ip},
-		    })
-		    .register_handler(this, &SIFIVE_SPI::register_access_callback);
+		SC_METHOD(dma_done);
+		sensitive << dma_done_event;
+		dont_initialize();
 	}
 };
 
@@ -30,6 +30,10 @@ void SIFIVE_Test::register_access_callback(const vp::map::register_access_t &r)
 		if (reg_ctrl == 0x5555) {
 			std::cout << "SIFIVE_Test: Received poweroff -> stop" << std::endl;
 			sc_core::sc_stop();
+		} else if ((reg_ctrl & 0xFFFF) == 0x3333) {
+			exit_code = reg_ctrl >> 16;
+			std::cout << "SIFIVE_Test: Received fail (code " << exit_code << ") -> stop" << std::endl;
+			sc_core::sc_stop();
 		} else if (reg_ctrl == 0x7777) {
 			std::cout << "SIFIVE_Test: Received reboot -> stop" << std::endl;
 			/* reboot not implemented in vp -> stop */
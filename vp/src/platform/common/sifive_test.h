@@ -18,6 +18,11 @@ class SIFIVE_Test : public sc_core::sc_module {
 	SIFIVE_Test(const sc_core::sc_module_name &);
 	~SIFIVE_Test(void);
 
+	/* exit code signaled by the guest (0 on poweroff, <code> on fail) */
+	int get_exit_code(void) {
+		return exit_code;
+	}
+
 	SC_HAS_PROCESS(SIFIVE_Test);
 
    private:
@@ -25,6 +30,7 @@ class SIFIVE_Test : public sc_core::sc_module {
 	void transport(tlm::tlm_generic_payload &, sc_core::sc_time &);
 
 	uint32_t reg_ctrl = 0;
+	int exit_code = 0;
 
 	vp::map::LocalRouter router = {"SIFIVE_TEST"};
 };
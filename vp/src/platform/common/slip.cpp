@@ -102,10 +102,12 @@ void SLIP::send_packet(void) {
 	sndsiz = 0;
 }
 
-void SLIP::handle_input(int fd) {
+bool SLIP::handle_input(int fd) {
 	ssize_t ret = read(fd, rcvbuf, rcvsiz);
 	if (ret <= -1)
 		throw std::system_error(errno, std::generic_category());
+	else if (ret == 0)
+		return false;
 
 	for (size_t i = 0; i < static_cast<size_t>(ret); i++) {
 		switch (rcvbuf[i]) {
@@ -123,6 +125,7 @@ void SLIP::handle_input(int fd) {
 		}
 	}
 	rxpush(SLIP_END);
+	return true;
 }
 
 void SLIP::write_data(uint8_t data) {
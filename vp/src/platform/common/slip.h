@@ -15,7 +15,7 @@ class SLIP : public FD_ABSTRACT_UART {
 	int get_mtu(const char *);
 	void send_packet(void);
 	void write_data(uint8_t) override;
-	void handle_input(int fd) override;
+	bool handle_input(int fd) override;
 
 	int tunfd;
 
@@ -1,6 +1,8 @@
 #ifndef RISCV_VP_SPI_IF_H
 #define RISCV_VP_SPI_IF_H
 
+#include <string.h>
+
 #include <map>
 #include <queue>
 #include <systemc>
@@ -15,6 +17,19 @@ class SPI_Device_IF {
    protected:
 	virtual void select(bool ena) = 0;
 	virtual uint8_t transfer(uint8_t mosi) = 0;
+
+	/*
+	 * transfer len bytes at once (mosi == nullptr -> send 0xff, miso == nullptr -> discard received bytes)
+	 * devices may override this with a fast path, which must behave like len calls of transfer
+	 */
+	virtual void transfer_bulk(const uint8_t *mosi, uint8_t *miso, size_t len) {
+		for (size_t i = 0; i < len; i++) {
+			uint8_t rx = transfer(mosi ? mosi[i] : 0xff);
+			if (miso) {
+				miso[i] = rx;
+			}
+		}
+	}
 };
 
 /*
@@ -105,6 +120,29 @@ class SPI_IF {
 		return true;
 	}
 
+	bool transfer_bulk(unsigned int cs, bool select, bool deselect, const uint8_t *mosi, uint8_t *miso, size_t len) {
+		SPI_Device_IF *device = get_device(cs);
+		if (device == nullptr) {
+			std::cerr << "SPI: WARNING: Transfer on unregistered Chip-Select " << cs << std::endl;
+			if (miso) {
+				memset(miso, 0xff, len);
+			}
+			return false;
+		}
+
+		if (select) {
+			device_select(cs, device);
+		}
+
+		device->transfer_bulk(mosi, miso, len);
+
+		if (deselect) {
+			device_deselect();
+		}
+
+		return true;
+	}
+
    public:
 	/* interface */
 	virtual bool is_chipselect_valid(unsigned int cs) = 0;
@@ -1,5 +1,10 @@
 #include "spi_sd_card.h"
 
+#include <limits.h>
+#include <string.h>
+
+#include <algorithm>
+
 /*
  * Implementation static helpers
  */
@@ -592,6 +597,50 @@ uint8_t SPI_SD_Card::transfer(uint8_t mosi) {
 	return miso;
 }
 
+/*
+ * SPI_Device bulk transfer method
+ * Block data of single/multi block reads and writes is copied directly from/to the block buffer, everything else
+ * (commands, responses, tokens, block boundaries) is handled by the byte-wise state machines.
+ */
+void SPI_SD_Card::transfer_bulk(const uint8_t *mosi, uint8_t *miso, size_t len) {
+	size_t i = 0;
+
+	while (i < len) {
+		unsigned int chunk = std::min<size_t>(len - i, UINT_MAX);
+		unsigned int n = 0;
+
+		if (selected && receiver.mode == Receiver::MODE_CMD && receiver.state == 0) {
+			/* reads: only while the host sends idle bytes (0xff) */
+			unsigned int idle_len = chunk;
+			if (mosi) {
+				for (idle_len = 0; idle_len < chunk && mosi[i + idle_len] == 0xff; idle_len++)
+					;
+			}
+			uint8_t discard[block_size + 2];
+			n = transmitter.sm_bulk(miso ? miso + i : discard, std::min<unsigned int>(idle_len, sizeof(discard)));
+			if (n) {
+				/* see Receiver::sm_cmd */
+				receiver.data[0] = 0xff;
+			}
+		} else if (selected && receiver.mode == Receiver::MODE_DATA && transmitter.idle) {
+			n = receiver.sm_bulk(mosi ? mosi + i : nullptr, chunk);
+			if (n && miso) {
+				memset(miso + i, 0xff, n);
+			}
+		}
+
+		if (n == 0) {
+			uint8_t rx = transfer(mosi ? mosi[i] : 0xff);
+			if (miso) {
+				miso[i] = rx;
+			}
+			n = 1;
+		}
+
+		i += n;
+	}
+}
+
 /* SPI Chipselect method */
 void SPI_SD_Card::select(bool ena) {
 	selected = ena;
@@ -772,6 +821,22 @@ void SPI_SD_Card::Receiver::switch_data_mode(bool mult) {
 	this->mult = mult;
 }
 
+unsigned int SPI_SD_Card::Receiver::sm_bulk(const uint8_t *mosi, unsigned int len) {
+	/* only within block data (see sm_data) */
+	if (state == 0 || state > data_len) {
+		return 0;
+	}
+
+	unsigned int n = std::min(len, data_len + 1 - state);
+	if (mosi) {
+		memcpy(&card->block[state - 1], mosi, n);
+	} else {
+		memset(&card->block[state - 1], 0xff, n);
+	}
+	state += n;
+	return n;
+}
+
 void SPI_SD_Card::Receiver::sm(uint8_t mosi) {
 	if (mode == MODE_CMD) {
 		sm_cmd(mosi);
@@ -946,3 +1011,17 @@ uint8_t SPI_SD_Card::Transmitter::sm() {
 	state++;
 	return ret;
 }
+
+unsigned int SPI_SD_Card::Transmitter::sm_bulk(uint8_t *miso, unsigned int len) {
+	const unsigned int start = IDLE_LEN + data_len + TOKEN_LEN;
+
+	/* only within block data (see sm) */
+	if (idle || pdata_len == 0 || state < start || state >= start + pdata_len) {
+		return 0;
+	}
+
+	unsigned int n = std::min(len, start + pdata_len - state);
+	memcpy(miso, &pdata[state - start], n);
+	state += n;
+	return n;
+}
@@ -133,6 +133,8 @@ class SPI_SD_Card : SPI_Device_IF {
 		void reset();
 		void switch_data_mode(bool mult);
 		void sm(uint8_t mosi);
+		/* fast path: store up to len bytes of block data at once, returns number of bytes handled */
+		unsigned int sm_bulk(const uint8_t *mosi, unsigned int len);
 	};
 	Receiver receiver;
 
@@ -170,6 +172,8 @@ class SPI_SD_Card : SPI_Device_IF {
 		void set_R2_payload(uint8_t *data, unsigned int len);
 
 		uint8_t sm();
+		/* fast path: output up to len bytes of block data at once, returns number of bytes handled */
+		unsigned int sm_bulk(uint8_t *miso, unsigned int len);
 	};
 	Transmitter transmitter;
 
@@ -181,6 +185,7 @@ class SPI_SD_Card : SPI_Device_IF {
 
 	/* SPI_Device_IF implementation */
 	uint8_t transfer(uint8_t mosi) override;
+	void transfer_bulk(const uint8_t *mosi, uint8_t *miso, size_t len) override;
 	void select(bool ena) override;
 
    public:
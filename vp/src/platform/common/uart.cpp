@@ -30,15 +30,35 @@ UART::~UART(void) {
 	disableRawMode(STDIN_FILENO);
 }
 
-void UART::handle_input(int fd) {
+void UART::stop_io(void) {
+	/* let the transmit thread drain the fifo first */
+	while (true) {
+		txmtx.lock();
+		bool empty = tx_fifo.empty();
+		txmtx.unlock();
+		if (empty)
+			break;
+		usleep(1000);
+	}
+
+	stop_threads();
+	disableRawMode(STDIN_FILENO);
+}
+
+void UART::start_io(void) {
+	enableRawMode(STDIN_FILENO);
+	start_threads(STDIN_FILENO);
+}
+
+bool UART::handle_input(int fd) {
 	uint8_t buf;
 	ssize_t nread;
 
 	nread = read(fd, &buf, sizeof(buf));
 	if (nread == -1)
 		throw std::system_error(errno, std::generic_category());
-	else if (nread != sizeof(buf))
-		throw std::runtime_error("short read");
+	else if (nread == 0)
+		return false;  // end of input (e.g. a fork server client shut down its write side)
 
 	switch (state) {
 		case STATE_NORMAL:
@@ -56,6 +76,8 @@ void UART::handle_input(int fd) {
 	} else {
 		state = STATE_NORMAL;
 	}
+
+	return true;
 }
 
 void UART::handle_cmd(uint8_t cmd) {
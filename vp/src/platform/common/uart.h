@@ -11,6 +11,11 @@ class UART : public FD_ABSTRACT_UART {
 	UART(const sc_core::sc_module_name&, uint32_t);
 	virtual ~UART(void);
 
+	/* stop forwarding stdin/stdout and restore the terminal (e.g. before fork) */
+	void stop_io(void);
+	/* (re)start forwarding stdin/stdout, input is forwarded even if stdin is not a tty (e.g. a socket) */
+	void start_io(void);
+
    private:
 	typedef enum {
 		STATE_COMMAND,
@@ -26,7 +31,7 @@ class UART : public FD_ABSTRACT_UART {
 	uart_state state = STATE_NORMAL;
 	void handle_cmd(uint8_t);
 
-	void handle_input(int fd) override;
+	bool handle_input(int fd) override;
 	void write_data(uint8_t) override;
 };
 
@@ -11,18 +11,6 @@ UART_IF::UART_IF(sc_core::sc_module_name, uint32_t irqsrc) : plic(nullptr) {
 	irq = irqsrc;
 	tsock.register_b_transport(this, &UART_IF::transport);
 
-	router
-	    .add_register_bank({
-	        {TXDATA_REG_ADDR, &txdata},
-	        {RXDATA_REG_ADDR, &rxdata},
-	        {TXCTRL_REG_ADDR, &txctrl},
-	        {RXCTRL_REG_ADDR, &rxctrl},
-	        {IE_REG_ADDR, &ie},
-	        {IP_REG_ADDR, &ip},
-	        {DIV_REG_ADDR, &div},
-	    })
-	    .register_handler(this, &UART_IF::register_access_callback);
-
 	if (sem_init(&txfull, 0, 0))
 		throw std::system_error(errno, std::generic_category());
 	if (sem_init(&rxempty, 0, UART_FIFO_DEPTH))
@@ -58,7 +46,7 @@ uint8_t UART_IF::txpull() {
 	return data;
 }
 
-void UART_IF::register_access_callback(const vp::map::register_access_t &r) {
+void UART_IF::register_access_callback(const vp::regmap::Access &r) {
 	if (r.read) {
 		if (r.vptr == &txdata) {
 			txmtx.lock();
@@ -128,7 +116,7 @@ void UART_IF::register_access_callback(const vp::map::register_access_t &r) {
 }
 
 void UART_IF::transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
-	router.transport(trans, delay);
+	register_map::transport("UART", *this, trans, delay);
 }
 
 void UART_IF::interrupt(void) {
@@ -13,7 +13,7 @@
 
 #include "core/common/irq_if.h"
 #include "platform/common/async_event.h"
-#include "util/tlm_map.h"
+#include "util/register_map.h"
 
 class UART_IF : public sc_core::sc_module {
    public:
@@ -47,7 +47,7 @@ class UART_IF : public sc_core::sc_module {
 	SC_HAS_PROCESS(UART_IF);  // interrupt
 
    private:
-	void register_access_callback(const vp::map::register_access_t &);
+	void register_access_callback(const vp::regmap::Access &);
 	void transport(tlm::tlm_generic_payload &, sc_core::sc_time &);
 	void interrupt(void);
 
@@ -62,7 +62,15 @@ class UART_IF : public sc_core::sc_module {
 	uint32_t ip = 0;
 	uint32_t div = 0;
 
-	vp::map::LocalRouter router = {"UART"};
+	template <uint64_t Addr, uint32_t UART_IF::*Field>
+	using Reg = vp::regmap::Reg<Addr, Field, &UART_IF::register_access_callback>;
+
+	typedef vp::regmap::RegisterMap<
+	    1, vp::regmap::Bank<0x0, DIV_REG_ADDR + sizeof(uint32_t), Reg<TXDATA_REG_ADDR, &UART_IF::txdata>,
+	                        Reg<RXDATA_REG_ADDR, &UART_IF::rxdata>, Reg<TXCTRL_REG_ADDR, &UART_IF::txctrl>,
+	                        Reg<RXCTRL_REG_ADDR, &UART_IF::rxctrl>, Reg<IE_REG_ADDR, &UART_IF::ie>,
+	                        Reg<IP_REG_ADDR, &UART_IF::ip>, Reg<DIV_REG_ADDR, &UART_IF::div>>>
+	    register_map;
 
    protected:
 	std::queue<uint8_t> tx_fifo;
@@ -0,0 +1,221 @@
+#include "virtio_blk.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <system_error>
+
+/* feature bits */
+static constexpr uint64_t VIRTIO_BLK_F_RO = 1ull << 5;
+static constexpr uint64_t VIRTIO_BLK_F_FLUSH = 1ull << 9;
+
+/* request types */
+static constexpr uint32_t VIRTIO_BLK_T_IN = 0;
+static constexpr uint32_t VIRTIO_BLK_T_OUT = 1;
+static constexpr uint32_t VIRTIO_BLK_T_FLUSH = 4;
+static constexpr uint32_t VIRTIO_BLK_T_GET_ID = 8;
+
+/* request status */
+static constexpr uint8_t VIRTIO_BLK_S_OK = 0;
+static constexpr uint8_t VIRTIO_BLK_S_IOERR = 1;
+static constexpr uint8_t VIRTIO_BLK_S_UNSUPP = 2;
+
+static constexpr unsigned SECTOR_SIZE = 512;
+static constexpr unsigned ID_BYTES = 20;
+
+struct VirtioBlkReqHeader {
+	uint32_t type;
+	uint32_t reserved;
+	uint64_t sector;
+} __attribute__((packed));
+
+struct VirtioBlkConfig {
+	uint64_t capacity;
+	uint32_t size_max;
+	uint32_t seg_max;
+	uint16_t cylinders;
+	uint8_t heads;
+	uint8_t sectors;
+	uint32_t blk_size;
+} __attribute__((packed));
+
+VirtioBlk::VirtioBlk(sc_core::sc_module_name name, const std::string &image_file, uint32_t irq_number)
+    : VirtioMMIO(name, image_file.empty() ? DEVICE_ID_NONE : DEVICE_ID_BLOCK, 1, 256, irq_number) {
+	if (!image_file.empty()) {
+		fd = open(image_file.c_str(), O_RDWR | O_CLOEXEC);
+		if (fd < 0 && (errno == EACCES || errno == EROFS)) {
+			fd = open(image_file.c_str(), O_RDONLY | O_CLOEXEC);
+			read_only = true;
+		}
+		if (fd < 0)
+			throw std::system_error(errno, std::generic_category(), "virtio-blk image " + image_file);
+
+		struct stat st;
+		if (fstat(fd, &st))
+			throw std::system_error(errno, std::generic_category());
+		if (st.st_size % SECTOR_SIZE)
+			std::cerr << "[VirtioBlk] image size is not a multiple of " << SECTOR_SIZE
+			          << " bytes, ignoring the last partial sector" << std::endl;
+		capacity = st.st_size / SECTOR_SIZE;
+
+		SC_THREAD(run);
+	}
+}
+
+VirtioBlk::~VirtioBlk(void) {
+	if (fd >= 0)
+		close(fd);
+}
+
+uint64_t VirtioBlk::get_device_features(void) {
+	return F_INDIRECT_DESC | VIRTIO_BLK_F_FLUSH | (read_only ? VIRTIO_BLK_F_RO : 0);
+}
+
+void VirtioBlk::read_config(uint64_t offset, uint8_t *dst, unsigned len) {
+	VirtioBlkConfig config;
+	memset(&config, 0, sizeof(config));
+	config.capacity = capacity;
+	config.blk_size = SECTOR_SIZE;
+
+	memset(dst, 0, len);
+	if (offset < sizeof(config))
+		memcpy(dst, (uint8_t *)&config + offset, std::min<uint64_t>(len, sizeof(config) - offset));
+}
+
+void VirtioBlk::queue_notify(unsigned queue) {
+	(void)queue;
+	notify_event.notify(sc_core::SC_ZERO_TIME);
+}
+
+void VirtioBlk::device_reset(void) {
+	reset_generation++;
+}
+
+bool VirtioBlk::transfer(bool write, const std::vector<struct iovec> &iov, size_t iov_offset, size_t len,
+                         uint64_t offset) {
+	/* select the data part of the iovecs */
+	std::vector<struct iovec> data;
+	for (auto &v : iov) {
+		if (len == 0)
+			break;
+		if (iov_offset >= v.iov_len) {
+			iov_offset -= v.iov_len;
+			continue;
+		}
+		size_t n = std::min(v.iov_len - iov_offset, len);
+		data.push_back({(uint8_t *)v.iov_base + iov_offset, n});
+		len -= n;
+		iov_offset = 0;
+	}
+
+	size_t idx = 0;
+	while (idx < data.size()) {
+		int cnt = std::min<size_t>(data.size() - idx, IOV_MAX);
+		ssize_t ret = write ? pwritev(fd, &data[idx], cnt, offset) : preadv(fd, &data[idx], cnt, offset);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return false;
+
+		offset += ret;
+		/* skip completed iovecs, adjust partially completed one */
+		while (ret > 0 && idx < data.size()) {
+			if ((size_t)ret >= data[idx].iov_len) {
+				ret -= data[idx].iov_len;
+				idx++;
+			} else {
+				data[idx].iov_base = (uint8_t *)data[idx].iov_base + ret;
+				data[idx].iov_len -= ret;
+				ret = 0;
+			}
+		}
+	}
+	return true;
+}
+
+uint8_t VirtioBlk::handle_request(VirtqElement &elem, uint32_t &written, sc_core::sc_time &delay) {
+	VirtioBlkReqHeader hdr;
+	if (iov_to_buf(elem.out, 0, &hdr, sizeof(hdr)) != sizeof(hdr) || elem.in_len < 1)
+		return VIRTIO_BLK_S_IOERR;
+
+	/* the status byte is the last device writable byte */
+	size_t data_in_len = elem.in_len - 1;
+	size_t data_out_len = elem.out_len - sizeof(hdr);
+	delay += request_latency;
+
+	switch (hdr.type) {
+		case VIRTIO_BLK_T_IN:
+		case VIRTIO_BLK_T_OUT: {
+			bool write = hdr.type == VIRTIO_BLK_T_OUT;
+			size_t len = write ? data_out_len : data_in_len;
+			if (len % SECTOR_SIZE || hdr.sector > capacity || len / SECTOR_SIZE > capacity - hdr.sector)
+				return VIRTIO_BLK_S_IOERR;
+			if (write && read_only)
+				return VIRTIO_BLK_S_IOERR;
+
+			delay += time_per_sector * (double)(len / SECTOR_SIZE);
+			if (!transfer(write, write ? elem.out : elem.in, write ? sizeof(hdr) : 0, len, hdr.sector * SECTOR_SIZE))
+				return VIRTIO_BLK_S_IOERR;
+			if (!write)
+				written = len;
+			return VIRTIO_BLK_S_OK;
+		}
+
+		case VIRTIO_BLK_T_FLUSH:
+			if (!read_only && fdatasync(fd))
+				return VIRTIO_BLK_S_IOERR;
+			return VIRTIO_BLK_S_OK;
+
+		case VIRTIO_BLK_T_GET_ID: {
+			char id[ID_BYTES];
+			memset(id, 0, sizeof(id));
+			strncpy(id, "riscv-vp-virtio-blk", sizeof(id));
+			written = iov_from_buf(elem.in, 0, id, std::min<size_t>(sizeof(id), data_in_len));
+			return VIRTIO_BLK_S_OK;
+		}
+
+		default:
+			return VIRTIO_BLK_S_UNSUPP;
+	}
+}
+
+void VirtioBlk::run(void) {
+	struct Completion {
+		VirtqElement elem;
+		uint32_t len;
+	};
+	std::vector<Completion> batch;
+
+	while (true) {
+		sc_core::wait(notify_event);
+
+		while (true) {
+			unsigned generation = reset_generation;
+			sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+
+			batch.clear();
+			VirtqElement elem;
+			while (queue_pop(0, elem)) {
+				uint32_t written = 0;
+				uint8_t status = handle_request(elem, written, delay);
+				if (elem.in_len > 0)
+					iov_from_buf(elem.in, elem.in_len - 1, &status, 1);
+				batch.push_back({elem, written + 1});
+			}
+			if (batch.empty())
+				break;
+
+			/* complete the whole batch at once -> single interrupt */
+			sc_core::wait(delay);
+			if (generation != reset_generation)
+				continue;
+
+			for (auto &c : batch) queue_push(0, c.elem, c.len);
+			queue_interrupt(0);
+		}
+	}
+}
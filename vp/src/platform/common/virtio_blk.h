@@ -0,0 +1,64 @@
+#ifndef RISCV_VP_VIRTIO_BLK_H
+#define RISCV_VP_VIRTIO_BLK_H
+
+#include <stdint.h>
+
+#include <string>
+#include <systemc>
+#include <vector>
+
+#include "virtio_mmio.h"
+
+/*
+ * Virtio block device
+ * implemented after
+ * "
+ * Virtual I/O Device (VIRTIO) Version 1.1
+ * Section 5.2 (Block Device)
+ * "
+ *
+ * Backed by an image file, data is transferred with preadv/pwritev directly from/to guest memory. All requests
+ * available on a notification are processed as one batch, which completes after the modelled latency with a single
+ * interrupt. The image is opened read-only (VIRTIO_BLK_F_RO) if it is not writable. Without an image, the device is an
+ * empty virtio-mmio slot.
+ *
+ * Device tree (linux-vp):
+ *   virtio@10080000 {
+ *       compatible = "virtio,mmio";
+ *       reg = <0x0 0x10080000 0x0 0x1000>;
+ *       interrupt-parent = <&plic>;
+ *       interrupts = <23>;
+ *   };
+ */
+class VirtioBlk : public VirtioMMIO {
+   public:
+	VirtioBlk(sc_core::sc_module_name, const std::string &image_file, uint32_t irq_number);
+	~VirtioBlk(void);
+
+	SC_HAS_PROCESS(VirtioBlk);
+
+   protected:
+	uint64_t get_device_features(void) override;
+	void read_config(uint64_t offset, uint8_t *dst, unsigned len) override;
+	void queue_notify(unsigned queue) override;
+	void device_reset(void) override;
+
+   private:
+	/* timing model: per request latency + transfer time */
+	const sc_core::sc_time request_latency = sc_core::sc_time(10, sc_core::SC_US);
+	const sc_core::sc_time time_per_sector = sc_core::sc_time(250, sc_core::SC_NS);  // ~2GB/s
+
+	int fd = -1;
+	bool read_only = false;
+	uint64_t capacity = 0;  // [sectors]
+
+	sc_core::sc_event notify_event;
+	/* incremented on device reset, drops requests of a batch in flight */
+	unsigned reset_generation = 0;
+
+	uint8_t handle_request(VirtqElement &elem, uint32_t &written, sc_core::sc_time &delay);
+	bool transfer(bool write, const std::vector<struct iovec> &iov, size_t iov_offset, size_t len, uint64_t offset);
+	void run(void);
+};
+
+#endif  // RISCV_VP_VIRTIO_BLK_H
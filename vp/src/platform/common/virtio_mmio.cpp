@@ -0,0 +1,409 @@
+#include "virtio_mmio.h"
+
+#include <string.h>
+
+#include <iostream>
+
+enum {
+	REG_MAGIC_VALUE = 0x000,
+	REG_VERSION = 0x004,
+	REG_DEVICE_ID = 0x008,
+	REG_VENDOR_ID = 0x00c,
+	REG_DEVICE_FEATURES = 0x010,
+	REG_DEVICE_FEATURES_SEL = 0x014,
+	REG_DRIVER_FEATURES = 0x020,
+	REG_DRIVER_FEATURES_SEL = 0x024,
+	REG_QUEUE_SEL = 0x030,
+	REG_QUEUE_NUM_MAX = 0x034,
+	REG_QUEUE_NUM = 0x038,
+	REG_QUEUE_READY = 0x044,
+	REG_QUEUE_NOTIFY = 0x050,
+	REG_INTERRUPT_STATUS = 0x060,
+	REG_INTERRUPT_ACK = 0x064,
+	REG_STATUS = 0x070,
+	REG_QUEUE_DESC_LOW = 0x080,
+	REG_QUEUE_DESC_HIGH = 0x084,
+	REG_QUEUE_DRIVER_LOW = 0x090,
+	REG_QUEUE_DRIVER_HIGH = 0x094,
+	REG_QUEUE_DEVICE_LOW = 0x0a0,
+	REG_QUEUE_DEVICE_HIGH = 0x0a4,
+	REG_CONFIG_GENERATION = 0x0fc,
+	REG_CONFIG = 0x100,
+};
+
+static constexpr uint32_t MAGIC_VALUE = 0x74726976;  // "virt"
+static constexpr uint32_t VERSION = 2;
+static constexpr uint32_t VENDOR_ID = 0x554d4551;  // "QEMU", well known to drivers
+
+/* device status bits */
+static constexpr uint32_t STATUS_DRIVER_OK = 4;
+static constexpr uint32_t STATUS_DEVICE_NEEDS_RESET = 64;
+
+/* interrupt status bits */
+static constexpr uint32_t INT_USED_BUFFER = 1;
+static constexpr uint32_t INT_CONFIG_CHANGE = 2;
+
+/* split virtqueue layout */
+static constexpr uint16_t VIRTQ_DESC_F_NEXT = 1;
+static constexpr uint16_t VIRTQ_DESC_F_WRITE = 2;
+static constexpr uint16_t VIRTQ_DESC_F_INDIRECT = 4;
+static constexpr uint16_t VIRTQ_AVAIL_F_NO_INTERRUPT = 1;
+
+struct VirtqDesc {
+	uint64_t addr;
+	uint32_t len;
+	uint16_t flags;
+	uint16_t next;
+} __attribute__((packed));
+
+struct VirtqAvail {
+	uint16_t flags;
+	uint16_t idx;
+	uint16_t ring[];
+} __attribute__((packed));
+
+struct VirtqUsedElem {
+	uint32_t id;
+	uint32_t len;
+} __attribute__((packed));
+
+struct VirtqUsed {
+	uint16_t flags;
+	uint16_t idx;
+	VirtqUsedElem ring[];
+} __attribute__((packed));
+
+VirtioMMIO::VirtioMMIO(sc_core::sc_module_name, uint32_t device_id, unsigned num_queues, uint16_t queue_num_max,
+                       uint32_t irq_number)
+    : device_id(device_id), queue_num_max(queue_num_max), irq_number(irq_number), queues(num_queues) {
+	tsock.register_b_transport(this, &VirtioMMIO::transport);
+}
+
+VirtioMMIO::~VirtioMMIO(void) {}
+
+uint8_t *VirtioMMIO::guest_ptr(uint64_t addr, uint64_t len) {
+	for (auto &e : dma_ranges) {
+		if (e.contains(addr) && len <= e.get_end() - addr)
+			return e.get_mem_ptr_to_global_addr<uint8_t>(addr);
+	}
+	return nullptr;
+}
+
+bool VirtioMMIO::setup_queue(Virtqueue &q) {
+	q.desc = (VirtqDesc *)guest_ptr(q.desc_addr, sizeof(VirtqDesc) * q.num);
+	q.avail = (VirtqAvail *)guest_ptr(q.driver_addr, sizeof(VirtqAvail) + sizeof(uint16_t) * (q.num + 1));
+	q.used = (VirtqUsed *)guest_ptr(q.device_addr, sizeof(VirtqUsed) + sizeof(VirtqUsedElem) * q.num + 2);
+	q.last_avail_idx = 0;
+	q.used_idx = 0;
+	return q.desc && q.avail && q.used;
+}
+
+void VirtioMMIO::reset(void) {
+	for (auto &q : queues) q = Virtqueue();
+	device_features_sel = 0;
+	driver_features_sel = 0;
+	driver_features = 0;
+	queue_sel = 0;
+	interrupt_status = 0;
+	status = 0;
+	device_reset();
+}
+
+bool VirtioMMIO::driver_ok(void) {
+	return (status & STATUS_DRIVER_OK) && !(status & STATUS_DEVICE_NEEDS_RESET);
+}
+
+bool VirtioMMIO::queue_ready(unsigned queue) {
+	return queue < queues.size() && queues[queue].ready && driver_ok();
+}
+
+void VirtioMMIO::device_needs_reset(const std::string &reason) {
+	std::cerr << name() << ": " << reason << " -> device needs reset" << std::endl;
+	status |= STATUS_DEVICE_NEEDS_RESET;
+	if (status & STATUS_DRIVER_OK)
+		config_interrupt();
+}
+
+bool VirtioMMIO::add_desc(VirtqElement &elem, uint64_t addr, uint32_t len, bool write) {
+	uint8_t *p = guest_ptr(addr, len);
+	if (!p) {
+		device_needs_reset("buffer outside of dma memory");
+		return false;
+	}
+	if (write) {
+		elem.in.push_back({p, len});
+		elem.in_len += len;
+	} else {
+		if (!elem.in.empty()) {
+			device_needs_reset("device readable buffer after device writable buffer");
+			return false;
+		}
+		elem.out.push_back({p, len});
+		elem.out_len += len;
+	}
+	return true;
+}
+
+bool VirtioMMIO::queue_pop(unsigned queue, VirtqElement &elem) {
+	if (!queue_ready(queue))
+		return false;
+
+	Virtqueue &q = queues[queue];
+	uint16_t avail_idx = __atomic_load_n(&q.avail->idx, __ATOMIC_ACQUIRE);
+	if (avail_idx == q.last_avail_idx)
+		return false;
+
+	elem.head = q.avail->ring[q.last_avail_idx % q.num];
+	elem.out.clear();
+	elem.in.clear();
+	elem.out_len = 0;
+	elem.in_len = 0;
+	q.last_avail_idx++;
+
+	VirtqDesc *table = q.desc;
+	unsigned table_size = q.num;
+	uint16_t idx = elem.head;
+	unsigned count = 0;
+	while (true) {
+		if (idx >= table_size || ++count > table_size) {
+			device_needs_reset("invalid descriptor chain");
+			return false;
+		}
+
+		VirtqDesc d = table[idx];
+		if (d.flags & VIRTQ_DESC_F_INDIRECT) {
+			if (table != q.desc || d.len % sizeof(VirtqDesc) || d.len == 0) {
+				device_needs_reset("invalid indirect descriptor");
+				return false;
+			}
+			table = (VirtqDesc *)guest_ptr(d.addr, d.len);
+			if (!table) {
+				device_needs_reset("indirect descriptor table outside of dma memory");
+				return false;
+			}
+			table_size = d.len / sizeof(VirtqDesc);
+			idx = 0;
+			count = 0;
+			continue;
+		}
+
+		if (!add_desc(elem, d.addr, d.len, d.flags & VIRTQ_DESC_F_WRITE))
+			return false;
+
+		if (!(d.flags & VIRTQ_DESC_F_NEXT))
+			break;
+		idx = d.next;
+	}
+
+	return true;
+}
+
+void VirtioMMIO::queue_push(unsigned queue, const VirtqElement &elem, uint32_t len) {
+	if (!queue_ready(queue))
+		return;
+
+	Virtqueue &q = queues[queue];
+	q.used->ring[q.used_idx % q.num] = {elem.head, len};
+	q.used_idx++;
+	__atomic_store_n(&q.used->idx, q.used_idx, __ATOMIC_RELEASE);
+}
+
+void VirtioMMIO::queue_interrupt(unsigned queue) {
+	if (!queue_ready(queue))
+		return;
+
+	if (!(__atomic_load_n(&queues[queue].avail->flags, __ATOMIC_ACQUIRE) & VIRTQ_AVAIL_F_NO_INTERRUPT))
+		trigger_interrupt(INT_USED_BUFFER);
+}
+
+void VirtioMMIO::config_interrupt(void) {
+	config_generation++;
+	trigger_interrupt(INT_CONFIG_CHANGE);
+}
+
+void VirtioMMIO::trigger_interrupt(uint32_t reason) {
+	interrupt_status |= reason;
+	plic->gateway_trigger_interrupt(irq_number);
+}
+
+size_t VirtioMMIO::iov_to_buf(const std::vector<struct iovec> &iov, size_t offset, void *buf, size_t len) {
+	size_t done = 0;
+	for (auto &v : iov) {
+		if (done == len)
+			break;
+		if (offset >= v.iov_len) {
+			offset -= v.iov_len;
+			continue;
+		}
+		size_t n = std::min(v.iov_len - offset, len - done);
+		memcpy((uint8_t *)buf + done, (uint8_t *)v.iov_base + offset, n);
+		done += n;
+		offset = 0;
+	}
+	return done;
+}
+
+size_t VirtioMMIO::iov_from_buf(const std::vector<struct iovec> &iov, size_t offset, const void *buf, size_t len) {
+	size_t done = 0;
+	for (auto &v : iov) {
+		if (done == len)
+			break;
+		if (offset >= v.iov_len) {
+			offset -= v.iov_len;
+			continue;
+		}
+		size_t n = std::min(v.iov_len - offset, len - done);
+		memcpy((uint8_t *)v.iov_base + offset, (const uint8_t *)buf + done, n);
+		done += n;
+		offset = 0;
+	}
+	return done;
+}
+
+uint32_t VirtioMMIO::read_reg(uint64_t addr) {
+	Virtqueue *q = queue_sel < queues.size() ? &queues[queue_sel] : nullptr;
+
+	switch (addr) {
+		case REG_MAGIC_VALUE:
+			return MAGIC_VALUE;
+		case REG_VERSION:
+			return VERSION;
+		case REG_DEVICE_ID:
+			return device_id;
+		case REG_VENDOR_ID:
+			return VENDOR_ID;
+		case REG_DEVICE_FEATURES:
+			if (device_features_sel > 1)
+				return 0;
+			return (get_device_features() | F_VERSION_1) >> (32 * device_features_sel);
+		case REG_QUEUE_NUM_MAX:
+			return q ? queue_num_max : 0;
+		case REG_QUEUE_READY:
+			return q ? q->ready : 0;
+		case REG_INTERRUPT_STATUS:
+			return interrupt_status;
+		case REG_STATUS:
+			return status;
+		case REG_CONFIG_GENERATION:
+			return config_generation;
+		default:
+			return 0;
+	}
+}
+
+void VirtioMMIO::write_reg(uint64_t addr, uint32_t value) {
+	Virtqueue *q = queue_sel < queues.size() ? &queues[queue_sel] : nullptr;
+
+	switch (addr) {
+		case REG_DEVICE_FEATURES_SEL:
+			device_features_sel = value;
+			break;
+		case REG_DRIVER_FEATURES:
+			if (driver_features_sel <= 1) {
+				uint64_t mask = 0xFFFFFFFFull << (32 * driver_features_sel);
+				driver_features = (driver_features & ~mask) | ((uint64_t)value << (32 * driver_features_sel));
+			}
+			break;
+		case REG_DRIVER_FEATURES_SEL:
+			driver_features_sel = value;
+			break;
+		case REG_QUEUE_SEL:
+			queue_sel = value;
+			break;
+		case REG_QUEUE_NUM:
+			if (q && !q->ready)
+				q->num = value;
+			break;
+		case REG_QUEUE_READY:
+			if (!q)
+				break;
+			if (value && !q->ready) {
+				if (q->num == 0 || q->num > queue_num_max || (q->num & (q->num - 1))) {
+					device_needs_reset("invalid queue size");
+					break;
+				}
+				if (!setup_queue(*q)) {
+					device_needs_reset("virtqueue outside of dma memory");
+					break;
+				}
+			}
+			q->ready = value;
+			break;
+		case REG_QUEUE_NOTIFY:
+			if (value < queues.size() && queues[value].ready)
+				queue_notify(value);
+			break;
+		case REG_INTERRUPT_ACK:
+			interrupt_status &= ~value;
+			break;
+		case REG_STATUS:
+			if (value == 0)
+				reset();
+			else
+				status = value;
+			break;
+		case REG_QUEUE_DESC_LOW:
+			if (q && !q->ready)
+				q->desc_addr = (q->desc_addr & ~0xFFFFFFFFull) | value;
+			break;
+		case REG_QUEUE_DESC_HIGH:
+			if (q && !q->ready)
+				q->desc_addr = (q->desc_addr & 0xFFFFFFFFull) | ((uint64_t)value << 32);
+			break;
+		case REG_QUEUE_DRIVER_LOW:
+			if (q && !q->ready)
+				q->driver_addr = (q->driver_addr & ~0xFFFFFFFFull) | value;
+			break;
+		case REG_QUEUE_DRIVER_HIGH:
+			if (q && !q->ready)
+				q->driver_addr = (q->driver_addr & 0xFFFFFFFFull) | ((uint64_t)value << 32);
+			break;
+		case REG_QUEUE_DEVICE_LOW:
+			if (q && !q->ready)
+				q->device_addr = (q->device_addr & ~0xFFFFFFFFull) | value;
+			break;
+		case REG_QUEUE_DEVICE_HIGH:
+			if (q && !q->ready)
+				q->device_addr = (q->device_addr & 0xFFFFFFFFull) | ((uint64_t)value << 32);
+			break;
+		default:
+			break;
+	}
+}
+
+void VirtioMMIO::transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
+	auto addr = trans.get_address();
+	auto cmd = trans.get_command();
+	auto len = trans.get_data_length();
+	auto ptr = trans.get_data_ptr();
+
+	delay += sc_core::sc_time(10, sc_core::SC_NS);
+
+	if (addr >= REG_CONFIG) {
+		if (device_id == DEVICE_ID_NONE)
+			return;
+		if (cmd == tlm::TLM_READ_COMMAND)
+			read_config(addr - REG_CONFIG, ptr, len);
+		else if (cmd == tlm::TLM_WRITE_COMMAND)
+			write_config(addr - REG_CONFIG, ptr, len);
+		return;
+	}
+
+	if (len != 4 || addr % 4) {
+		trans.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
+		return;
+	}
+
+	if (cmd == tlm::TLM_READ_COMMAND) {
+		uint32_t value = read_reg(addr);
+		memcpy(ptr, &value, sizeof(value));
+	} else if (cmd == tlm::TLM_WRITE_COMMAND) {
+		uint32_t value;
+		memcpy(&value, ptr, sizeof(value));
+		/* a placeholder only provides the identification registers */
+		if (device_id != DEVICE_ID_NONE)
+			write_reg(addr, value);
+	} else {
+		trans.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
+	}
+}
@@ -0,0 +1,139 @@
+#ifndef RISCV_VP_VIRTIO_MMIO_H
+#define RISCV_VP_VIRTIO_MMIO_H
+
+#include <stdint.h>
+#include <sys/uio.h>
+#include <tlm_utils/simple_target_socket.h>
+
+#include <systemc>
+#include <vector>
+
+#include "core/common/dmi.h"
+#include "core/common/irq_if.h"
+
+/*
+ * Virtio over MMIO (modern interface, version 2)
+ * implemented after
+ * "
+ * Virtual I/O Device (VIRTIO) Version 1.1
+ * Section 2.6 (Split Virtqueues) and 4.2 (Virtio Over MMIO)
+ * "
+ *
+ * Base class for virtio devices: implements the register interface, feature negotiation, device status and the split
+ * virtqueues. Devices implement the device specific configuration space and the request processing.
+ *
+ * Virtqueues and buffers are accessed zero-copy via host pointers, hence they have to be located in one of the memory
+ * ranges added via add_dma_range (i.e. in RAM). The device is set to DEVICE_NEEDS_RESET on any invalid access.
+ *
+ * A device instantiated with device_id 0 is a placeholder (no device), which is ignored by drivers.
+ */
+class VirtioMMIO : public sc_core::sc_module {
+   public:
+	/* device ids */
+	static constexpr uint32_t DEVICE_ID_NONE = 0;
+	static constexpr uint32_t DEVICE_ID_NET = 1;
+	static constexpr uint32_t DEVICE_ID_BLOCK = 2;
+
+	/* generic feature bits */
+	static constexpr uint64_t F_INDIRECT_DESC = 1ull << 28;
+	static constexpr uint64_t F_VERSION_1 = 1ull << 32;
+
+	tlm_utils::simple_target_socket<VirtioMMIO> tsock;
+	interrupt_gateway *plic = nullptr;
+
+	VirtioMMIO(sc_core::sc_module_name, uint32_t device_id, unsigned num_queues, uint16_t queue_num_max,
+	           uint32_t irq_number);
+	virtual ~VirtioMMIO(void);
+
+	void add_dma_range(const MemoryDMI &dmi) {
+		dma_ranges.push_back(dmi);
+	}
+
+   protected:
+	/* a buffer chain taken from the available ring */
+	struct VirtqElement {
+		uint16_t head;
+		std::vector<struct iovec> out;  // device readable (driver -> device)
+		std::vector<struct iovec> in;   // device writable (device -> driver)
+		size_t out_len = 0;
+		size_t in_len = 0;
+	};
+
+	/* device specific interface */
+	virtual uint64_t get_device_features(void) = 0;
+	virtual void read_config(uint64_t offset, uint8_t *dst, unsigned len) = 0;
+	virtual void write_config(uint64_t offset, const uint8_t *src, unsigned len) {
+		(void)offset;
+		(void)src;
+		(void)len;
+	}
+	/* driver notified the device about new buffers in queue (called in the context of the notifying initiator) */
+	virtual void queue_notify(unsigned queue) = 0;
+	/* driver reset the device */
+	virtual void device_reset(void) {}
+
+	/* virtqueue access for devices */
+	bool driver_ok(void);
+	bool queue_ready(unsigned queue);
+	/* take the next available buffer chain, returns false if none is available (or on error) */
+	bool queue_pop(unsigned queue, VirtqElement &elem);
+	/* return a buffer chain to the driver, len .. number of bytes written into the device writable buffers */
+	void queue_push(unsigned queue, const VirtqElement &elem, uint32_t len);
+	/* interrupt the driver about used buffers, unless suppressed by the driver */
+	void queue_interrupt(unsigned queue);
+	/* interrupt the driver about a configuration change */
+	void config_interrupt(void);
+	/* report an unrecoverable error (e.g. invalid descriptors) to the driver */
+	void device_needs_reset(const std::string &reason);
+
+	uint64_t get_driver_features(void) {
+		return driver_features;
+	}
+
+	/* copy between device and iovecs (starting at offset), returns number of bytes copied */
+	static size_t iov_to_buf(const std::vector<struct iovec> &iov, size_t offset, void *buf, size_t len);
+	static size_t iov_from_buf(const std::vector<struct iovec> &iov, size_t offset, const void *buf, size_t len);
+
+   private:
+	struct Virtqueue {
+		uint16_t num = 0;
+		bool ready = false;
+		uint64_t desc_addr = 0;
+		uint64_t driver_addr = 0;
+		uint64_t device_addr = 0;
+		uint16_t last_avail_idx = 0;
+		uint16_t used_idx = 0;
+
+		/* host pointers, valid if ready */
+		struct VirtqDesc *desc = nullptr;
+		struct VirtqAvail *avail = nullptr;
+		struct VirtqUsed *used = nullptr;
+	};
+
+	uint32_t device_id;
+	uint16_t queue_num_max;
+	uint32_t irq_number;
+
+	std::vector<MemoryDMI> dma_ranges;
+	std::vector<Virtqueue> queues;
+
+	uint32_t device_features_sel = 0;
+	uint32_t driver_features_sel = 0;
+	uint64_t driver_features = 0;
+	uint32_t queue_sel = 0;
+	uint32_t interrupt_status = 0;
+	uint32_t status = 0;
+	uint32_t config_generation = 0;
+
+	uint8_t *guest_ptr(uint64_t addr, uint64_t len);
+	bool setup_queue(Virtqueue &q);
+	bool add_desc(VirtqElement &elem, uint64_t addr, uint32_t len, bool write);
+	void reset(void);
+	void trigger_interrupt(uint32_t reason);
+
+	uint32_t read_reg(uint64_t addr);
+	void write_reg(uint64_t addr, uint32_t value);
+	void transport(tlm::tlm_generic_payload &, sc_core::sc_time &);
+};
+
+#endif  // RISCV_VP_VIRTIO_MMIO_H
@@ -0,0 +1,212 @@
+#include "virtio_net.h"
+
+#include <err.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <system_error>
+
+/* feature bits */
+static constexpr uint64_t VIRTIO_NET_F_MAC = 1ull << 5;
+
+struct VirtioNetHeader {
+	uint8_t flags;
+	uint8_t gso_type;
+	uint16_t hdr_len;
+	uint16_t gso_size;
+	uint16_t csum_start;
+	uint16_t csum_offset;
+	uint16_t num_buffers;
+} __attribute__((packed));
+
+VirtioNet::VirtioNet(sc_core::sc_module_name name, const std::string &backend_spec, const std::string &mac_str,
+                     uint32_t irq_number)
+    : VirtioMMIO(name, backend_spec.empty() ? DEVICE_ID_NONE : DEVICE_ID_NET, 2, 256, irq_number) {
+	parse_mac(mac_str);
+	if (backend_spec.empty())
+		return;
+
+	backend = NetBackend::create(backend_spec);
+
+	if (pipe(stop_pipe) == -1)
+		throw std::system_error(errno, std::generic_category());
+	rx_thread = new std::thread(&VirtioNet::receive, this);
+
+	SC_THREAD(run_rx);
+	SC_THREAD(run_tx);
+}
+
+VirtioNet::~VirtioNet(void) {
+	if (rx_thread) {
+		{
+			std::lock_guard<std::mutex> lock(rx_mutex);
+			stop = true;
+		}
+		rx_cond.notify_all();
+		uint8_t byte = 0;
+		if (write(stop_pipe[1], &byte, sizeof(byte)) == -1)
+			err(EXIT_FAILURE, "couldn't unblock virtio-net receive thread");
+		rx_thread->join();
+		delete rx_thread;
+
+		close(stop_pipe[0]);
+		close(stop_pipe[1]);
+	}
+}
+
+void VirtioNet::parse_mac(const std::string &str) {
+	unsigned int b[6];
+	if (sscanf(str.c_str(), "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6)
+		throw std::invalid_argument("invalid mac address: " + str);
+	for (unsigned i = 0; i < 6; i++) mac[i] = b[i];
+}
+
+uint64_t VirtioNet::get_device_features(void) {
+	return F_INDIRECT_DESC | VIRTIO_NET_F_MAC;
+}
+
+void VirtioNet::read_config(uint64_t offset, uint8_t *dst, unsigned len) {
+	memset(dst, 0, len);
+	if (offset < sizeof(mac))
+		memcpy(dst, mac + offset, std::min<uint64_t>(len, sizeof(mac) - offset));
+}
+
+void VirtioNet::queue_notify(unsigned queue) {
+	if (queue == RX_QUEUE)
+		rx_buffers_event.notify(sc_core::SC_ZERO_TIME);
+	else if (queue == TX_QUEUE)
+		tx_event.notify(sc_core::SC_ZERO_TIME);
+}
+
+void VirtioNet::device_reset(void) {
+	reset_generation++;
+}
+
+void VirtioNet::receive(void) {
+	struct pollfd fds[2] = {
+	    {.fd = stop_pipe[0], .events = POLLIN, .revents = 0},
+	    {.fd = backend->get_fd(), .events = POLLIN, .revents = 0},
+	};
+	bool blocking = fds[1].fd >= 0;
+	std::vector<uint8_t> frame;
+
+	while (true) {
+		if (blocking) {
+			if (poll(fds, 2, -1) == -1) {
+				if (errno == EINTR)
+					continue;
+				throw std::system_error(errno, std::generic_category());
+			}
+			if (fds[0].revents & POLLIN)
+				break;
+		}
+
+		if (!backend->receive(frame)) {
+			if (blocking)
+				continue;
+			break;  // no more frames
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(rx_mutex);
+			rx_cond.wait(lock, [this] { return stop || rx_frames.size() < MAX_PENDING_FRAMES; });
+			if (stop)
+				break;
+			rx_frames.push_back(std::move(frame));
+		}
+		rx_event.notify();
+	}
+}
+
+void VirtioNet::run_rx(void) {
+	struct Completion {
+		VirtqElement elem;
+		uint32_t len;
+	};
+	std::vector<Completion> batch;
+
+	while (true) {
+		sc_core::wait(static_cast<const sc_core::sc_event &>(rx_event) | rx_buffers_event);
+
+		while (true) {
+			unsigned generation = reset_generation;
+			sc_core::sc_time delay = batch_latency;
+
+			batch.clear();
+			while (true) {
+				std::vector<uint8_t> frame;
+				{
+					std::lock_guard<std::mutex> lock(rx_mutex);
+					if (rx_frames.empty())
+						break;
+					/* only take the frame if there is a buffer for it */
+					VirtqElement elem;
+					if (!queue_pop(RX_QUEUE, elem))
+						break;
+					frame = std::move(rx_frames.front());
+					rx_frames.pop_front();
+
+					VirtioNetHeader hdr;
+					memset(&hdr, 0, sizeof(hdr));
+					hdr.num_buffers = 1;
+					uint32_t len = 0;
+					/* frames which do not fit are dropped (the buffer is returned empty) */
+					if (elem.in_len >= sizeof(hdr) + frame.size()) {
+						len = iov_from_buf(elem.in, 0, &hdr, sizeof(hdr));
+						len += iov_from_buf(elem.in, sizeof(hdr), frame.data(), frame.size());
+						delay += time_per_byte * (double)frame.size();
+					}
+					batch.push_back({elem, len});
+				}
+				rx_cond.notify_one();
+			}
+			if (batch.empty())
+				break;
+
+			sc_core::wait(delay);
+			if (generation != reset_generation)
+				continue;
+
+			for (auto &c : batch) queue_push(RX_QUEUE, c.elem, c.len);
+			queue_interrupt(RX_QUEUE);
+		}
+	}
+}
+
+void VirtioNet::run_tx(void) {
+	std::vector<VirtqElement> batch;
+	std::vector<uint8_t> frame;
+
+	while (true) {
+		sc_core::wait(tx_event);
+
+		while (true) {
+			unsigned generation = reset_generation;
+			sc_core::sc_time delay = batch_latency;
+
+			batch.clear();
+			VirtqElement elem;
+			while (queue_pop(TX_QUEUE, elem)) {
+				if (elem.out_len > sizeof(VirtioNetHeader)) {
+					frame.resize(elem.out_len - sizeof(VirtioNetHeader));
+					iov_to_buf(elem.out, sizeof(VirtioNetHeader), frame.data(), frame.size());
+					backend->send(frame.data(), frame.size());
+					delay += time_per_byte * (double)frame.size();
+				}
+				batch.push_back(elem);
+			}
+			if (batch.empty())
+				break;
+
+			sc_core::wait(delay);
+			if (generation != reset_generation)
+				continue;
+
+			for (auto &e : batch) queue_push(TX_QUEUE, e, 0);
+			queue_interrupt(TX_QUEUE);
+		}
+	}
+}
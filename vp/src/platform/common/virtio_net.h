@@ -0,0 +1,85 @@
+#ifndef RISCV_VP_VIRTIO_NET_H
+#define RISCV_VP_VIRTIO_NET_H
+
+#include <stdint.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <systemc>
+#include <thread>
+#include <vector>
+
+#include "async_event.h"
+#include "net_backend.h"
+#include "virtio_mmio.h"
+
+/*
+ * Virtio network device
+ * implemented after
+ * "
+ * Virtual I/O Device (VIRTIO) Version 1.1
+ * Section 5.1 (Network Device)
+ * "
+ *
+ * Ethernet frames are exchanged with a NetBackend (see net_backend.h). Received frames are read by a host thread into
+ * a bounded queue and moved into the guest receive buffers by the simulation. Both directions work in batches: all
+ * frames which are available (and fit into the posted buffers) are handled at once and completed after the modelled
+ * latency with a single interrupt. No offloads are supported, every frame has to fit into a single receive buffer.
+ *
+ * Device tree (linux-vp):
+ *   virtio@10081000 {
+ *       compatible = "virtio,mmio";
+ *       reg = <0x0 0x10081000 0x0 0x1000>;
+ *       interrupt-parent = <&plic>;
+ *       interrupts = <24>;
+ *   };
+ */
+class VirtioNet : public VirtioMMIO {
+   public:
+	/* backend_spec empty -> empty virtio-mmio slot */
+	VirtioNet(sc_core::sc_module_name, const std::string &backend_spec, const std::string &mac, uint32_t irq_number);
+	~VirtioNet(void);
+
+	SC_HAS_PROCESS(VirtioNet);
+
+   protected:
+	uint64_t get_device_features(void) override;
+	void read_config(uint64_t offset, uint8_t *dst, unsigned len) override;
+	void queue_notify(unsigned queue) override;
+	void device_reset(void) override;
+
+   private:
+	static constexpr unsigned RX_QUEUE = 0;
+	static constexpr unsigned TX_QUEUE = 1;
+	static constexpr size_t MAX_PENDING_FRAMES = 256;
+
+	/* timing model: per batch latency + transfer time */
+	const sc_core::sc_time batch_latency = sc_core::sc_time(5, sc_core::SC_US);
+	const sc_core::sc_time time_per_byte = sc_core::sc_time(1, sc_core::SC_NS);  // ~1GB/s
+
+	std::unique_ptr<NetBackend> backend;
+	uint8_t mac[6];
+
+	/* frames received by the host thread, waiting for guest buffers */
+	std::mutex rx_mutex;
+	std::condition_variable rx_cond;
+	std::deque<std::vector<uint8_t>> rx_frames;
+	bool stop = false;
+	int stop_pipe[2] = {-1, -1};
+	std::thread *rx_thread = nullptr;
+
+	AsyncEvent rx_event;
+	sc_core::sc_event rx_buffers_event;
+	sc_core::sc_event tx_event;
+	unsigned reset_generation = 0;
+
+	void parse_mac(const std::string &str);
+	void receive(void);
+	void run_rx(void);
+	void run_tx(void);
+};
+
+#endif  // RISCV_VP_VIRTIO_NET_H
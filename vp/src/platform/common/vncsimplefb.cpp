@@ -1,19 +1,17 @@
 #include "vncsimplefb.h"
 
+#include "core/common/host_profiler.h"
+#include "util/dirty_pages.h"
+
 #define REFRESH_RATE 30 /* Hz */
 #define WIDTH 800
 #define HEIGHT 480
 #define BPP 2 /* rgb565 */
 #define SIZE (WIDTH * HEIGHT * BPP)
 
-/* Area tracking is more costly to simulation than full update in rfb thread */
-//#define TRACK_CHANGED_AREA
-#undef TRACK_CHANGED_AREA
-
-VNCSimpleFB::VNCSimpleFB(sc_core::sc_module_name, VNCServer &vncServer) : vncServer(vncServer) {
+VNCSimpleFB::VNCSimpleFB(sc_core::sc_module_name, VNCServer &vncServer) : vncServer(vncServer), frameBuffer(SIZE) {
 	tsock.register_b_transport(this, &VNCSimpleFB::transport);
-
-	areaChangedReset();
+	tsock.register_get_direct_mem_ptr(this, &VNCSimpleFB::get_direct_mem_ptr);
 
 	vncServer.setScreenProperties(WIDTH, HEIGHT, 5, 3, BPP);
 
@@ -33,19 +31,9 @@ void VNCSimpleFB::fb_access_callback(tlm::tlm_generic_payload &trans, sc_core::s
 	}
 
 	if (trans.get_command() == tlm::TLM_WRITE_COMMAND) {
-		mutex.lock();
-
-		/* update */
 		memcpy(&frameBuffer[addr], trans.get_data_ptr(), len);
-
-		/* keep track of and signal changed area */
-		areaChangedSet(addr, len);
-
-		mutex.unlock();
-
 	} else if (trans.get_command() == tlm::TLM_READ_COMMAND) {
 		memcpy(trans.get_data_ptr(), &frameBuffer[addr], len);
-
 	} else {
 		throw std::runtime_error("unsupported TLM command detected");
 	}
@@ -55,49 +43,21 @@ void VNCSimpleFB::transport(tlm::tlm_generic_payload &trans, sc_core::sc_time &d
 	router.transport(trans, delay);
 }
 
-void VNCSimpleFB::areaChangedReset() {
-	areaChanged = false;
-#ifdef TRACK_CHANGED_AREA
-	xMin = WIDTH;
-	yMin = HEIGHT;
-	xMax = 0;
-	yMax = 0;
-#endif
-}
-
-void VNCSimpleFB::areaChangedSet(uint32_t addr, uint32_t len) {
-#ifdef TRACK_CHANGED_AREA
-	uint32_t y_start = addr / (WIDTH * BPP);
-	uint32_t x_start = (addr - (y_start * WIDTH * BPP)) / BPP;
-	uint32_t y_end = (addr + len + BPP - 1) / (WIDTH * BPP);
-	uint32_t x_end = ((addr + len + BPP - 1) - (y_end * WIDTH * BPP)) / BPP;
-	xMin = std::min(xMin, x_start);
-	yMin = std::min(yMin, y_start);
-	xMax = std::max(xMax, x_end);
-	yMax = std::max(yMax, y_end);
-#endif
-	areaChanged = true;
+bool VNCSimpleFB::get_direct_mem_ptr(tlm::tlm_generic_payload &, tlm::tlm_dmi &dmi) {
+	dmi.set_start_address(0);
+	dmi.set_end_address(SIZE - 1);
+	dmi.set_dmi_ptr(frameBuffer.data());
+	dmi.allow_read_write();
+	return true;
 }
 
 void VNCSimpleFB::updateScreen() {
-	mutex.lock();
-
-	if (!areaChanged) {
-		mutex.unlock();
-		return;
-	}
-
-#ifdef TRACK_CHANGED_AREA
-	/* trigger update for modified area */
-	vncServer.markRectAsModified(xMin, yMin, xMax + 1, yMax + 1);
-#else
-	/* trigger update for full framebuffer */
-	vncServer.markRectAsModified(0, 0, WIDTH, HEIGHT);
-#endif
-
-	areaChangedReset();
-
-	mutex.unlock();
+	/* copy modified pages to the screen and trigger an update of the affected rows */
+	vp::sync_dirty_pages(frameBuffer.data(), vncServer.getFrameBuffer(), SIZE, [this](size_t offset, size_t len) {
+		int y1 = offset / (WIDTH * BPP);
+		int y2 = (offset + len + WIDTH * BPP - 1) / (WIDTH * BPP);
+		vncServer.markRectAsModified(0, y1, WIDTH, y2);
+	});
 }
 
 void VNCSimpleFB::updateProcess() {
@@ -114,10 +74,12 @@ void VNCSimpleFB::updateProcess() {
 	rfbScreen->serverFormat.bitsPerPixel = BPP * 8;
 	rfbScreen->serverFormat.bigEndian = false;
 
-	frameBuffer = vncServer.getFrameBuffer();
-
+	HostProfiler::Section *profile = HostProfiler::instance().get_process_section();
 	while (vncServer.isActive()) {
-		updateScreen();
+		{
+			HostProfiler::Scope scope(profile);
+			updateScreen();
+		}
 		wait(1000000L / REFRESH_RATE, sc_core::SC_US);
 	}
 
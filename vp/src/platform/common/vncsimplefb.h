@@ -4,6 +4,7 @@
 #include <tlm_utils/simple_target_socket.h>
 
 #include <systemc>
+#include <vector>
 
 #include "util/tlm_map.h"
 #include "util/vncserver.h"
@@ -11,6 +12,10 @@
 /*
  * Simple framebuffer modules using libvncserver
  * (use with linux simple-framebuffer
+ *
+ * The framebuffer is a plain buffer, which can also be accessed via DMI (see get_frame_buffer). Changes are detected
+ * at every refresh by comparing the framebuffer page-wise with the VNC screen buffer, only the modified rows are
+ * copied and sent to the clients.
  */
 class VNCSimpleFB : public sc_core::sc_module {
    public:
@@ -20,18 +25,20 @@ class VNCSimpleFB : public sc_core::sc_module {
 
 	SC_HAS_PROCESS(VNCSimpleFB);
 
+	uint8_t *get_frame_buffer() {
+		return frameBuffer.data();
+	}
+	size_t get_frame_buffer_size() {
+		return frameBuffer.size();
+	}
+
    private:
 	VNCServer &vncServer;
-	uint8_t *frameBuffer;
-	sc_core::sc_mutex mutex;
-	bool areaChanged;
-	uint32_t xMin, yMin, xMax, yMax;
+	std::vector<uint8_t> frameBuffer;
 
 	void fb_access_callback(tlm::tlm_generic_payload &trans, sc_core::sc_time);
 	void transport(tlm::tlm_generic_payload &, sc_core::sc_time &);
-
-	void areaChangedReset();
-	void areaChangedSet(uint32_t addr, uint32_t len);
+	bool get_direct_mem_ptr(tlm::tlm_generic_payload &, tlm::tlm_dmi &);
 
 	void updateScreen();
 	void updateProcess();
@@ -1,5 +1,7 @@
 #include "vncsimpleinputkbd.h"
 
+#include "core/common/idle_detector.h"
+
 #define KBD_EVENT_QUEUE_SIZE 10
 #define REFRESH_RATE 30 /* Hz */
 
@@ -44,6 +46,7 @@ void VNCSimpleInputKbd::doKbd(rfbBool down, rfbKeySym key) {
 		               (down ? REG_KEY_PRESSED_BIT : 0);
 		kbdEvents.push(key);
 		interrupt = true;
+		IdleDetector::instance().notify_host_input();
 	}
 	mutex.unlock();
 }
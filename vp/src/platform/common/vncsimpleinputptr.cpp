@@ -1,5 +1,7 @@
 #include "vncsimpleinputptr.h"
 
+#include "core/common/idle_detector.h"
+
 #define PTR_EVENT_QUEUE_SIZE 10
 #define REFRESH_RATE 30 /* Hz */
 
@@ -46,6 +48,7 @@ void VNCSimpleInputPtr::doPtr(int buttonMask, int x, int y) {
 	if (IS_ENABLED() && (ptrEvents.size() < PTR_EVENT_QUEUE_SIZE)) {
 		ptrEvents.push(std::make_tuple(REG_BUTTONMASK_DATA_AVAIL_BIT | buttonMask, x, y));
 		interrupt = true;
+		IdleDetector::instance().notify_host_input();
 	}
 	mutex.unlock();
 }
@@ -12,6 +12,7 @@
 #include "gpio.h"
 #include "nuclei_core/nuclei_iss.h"
 #include "nuclei_core/nuclei_mem.h"
+#include "platform/common/instrumentation.h"
 #include "platform/common/memory.h"
 #include "platform/common/options.h"
 #include "rcu.h"
@@ -203,6 +204,13 @@ int sc_main(int argc, char **argv) {
 	threads.push_back(&core);
 
 	core.enable_trace(opt.trace_mode);  // switch for printing instructions
+
+	Instrumentation instrumentation(opt);
+	instrumentation.add_program(loader);
+	instrumentation.add_core(core, iss_mem_if);
+	instrumentation.add_bus(ahb);
+	instrumentation.start();
+
 	if (opt.use_debug_runner) {
 		auto server = new GDBServer("GDBServer", threads, &dbg_if, opt.debug_port);
 		new GDBServerRunner("GDBRunner", server, &core);
@@ -218,6 +226,7 @@ int sc_main(int argc, char **argv) {
 	}
 
 	sc_core::sc_start();
+	instrumentation.finish();
 
 	core.show();
 
@@ -22,6 +22,7 @@
 #include "mem.h"
 #include "memory.h"
 #include "oled/oled.hpp"
+#include "platform/common/instrumentation.h"
 #include "platform/common/options.h"
 #include "platform/common/sifive_spi.h"
 #include "prci.h"
@@ -290,6 +291,13 @@ int sc_main(int argc, char **argv) {
 	threads.push_back(&core);
 
 	core.enable_trace(opt.trace_mode);  // switch for printing instructions
+
+	Instrumentation instrumentation(opt);
+	instrumentation.add_program(loader);
+	instrumentation.add_core(core, iss_mem_if);
+	instrumentation.add_bus(bus);
+	instrumentation.start();
+
 	if (opt.use_debug_runner) {
 		auto server = new GDBServer("GDBServer", threads, &dbg_if, opt.debug_port);
 		new GDBServerRunner("GDBRunner", server, &core);
@@ -305,6 +313,7 @@ int sc_main(int argc, char **argv) {
 	}
 
 	sc_core::sc_start();
+	instrumentation.finish();
 
 	core.show();
 
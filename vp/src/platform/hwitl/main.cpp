@@ -18,6 +18,7 @@
 #include "iss.h"
 #include "mem.h"
 #include "memory.h"
+#include "platform/common/instrumentation.h"
 #include "platform/common/options.h"
 #include "platform/common/terminal.h"
 #include "syscall.h"
@@ -214,6 +215,13 @@ int sc_main(int argc, char** argv) {
 	threads.push_back(&core);
 
 	core.enable_trace(opt.trace_mode);  // switch for printing instructions
+
+	Instrumentation instrumentation(opt);
+	instrumentation.add_program(loader);
+	instrumentation.add_core(core, iss_mem_if);
+	instrumentation.add_bus(bus);
+	instrumentation.start();
+
 	if (opt.use_debug_runner) {
 		auto server = new GDBServer("GDBServer", threads, &dbg_if, opt.debug_port);
 		new GDBServerRunner("GDBRunner", server, &core);
@@ -222,6 +230,7 @@ int sc_main(int argc, char** argv) {
 	}
 
 	sc_core::sc_start();
+	instrumentation.finish();
 
 	core.show();
 
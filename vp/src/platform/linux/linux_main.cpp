@@ -7,6 +7,7 @@
 #include <ctime>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 
 #include "core/common/clint.h"
 #include "core/common/lwrt_clint.h"
@@ -21,7 +22,9 @@
 #include "memory.h"
 #include "memory_mapped_file.h"
 #include "mmu.h"
+#include "platform/common/fork_server.h"
 #include "platform/common/fu540_gpio.h"
+#include "platform/common/instrumentation.h"
 #include "platform/common/miscdev.h"
 #include "platform/common/options.h"
 #include "platform/common/sifive_spi.h"
@@ -29,6 +32,8 @@
 #include "platform/common/slip.h"
 #include "platform/common/spi_sd_card.h"
 #include "platform/common/uart.h"
+#include "platform/common/virtio_blk.h"
+#include "platform/common/virtio_net.h"
 #include "platform/common/vncsimplefb.h"
 #include "platform/common/vncsimpleinputkbd.h"
 #include "platform/common/vncsimpleinputptr.h"
@@ -71,9 +76,9 @@ namespace po = boost::program_options;
 
 struct LinuxOptions : public Options {
    public:
-	typedef unsigned int addr_t;
+	typedef uint64_t addr_t;
 
-	addr_t mem_size = 1024u * 1024u * (unsigned int)(MEM_SIZE_MB);
+	addr_t mem_size = 1024u * 1024u * (addr_t)(MEM_SIZE_MB);
 	addr_t mem_start_addr = 0x80000000;
 	addr_t mem_end_addr = mem_start_addr + mem_size - 1;
 	addr_t clint_start_addr = 0x02000000;
@@ -110,36 +115,52 @@ struct LinuxOptions : public Options {
 	addr_t vncsimpleinputkbd_start_addr = 0x12001000;
 	addr_t vncsimpleinputkbd_end_addr = 0x12001fff;
 	addr_t mram_root_start_addr = 0x40000000;
-	addr_t mram_root_size = 1024u * 1024u * (unsigned int)(MRAM_SIZE_MB);
+	addr_t mram_root_size = 1024u * 1024u * (addr_t)(MRAM_SIZE_MB);
 	addr_t mram_root_end_addr = mram_root_start_addr + mram_root_size - 1;
 	addr_t mram_data_start_addr = 0x60000000;
-	addr_t mram_data_size = 1024u * 1024u * (unsigned int)(MRAM_SIZE_MB);
+	addr_t mram_data_size = 1024u * 1024u * (addr_t)(MRAM_SIZE_MB);
 	addr_t mram_data_end_addr = mram_data_start_addr + mram_data_size - 1;
+	addr_t virtio_blk_start_addr = 0x10080000;
+	addr_t virtio_blk_end_addr = 0x10080fff;
+	addr_t virtio_net_start_addr = 0x10081000;
+	addr_t virtio_net_end_addr = 0x10081fff;
 
 	OptionValue<unsigned long> entry_point;
 	std::string dtb_file;
 	std::string kernel_file;
+	bool map_kernel_file = false;
 	std::string tun_device = "tun0";
 	std::string mram_root_image;
 	std::string mram_data_image;
 	std::string sd_card_image;
+	std::string virtio_blk_image;
+	std::string virtio_net_backend;
+	std::string virtio_net_mac = "52:54:00:12:34:56";
+	std::string fork_server_socket;
+	unsigned int fork_server_jobs = 1;
 
 	unsigned int vnc_port = 5900;
 
 	LinuxOptions(void) {
 		// clang-format off
 		add_options()
-			("memory-start", po::value<unsigned int>(&mem_start_addr),"set memory start address")
-			("memory-size", po::value<unsigned int>(&mem_size), "set memory size")
+			("memory-start", po::value<addr_t>(&mem_start_addr),"set memory start address")
+			("memory-size", po::value<addr_t>(&mem_size), "set memory size")
 			("entry-point", po::value<std::string>(&entry_point.option),"set entry point address (ISS program counter)")
 			("dtb-file", po::value<std::string>(&dtb_file)->required(), "dtb file for boot loading")
 			("kernel-file", po::value<std::string>(&kernel_file), "optional kernel file to load (supports ELF or RAW files)")
+			("map-kernel-file", po::bool_switch(&map_kernel_file), "map a RAW kernel file copy-on-write into memory instead of copying it")
 			("tun-device", po::value<std::string>(&tun_device), "tun device used by SLIP")
 			("mram-root-image", po::value<std::string>(&mram_root_image)->default_value(""),"MRAM root image file")
-			("mram-root-image-size", po::value<unsigned int>(&mram_root_size), "MRAM root image size")
+			("mram-root-image-size", po::value<addr_t>(&mram_root_size), "MRAM root image size")
 			("mram-data-image", po::value<std::string>(&mram_data_image)->default_value(""),"MRAM data image file for persistency")
-			("mram-data-image-size", po::value<unsigned int>(&mram_data_size), "MRAM data image size")
+			("mram-data-image-size", po::value<addr_t>(&mram_data_size), "MRAM data image size")
 			("sd-card-image", po::value<std::string>(&sd_card_image)->default_value(""), "SD-Card image file (size must be multiple of 512 bytes)")
+			("virtio-blk-image", po::value<std::string>(&virtio_blk_image)->default_value(""), "virtio block device image file (see virtio_blk.h for the device tree node)")
+			("virtio-net-backend", po::value<std::string>(&virtio_net_backend)->default_value(""), "virtio network device backend: tap:<ifname>, loopback, unix:<local>:<remote> or pcap:<in>:<out> (see net_backend.h)")
+			("virtio-net-mac", po::value<std::string>(&virtio_net_mac), "mac address of the virtio network device")
+			("fork-server", po::value<std::string>(&fork_server_socket), "serve test runs from the state signaled by the guest via MiscDev on this unix socket (see fork_server.h)")
+			("fork-server-jobs", po::value<unsigned int>(&fork_server_jobs), "maximum number of concurrently running fork server children")
 			("vnc-port", po::value<unsigned int>(&vnc_port), "select port number to connect with VNC");
 		// clang-format on
 	}
@@ -187,21 +208,23 @@ class Core {
 	}
 };
 
-void handle_kernel_file(const LinuxOptions opt, SimpleMemory &mem) {
-	if (opt.kernel_file.size() == 0) {
+void handle_kernel_file(const LinuxOptions opt, ELFLoader *elf, SimpleMemory &mem) {
+	if (elf == nullptr) {
 		return;
 	}
 
 	std::cout << "Info: load kernel file \"" << opt.kernel_file << "\" ";
-	ELFLoader elf(opt.kernel_file.c_str());
-	if (elf.is_elf()) {
+	if (elf->is_elf()) {
 		/* load elf (use physical addresses) */
 		std::cout << "as ELF file (to physical addresses defined in ELF)";
-		elf.load_executable_image(mem, mem.size, opt.mem_start_addr, false);
+		elf->load_executable_image(mem, mem.size, opt.mem_start_addr, false);
 	} else {
 		/* load raw to KERNEL_LOAD_ADDR */
 		std::cout << "as RAW file (to 0x" << std::hex << KERNEL_LOAD_ADDR << std::dec << ")";
-		mem.load_binary_file(opt.kernel_file, KERNEL_LOAD_ADDR - opt.mem_start_addr);
+		if (opt.map_kernel_file)
+			mem.map_binary_file(opt.kernel_file, KERNEL_LOAD_ADDR - opt.mem_start_addr);
+		else
+			mem.load_binary_file(opt.kernel_file, KERNEL_LOAD_ADDR - opt.mem_start_addr);
 	}
 	std::cout << std::endl;
 }
@@ -225,11 +248,14 @@ int sc_main(int argc, char **argv) {
 	SimpleMemory mem("SimpleMemory", opt.mem_size);
 	SimpleMemory dtb_rom("DTB_ROM", opt.dtb_rom_size);
 	ELFLoader loader(opt.input_program.c_str());
+	std::unique_ptr<ELFLoader> kernel;
+	if (opt.kernel_file.size() != 0)
+		kernel.reset(new ELFLoader(opt.kernel_file.c_str()));
 	NetTrace *debug_bus = nullptr;
 	if (opt.use_debug_bus) {
 		debug_bus = new NetTrace(opt.debug_bus_port);
 	}
-	SimpleBus<NUM_CORES + 1, 19> bus("SimpleBus", debug_bus, opt.break_on_transaction);
+	SimpleBus<NUM_CORES + 1, 21> bus("SimpleBus", debug_bus, opt.break_on_transaction);
 	SyscallHandler sys("SyscallHandler");
 	FU540_PLIC plic("PLIC", NUM_CORES);
 	LWRT_CLINT<NUM_CORES> clint("CLINT");
@@ -250,8 +276,23 @@ int sc_main(int argc, char **argv) {
 	VNCSimpleInputKbd vncsimpleinputkbd("VNCSimpleInputKbd", vncServer, 11);
 	DebugMemoryInterface dbg_if("DebugMemoryInterface");
 	MemoryDMI dmi = MemoryDMI::create_start_size_mapping(mem.data, opt.mem_start_addr, mem.size);
+	spi0.add_dma_range(dmi);
+	spi1.add_dma_range(dmi);
+	spi2.add_dma_range(dmi);
 	MemoryMappedFile mramRoot("MRAM_Root", opt.mram_root_image, opt.mram_root_size);
 	MemoryMappedFile mramData("MRAM_Data", opt.mram_data_image, opt.mram_data_size);
+	VirtioBlk virtio_blk("VirtioBlk", opt.virtio_blk_image, 23);
+	virtio_blk.add_dma_range(dmi);
+	VirtioNet virtio_net("VirtioNet", opt.virtio_net_backend, opt.virtio_net_mac, 24);
+	virtio_net.add_dma_range(dmi);
+
+	std::unique_ptr<ForkServer> fork_server;
+	if (opt.fork_server_socket.length()) {
+		fork_server = std::make_unique<ForkServer>(opt.fork_server_socket, opt.fork_server_jobs);
+		fork_server->before_fork.push_back([&uart0] { uart0.stop_io(); });
+		fork_server->in_child.push_back([&uart0] { uart0.start_io(); });
+		miscdev.fork_server = fork_server.get();
+	}
 
 	SPI_SD_Card spi_sd_card(&spi2, 0, &gpio, 11, false);
 	if (opt.sd_card_image.length()) {
@@ -275,9 +316,14 @@ int sc_main(int argc, char **argv) {
 
 	loader.load_executable_image(mem, mem.size, opt.mem_start_addr);
 	sys.init(mem.data, opt.mem_start_addr, loader.get_heap_addr());
+	/* framebuffer changes are detected by the refresh, stores can bypass the bus */
+	MemoryDMI fb_dmi = MemoryDMI::create_start_size_mapping(
+	    vncsimplefb.get_frame_buffer(), opt.vncsimplefb_start_addr, vncsimplefb.get_frame_buffer_size());
 	for (size_t i = 0; i < NUM_CORES; i++) {
 		cores[i]->init(opt.use_data_dmi, opt.use_instr_dmi, opt.use_dbbcache, opt.use_lscache, &clint, entry_point,
 		               rv64_align_address(opt.mem_end_addr));
+		if (opt.use_data_dmi)
+			cores[i]->memif.dmi_ranges.emplace_back(fb_dmi);
 
 		sys.register_core(&cores[i]->iss);
 		if (opt.intercept_syscalls)
@@ -307,6 +353,8 @@ int sc_main(int argc, char **argv) {
 	    new PortMapping(opt.vncsimpleinputkbd_start_addr, opt.vncsimpleinputkbd_end_addr, vncsimpleinputkbd);
 	bus.ports[17] = new PortMapping(opt.mram_root_start_addr, opt.mram_root_end_addr, mramRoot);
 	bus.ports[18] = new PortMapping(opt.mram_data_start_addr, opt.mram_data_end_addr, mramData);
+	bus.ports[19] = new PortMapping(opt.virtio_blk_start_addr, opt.virtio_blk_end_addr, virtio_blk);
+	bus.ports[20] = new PortMapping(opt.virtio_net_start_addr, opt.virtio_net_end_addr, virtio_net);
 	bus.mapping_complete();
 
 	// connect TLM sockets
@@ -333,6 +381,8 @@ int sc_main(int argc, char **argv) {
 	bus.isocks[16].bind(vncsimpleinputkbd.tsock);
 	bus.isocks[17].bind(mramRoot.tsock);
 	bus.isocks[18].bind(mramData.tsock);
+	bus.isocks[19].bind(virtio_blk.tsock);
+	bus.isocks[20].bind(virtio_net.tsock);
 
 	// connect interrupt signals/communication
 	for (size_t i = 0; i < NUM_CORES; i++) {
@@ -347,6 +397,8 @@ int sc_main(int argc, char **argv) {
 	spi2.plic = &plic;
 	vncsimpleinputptr.plic = &plic;
 	vncsimpleinputkbd.plic = &plic;
+	virtio_blk.plic = &plic;
+	virtio_net.plic = &plic;
 
 	for (size_t i = 0; i < NUM_CORES; i++) {
 		// switch for printing instructions
@@ -357,6 +409,14 @@ int sc_main(int argc, char **argv) {
 		cores[i]->iss.regs[RegFile::a1] = opt.dtb_rom_start_addr;
 	}
 
+	Instrumentation instrumentation(opt);
+	instrumentation.add_program(loader);
+	if (kernel && kernel->is_elf())
+		instrumentation.add_elf(*kernel);
+	for (size_t i = 0; i < NUM_CORES; i++) instrumentation.add_core(cores[i]->iss, cores[i]->memif);
+	instrumentation.add_bus(bus);
+	instrumentation.start();
+
 	// OpenSBI boots all harts except hart 0 by default.
 	//
 	// To prevent this hart from being scheduled when stuck in
@@ -373,7 +433,7 @@ int sc_main(int argc, char **argv) {
 	dtb_rom.load_binary_file(opt.dtb_file, 0);
 
 	// load kernel
-	handle_kernel_file(opt, mem);
+	handle_kernel_file(opt, kernel.get(), mem);
 
 	std::vector<mmu_memory_if *> mmus;
 	std::vector<debug_target_if *> dharts;
@@ -393,9 +453,15 @@ int sc_main(int argc, char **argv) {
 	}
 
 	sc_core::sc_start();
+	instrumentation.finish();
 	for (size_t i = 0; i < NUM_CORES; i++) {
 		cores[i]->iss.show();
 	}
 
-	return 0;
+	if (fork_server && fork_server->is_child()) {
+		uart0.stop_io();
+		fork_server->exit_child(sifive_test.get_exit_code());
+	}
+
+	return sifive_test.get_exit_code();
 }
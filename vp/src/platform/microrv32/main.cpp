@@ -16,6 +16,7 @@
 #include "microrv32_gpio.h"
 #include "microrv32_led.h"
 #include "microrv32_uart.h"
+#include "platform/common/instrumentation.h"
 #include "platform/common/options.h"
 #include "syscall.h"
 #include "util/options.h"
@@ -143,6 +144,12 @@ int sc_main(int argc, char **argv) {
 
 	core.enable_trace(opt.trace_mode);  // switch for printing instructions
 
+	Instrumentation instrumentation(opt);
+	instrumentation.add_program(loader);
+	instrumentation.add_core(core, iss_mem_if);
+	instrumentation.add_bus(bus);
+	instrumentation.start();
+
 	if (opt.use_debug_runner) {
 		auto server = new GDBServer("GDBServer", threads, &dbg_if, opt.debug_port);
 		new GDBServerRunner("GDBRunner", server, &core);
@@ -151,6 +158,7 @@ int sc_main(int argc, char **argv) {
 	}
 
 	sc_core::sc_start();
+	instrumentation.finish();
 
 	core.show();
 
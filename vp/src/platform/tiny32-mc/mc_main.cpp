@@ -12,6 +12,7 @@
 #include "iss.h"
 #include "mem.h"
 #include "memory.h"
+#include "platform/common/instrumentation.h"
 #include "platform/common/options.h"
 #include "syscall.h"
 
@@ -119,6 +120,13 @@ int sc_main(int argc, char **argv) {
 	core0.enable_trace(opt.trace_mode);
 	core1.enable_trace(opt.trace_mode);
 
+	Instrumentation instrumentation(opt);
+	instrumentation.add_program(loader);
+	instrumentation.add_core(core0, core0_mem_if);
+	instrumentation.add_core(core1, core1_mem_if);
+	instrumentation.add_bus(bus);
+	instrumentation.start();
+
 	std::vector<debug_target_if *> threads;
 	threads.push_back(&core0);
 	threads.push_back(&core1);
@@ -136,6 +144,7 @@ int sc_main(int argc, char **argv) {
 		sc_core::sc_report_handler::set_verbosity_level(sc_core::SC_NONE);
 
 	sc_core::sc_start();
+	instrumentation.finish();
 	if (!opt.quiet) {
 		core0.show();
 		core1.show();
@@ -13,6 +13,7 @@
 #include "iss.h"
 #include "mem.h"
 #include "memory.h"
+#include "platform/common/instrumentation.h"
 #include "platform/common/options.h"
 #include "syscall.h"
 
@@ -117,6 +118,12 @@ int sc_main(int argc, char **argv) {
 	// switch for printing instructions
 	core.enable_trace(opt.trace_mode);
 
+	Instrumentation instrumentation(opt);
+	instrumentation.add_program(loader);
+	instrumentation.add_core(core, core_mem_if);
+	instrumentation.add_bus(bus);
+	instrumentation.start();
+
 	std::vector<debug_target_if *> threads;
 	threads.push_back(&core);
 
@@ -131,6 +138,7 @@ int sc_main(int argc, char **argv) {
 		sc_core::sc_report_handler::set_verbosity_level(sc_core::SC_NONE);
 
 	sc_core::sc_start();
+	instrumentation.finish();
 	if (!opt.quiet) {
 		core.show();
 	}
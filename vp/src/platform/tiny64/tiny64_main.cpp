@@ -4,6 +4,7 @@
 #include <ctime>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 
 #include "core/common/real_clint.h"
 #include "debug_memory.h"
@@ -14,12 +15,18 @@
 #include "mem.h"
 #include "memory.h"
 #include "mmu.h"
+#include "platform/common/instrumentation.h"
 #include "platform/common/options.h"
 #include "syscall.h"
 
 using namespace rv64;
 namespace po = boost::program_options;
 
+/* if not defined externally fall back to at most eight harts for guest threads (see --user-threads) */
+#if !defined(MAX_USER_THREADS)
+#define MAX_USER_THREADS 8
+#endif
+
 struct TinyOptions : public Options {
    public:
 	typedef unsigned int addr_t;
@@ -35,6 +42,10 @@ struct TinyOptions : public Options {
 
 	bool quiet = false;
 	bool use_E_base_isa = false;
+	bool linux_user = false;
+	unsigned int user_threads = 0;
+	std::vector<std::string> guest_args;
+	std::vector<std::string> guest_env;
 
 	TinyOptions(void) {
 		// clang-format off
@@ -42,16 +53,79 @@ struct TinyOptions : public Options {
 			("quiet", po::bool_switch(&quiet), "do not output register values on exit")
 			("memory-start", po::value<unsigned int>(&mem_start_addr), "set memory start address")
 			("memory-size", po::value<unsigned int>(&mem_size), "set memory size")
-			("use-E-base-isa", po::bool_switch(&use_E_base_isa), "use the E instead of the I integer base ISA");
+			("use-E-base-isa", po::bool_switch(&use_E_base_isa), "use the E instead of the I integer base ISA")
+			("linux-user", po::bool_switch(&linux_user), "run a Linux user-mode binary: process stack with arguments, environment and auxiliary vector, Linux syscalls (implies intercept-syscalls)")
+			("user-threads", po::value<unsigned int>(&user_threads), "number of additional harts for guest threads (clone), requires linux-user")
+			("guest-env", po::value<std::vector<std::string>>(&guest_env)->composing(), "environment variable <name>=<value> of the guest process, requires linux-user")
+			("guest-args", po::value<std::vector<std::string>>(&guest_args)->composing(), "arguments of the guest process (also the positional arguments after the input file), requires linux-user");
 		// clang-format on
+
+		pos.add("guest-args", -1);
 	}
 
 	void parse(int argc, char **argv) override {
 		Options::parse(argc, argv);
 		mem_end_addr = mem_start_addr + mem_size - 1;
+
+		if (!linux_user && (user_threads || !guest_args.empty() || !guest_env.empty())) {
+			std::cerr << "[Options] Error: 'user-threads', 'guest-env' and 'guest-args' can only be used if "
+			             "'linux-user' is set."
+			          << std::endl;
+			exit(1);
+		}
+		if (user_threads > MAX_USER_THREADS) {
+			std::cerr << "[Options] Error: at most " << MAX_USER_THREADS << " user threads are supported." << std::endl;
+			exit(1);
+		}
+		if (linux_user) {
+			std::cerr << "[Options] Info: switch 'linux-user' also activates 'intercept-syscalls' and "
+			             "'error-on-zero-traphandler'."
+			          << std::endl;
+			intercept_syscalls = true;
+			error_on_zero_traphandler = true;
+
+			/* place the CLINT and the syscall handler after the memory, which may extend beyond 32 MB then */
+			clint_start_addr = (mem_end_addr | 0xffff) + 1;
+			clint_end_addr = clint_start_addr + 0xffff;
+			sys_start_addr = clint_end_addr + 1;
+			sys_end_addr = sys_start_addr + 0x3ff;
+		}
+	}
+};
+
+/* additional hart for guest threads in linux-user mode */
+class ThreadCore {
+   public:
+	ISS iss;
+	MMU mmu;
+	CombinedMemoryInterface memif;
+	InstrMemoryProxy imemif;
+
+	ThreadCore(RV_ISA_Config *isa_config, unsigned int id, MemoryDMI dmi)
+	    : iss(isa_config, id),
+	      mmu(iss),
+	      memif(("MemoryInterface" + std::to_string(id)).c_str(), iss, &mmu),
+	      imemif(dmi, iss) {}
+
+	void init(bool use_data_dmi, bool use_instr_dmi, bool use_dbbcache, bool use_lscache, clint_if *clint,
+	          uint64_t entry, uint64_t sp) {
+		if (use_data_dmi)
+			memif.dmi_ranges.emplace_back(imemif.dmi);
+
+		instr_memory_if *instr_mem_if = &memif;
+		if (use_instr_dmi)
+			instr_mem_if = &imemif;
+		iss.init(instr_mem_if, use_dbbcache, &memif, use_lscache, clint, entry, sp);
 	}
 };
 
+/* terminates a bus target socket without a thread core, SystemC requires all sockets to be bound */
+struct UnusedInitiator : public sc_core::sc_module {
+	tlm_utils::simple_initiator_socket<UnusedInitiator> isock;
+
+	UnusedInitiator(sc_core::sc_module_name name) : sc_module(name) {}
+};
+
 int sc_main(int argc, char **argv) {
 	TinyOptions opt;
 	opt.parse(argc, argv);
@@ -71,7 +145,7 @@ int sc_main(int argc, char **argv) {
 	if (opt.use_debug_bus) {
 		debug_bus = new NetTrace(opt.debug_bus_port);
 	}
-	SimpleBus<2, 3> bus("SimpleBus", debug_bus, opt.break_on_transaction);
+	SimpleBus<2 + MAX_USER_THREADS, 3> bus("SimpleBus", debug_bus, opt.break_on_transaction);
 	SyscallHandler sys("SyscallHandler");
 	DebugMemoryInterface dbg_if("DebugMemoryInterface");
 
@@ -94,11 +168,29 @@ int sc_main(int argc, char **argv) {
 	}
 
 	loader.load_executable_image(mem, mem.size, opt.mem_start_addr);
-	core.init(instr_mem_if, opt.use_dbbcache, data_mem_if, opt.use_lscache, &clint, loader.get_entrypoint(),
-	          rv64_align_address(opt.mem_end_addr));
 	sys.init(mem.data, opt.mem_start_addr, loader.get_heap_addr());
+	uint64_t sp = rv64_align_address(opt.mem_end_addr);
+	if (opt.linux_user) {
+		std::vector<std::string> args{opt.input_program};
+		args.insert(args.end(), opt.guest_args.begin(), opt.guest_args.end());
+		sp = sys.init_linux_user(core, loader, opt.mem_size, args, opt.guest_env);
+	}
+	core.init(instr_mem_if, opt.use_dbbcache, data_mem_if, opt.use_lscache, &clint, loader.get_entrypoint(), sp);
 	sys.register_core(&core);
 
+	std::vector<std::unique_ptr<ThreadCore>> thread_cores;
+	for (unsigned i = 0; i < opt.user_threads; ++i) {
+		auto c = new ThreadCore(&isa_config, i + 1, dmi);
+		thread_cores.emplace_back(c);
+		c->memif.bus_lock = bus_lock;
+		c->mmu.mem = &c->memif;
+		c->init(opt.use_data_dmi, opt.use_instr_dmi, opt.use_dbbcache, opt.use_lscache, &clint,
+		        loader.get_entrypoint(), sp);
+		c->iss.sys = &sys;
+		c->iss.error_on_zero_traphandler = opt.error_on_zero_traphandler;
+		sys.register_thread_core(&c->iss);
+	}
+
 	if (opt.intercept_syscalls)
 		core.sys = &sys;
 	core.error_on_zero_traphandler = opt.error_on_zero_traphandler;
@@ -112,12 +204,26 @@ int sc_main(int argc, char **argv) {
 	// connect TLM sockets
 	core_mem_if.isock.bind(bus.tsocks[0]);
 	dbg_if.isock.bind(bus.tsocks[1]);
+	for (unsigned i = 0; i < thread_cores.size(); ++i) thread_cores[i]->memif.isock.bind(bus.tsocks[2 + i]);
+	std::vector<std::unique_ptr<UnusedInitiator>> unused_initiators;
+	for (unsigned i = thread_cores.size(); i < MAX_USER_THREADS; ++i) {
+		unused_initiators.emplace_back(new UnusedInitiator(("UnusedInitiator" + std::to_string(i + 1)).c_str()));
+		unused_initiators.back()->isock.bind(bus.tsocks[2 + i]);
+	}
 	bus.isocks[0].bind(mem.tsock);
 	bus.isocks[1].bind(clint.tsock);
 	bus.isocks[2].bind(sys.tsock);
 
 	// switch for printing instructions
 	core.enable_trace(opt.trace_mode);
+	for (auto &c : thread_cores) c->iss.enable_trace(opt.trace_mode);
+
+	Instrumentation instrumentation(opt);
+	instrumentation.add_program(loader);
+	instrumentation.add_core(core, core_mem_if);
+	for (auto &c : thread_cores) instrumentation.add_core(c->iss, c->memif);
+	instrumentation.add_bus(bus);
+	instrumentation.start();
 
 	std::vector<debug_target_if *> threads;
 	threads.push_back(&core);
@@ -128,11 +234,13 @@ int sc_main(int argc, char **argv) {
 	} else {
 		new DirectCoreRunner(core);
 	}
+	for (auto &c : thread_cores) new UserThreadRunner(sys, c->iss);
 
 	if (opt.quiet)
 		sc_core::sc_report_handler::set_verbosity_level(sc_core::SC_NONE);
 
 	sc_core::sc_start();
+	instrumentation.finish();
 	if (!opt.quiet) {
 		core.show();
 	}
@@ -0,0 +1,48 @@
+#ifndef RISCV_VP_DIRTY_PAGES_H
+#define RISCV_VP_DIRTY_PAGES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
+namespace vp {
+
+/*
+ * Page-level change detection for memory which is written without any bookkeeping (e.g. by the cores via DMI).
+ *
+ * The memory is compared page by page with a shadow copy (e.g. the buffer of a display backend) at refresh time.
+ * Changed pages are copied into the shadow and reported as runs of consecutive pages by calling fn(offset, len).
+ * Returns the number of changed bytes.
+ */
+template <typename F>
+size_t sync_dirty_pages(const uint8_t *mem, uint8_t *shadow, size_t size, F fn, size_t page_size = 4096) {
+	size_t changed = 0;
+	size_t run_start = 0, run_len = 0;
+
+	for (size_t offset = 0; offset < size; offset += page_size) {
+		size_t len = std::min(page_size, size - offset);
+		if (memcmp(mem + offset, shadow + offset, len) != 0) {
+			memcpy(shadow + offset, mem + offset, len);
+			if (run_len == 0)
+				run_start = offset;
+			run_len += len;
+			continue;
+		}
+		if (run_len) {
+			fn(run_start, run_len);
+			changed += run_len;
+			run_len = 0;
+		}
+	}
+	if (run_len) {
+		fn(run_start, run_len);
+		changed += run_len;
+	}
+	return changed;
+}
+
+}  // namespace vp
+
+#endif  // RISCV_VP_DIRTY_PAGES_H
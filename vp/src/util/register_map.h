@@ -0,0 +1,239 @@
+#ifndef RISCV_REGISTER_MAP_H
+#define RISCV_REGISTER_MAP_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <systemc>
+#include <tlm>
+#include <type_traits>
+
+#include "common.h"
+
+/*
+ * Compile-time register maps
+ *
+ * A device declares its registers once as a type, e.g.
+ *
+ *   typedef vp::regmap::RegisterMap<4,
+ *       Bank<0x0, 0x8, Reg<0x0, &Dev::ctrl, &Dev::ctrl_access>, Reg<0x4, &Dev::status, nullptr, RO>>,
+ *       Bank<0x100, 0x40, RegArray<0x100, 16, 4, &Dev::data>>>
+ *       register_map;
+ *
+ * and routes its transactions with register_map::transport("Dev", *this, trans, delay). Each bank contains a table,
+ * generated at compile time, which maps every 32 bit word of the bank to its register. An access costs a range check
+ * per bank, a table lookup and one call of the handler generated for the register, in which the register callback
+ * (a member function known at compile time) is inlined. Registers are backed by plain device members.
+ *
+ * The callback is called for every access of the register and has to call Access::fn to perform the actual
+ * read/write (i.e. it can do pre-read and post-write actions or suppress the access). Without callback the access is
+ * performed directly.
+ */
+
+namespace vp {
+namespace regmap {
+
+enum Mode : unsigned {
+	RO = 1,
+	WO = 2,
+	RW = RO | WO,
+};
+
+struct Access {
+	bool read;
+	bool write;
+	uint64_t addr;    // device local address
+	unsigned index;   // element of a register array (0 for single registers)
+	unsigned offset;  // byte offset of the access in the element
+	unsigned len;
+	uint8_t *data;  // transaction data
+	uint8_t *elem;  // register storage of the element
+	uint32_t mask;  // writable bits of every 32 bit word, other bits are written as zero
+	/* the 32 bit word of the element covered by the access and its new value (valid for writes) */
+	uint32_t *vptr;
+	uint32_t nv;
+	tlm::tlm_generic_payload &trans;
+	sc_core::sc_time &delay;
+
+	void fn() const {
+		if (read) {
+			memcpy(data, elem + offset, len);
+		} else {
+			for (unsigned i = 0; i < len; i++) elem[offset + i] = data[i] & (mask >> ((offset + i) % 4 * 8));
+		}
+	}
+};
+
+namespace detail {
+
+template <typename T>
+struct member;
+
+template <typename C, typename T>
+struct member<T C::*> {
+	typedef T type;
+};
+
+template <typename T>
+struct element {
+	typedef T type;
+	static constexpr size_t count = 1;
+};
+
+template <typename T, size_t N>
+struct element<T[N]> {
+	typedef T type;
+	static constexpr size_t count = N;
+};
+
+}  // namespace detail
+
+template <uint64_t Addr, auto Field, auto Callback, unsigned Mode, uint32_t Mask, bool IsArray, unsigned Count,
+          uint64_t Stride>
+struct Register {
+	typedef typename detail::member<decltype(Field)>::type field_type;
+	typedef typename std::conditional<IsArray, typename detail::element<field_type>::type, field_type>::type elem_type;
+
+	static constexpr uint64_t addr = Addr;
+	static constexpr unsigned count = Count;
+	static constexpr uint64_t size = sizeof(elem_type);
+	static constexpr uint64_t stride = IsArray ? Stride : size;
+
+	static_assert(Addr % 4 == 0 && size % 4 == 0, "registers have to consist of aligned 32 bit words");
+	static_assert(std::is_trivially_copyable<elem_type>::value, "trivially copyable register type required");
+	static_assert(!IsArray || (Count <= detail::element<field_type>::count && Stride >= size), "invalid array");
+
+	template <typename Device>
+	static uint8_t *storage(Device &dev, unsigned index) {
+		if constexpr (IsArray)
+			return reinterpret_cast<uint8_t *>(&(dev.*Field)[index]);
+		else
+			return reinterpret_cast<uint8_t *>(&(dev.*Field));
+	}
+
+	template <typename Device>
+	static void access(Device &dev, tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
+		auto cmd = trans.get_command();
+		uint64_t rel = trans.get_address() - Addr;
+		unsigned index = rel / stride;
+		unsigned offset = rel % stride;
+		unsigned len = trans.get_data_length();
+
+		if (offset + len > size)
+			throw std::runtime_error("register access exceeds register at " + std::to_string(trans.get_address()));
+		if (!((cmd == tlm::TLM_READ_COMMAND && (Mode & RO)) || (cmd == tlm::TLM_WRITE_COMMAND && (Mode & WO))))
+			throw std::runtime_error("invalid register access at " + std::to_string(trans.get_address()));
+
+		uint8_t *elem = storage(dev, index);
+		uint32_t *vptr = reinterpret_cast<uint32_t *>(elem + offset - offset % 4);
+		uint32_t nv = 0;
+		if (cmd == tlm::TLM_WRITE_COMMAND) {
+			nv = *vptr;
+			memcpy(reinterpret_cast<uint8_t *>(&nv) + offset % 4, trans.get_data_ptr(),
+			       std::min(len, 4 - offset % 4));
+			nv &= Mask;
+		}
+
+		Access a = {cmd == tlm::TLM_READ_COMMAND,
+		            cmd == tlm::TLM_WRITE_COMMAND,
+		            trans.get_address(),
+		            index,
+		            offset,
+		            len,
+		            trans.get_data_ptr(),
+		            elem,
+		            Mask,
+		            vptr,
+		            nv,
+		            trans,
+		            delay};
+
+		if constexpr (std::is_same<decltype(Callback), std::nullptr_t>::value)
+			a.fn();
+		else
+			(dev.*Callback)(a);
+	}
+};
+
+/* register backed by the member Field (any size which is a multiple of 32 bit) */
+template <uint64_t Addr, auto Field, auto Callback = nullptr, unsigned Mode = RW, uint32_t Mask = 0xffffffff>
+using Reg = Register<Addr, Field, Callback, Mode, Mask, false, 1, 0>;
+
+/* Count registers at Addr + i * Stride backed by the elements of the array member Field (Access::index is i) */
+template <uint64_t Addr, unsigned Count, uint64_t Stride, auto Field, auto Callback = nullptr, unsigned Mode = RW,
+          uint32_t Mask = 0xffffffff>
+using RegArray = Register<Addr, Field, Callback, Mode, Mask, true, Count, Stride>;
+
+/* contiguous address range [Base, Base + Size) containing the given registers */
+template <uint64_t Base, uint64_t Size, typename... Regs>
+struct Bank {
+	static_assert(Base % 4 == 0 && Size % 4 == 0, "banks have to consist of aligned 32 bit words");
+	static_assert(sizeof...(Regs) > 0 && sizeof...(Regs) < 256, "invalid number of registers");
+
+	typedef std::array<uint8_t, Size / 4> table_type;
+
+	/* word of the bank → register number + 1 (0: unmapped) */
+	static constexpr table_type make_table() {
+		table_type table{};
+		const uint64_t addrs[] = {Regs::addr...};
+		const uint64_t counts[] = {Regs::count...};
+		const uint64_t strides[] = {Regs::stride...};
+		const uint64_t sizes[] = {Regs::size...};
+
+		for (size_t r = 0; r < sizeof...(Regs); r++) {
+			for (uint64_t i = 0; i < counts[r]; i++) {
+				uint64_t start = (addrs[r] + i * strides[r] - Base) / 4;
+				for (uint64_t w = 0; w < sizes[r] / 4; w++) {
+					/* fails to compile on overlapping registers or registers outside the bank */
+					if (table.at(start + w) != 0)
+						throw std::logic_error("overlapping registers");
+					table.at(start + w) = r + 1;
+				}
+			}
+		}
+		return table;
+	}
+
+	static constexpr table_type table = make_table();
+
+	template <typename Device>
+	static bool try_access(Device &dev, tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
+		typedef void (*handler_t)(Device &, tlm::tlm_generic_payload &, sc_core::sc_time &);
+		static constexpr handler_t handlers[] = {&Regs::template access<Device>...};
+
+		uint64_t addr = trans.get_address();
+		if (addr < Base || addr - Base >= Size)
+			return false;
+
+		unsigned r = table[(addr - Base) / 4];
+		if (r == 0)
+			return false;
+
+		handlers[r - 1](dev, trans, delay);
+		return true;
+	}
+};
+
+/* Alignment: required alignment of address and length of all accesses */
+template <unsigned Alignment, typename... Banks>
+struct RegisterMap {
+	template <typename Device>
+	static void transport(const char *name, Device &dev, tlm::tlm_generic_payload &trans, sc_core::sc_time &delay) {
+		auto addr = trans.get_address();
+		auto len = trans.get_data_length();
+
+		ensure((addr % Alignment == 0) && (len % Alignment == 0) && len > 0);
+
+		if (!(Banks::template try_access<Device>(dev, trans, delay) || ...))
+			throw std::runtime_error(std::string(name) + " unable to route address " + std::to_string(addr));
+	}
+};
+
+}  // namespace regmap
+}  // namespace vp
+
+#endif  // RISCV_REGISTER_MAP_H